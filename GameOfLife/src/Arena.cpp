@@ -0,0 +1,105 @@
+#include "Arena.h"
+#include <new>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define ARENA_MMAP
+#endif
+
+namespace
+{
+    constexpr size_t kHugePageSize = size_t{2} << 20;
+    constexpr size_t kPageSize = 4096;
+}
+
+Arena::~Arena()
+{
+    Release();
+}
+
+Arena::Arena(Arena&& other) noexcept
+    : base(std::exchange(other.base, nullptr)),
+      capacity(std::exchange(other.capacity, 0)),
+      used(std::exchange(other.used, 0)),
+      mapped(std::exchange(other.mapped, false)),
+      hugePages(std::exchange(other.hugePages, false))
+{
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        base = std::exchange(other.base, nullptr);
+        capacity = std::exchange(other.capacity, 0);
+        used = std::exchange(other.used, 0);
+        mapped = std::exchange(other.mapped, false);
+        hugePages = std::exchange(other.hugePages, false);
+    }
+    return *this;
+}
+
+void Arena::Release()
+{
+    if (!base) return;
+#ifdef ARENA_MMAP
+    if (mapped) munmap(base, capacity);
+#endif
+    if (!mapped) ::operator delete(base, std::align_val_t{kAlignment});
+    base = nullptr;
+    capacity = 0;
+    used = 0;
+    mapped = false;
+    hugePages = false;
+}
+
+void Arena::Reset(size_t bytes)
+{
+    used = 0;
+    if (bytes <= capacity) return;
+    Release();
+
+    const bool huge = bytes >= kHugePageSize;
+    const size_t pageSize = huge ? kHugePageSize : kPageSize;
+    const size_t size = (bytes + pageSize - 1) / pageSize * pageSize;
+
+#ifdef ARENA_MMAP
+    void* memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (huge)
+    {
+        // Only succeeds when the administrator reserved a huge page pool
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        hugePages = memory != MAP_FAILED;
+    }
+#endif
+    if (memory == MAP_FAILED)
+    {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+        if (memory != MAP_FAILED && huge) hugePages = madvise(memory, size, MADV_HUGEPAGE) == 0;
+#endif
+    }
+    if (memory != MAP_FAILED)
+    {
+        base = static_cast<uint8_t*>(memory);
+        capacity = size;
+        mapped = true;
+        return;
+    }
+#endif
+
+    base = static_cast<uint8_t*>(::operator new(size, std::align_val_t{kAlignment}, std::nothrow));
+    capacity = base ? size : 0;
+}
+
+void* Arena::Allocate(size_t bytes)
+{
+    size_t size = AlignUp(bytes);
+    if (!base || size > capacity - used) return nullptr;
+    void* result = base + used;
+    used += size;
+    return result;
+}
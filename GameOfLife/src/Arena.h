@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// One 64-byte-aligned memory region carved up by bump allocation. Everything
+// allocated from it is released at once by Reset(), which keeps the region for
+// reuse, so resizing a board does not go back to (or fragment) the heap.
+// Regions of 2 MiB and more are backed by huge pages where the OS allows it:
+// MAP_HUGETLB from the reserved pool first, then transparent huge pages via madvise.
+// Pages are only committed when first touched.
+class Arena
+{
+public:
+    static constexpr size_t kAlignment = 64;
+
+    Arena() = default;
+    explicit Arena(size_t bytes) { Reset(bytes); }
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&& other) noexcept;
+    Arena& operator=(Arena&& other) noexcept;
+
+    // Drops every allocation; the region is replaced only if it is smaller than bytes
+    void Reset(size_t bytes = 0);
+    // 64-byte aligned, contents unspecified; nullptr once the region is exhausted
+    void* Allocate(size_t bytes);
+    template <typename T>
+    T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(count * sizeof(T))); }
+
+    static size_t AlignUp(size_t bytes) { return (bytes + kAlignment - 1) / kAlignment * kAlignment; }
+
+    size_t GetCapacity() const { return capacity; }
+    size_t GetUsed() const { return used; }
+    bool UsesHugePages() const { return hugePages; }
+
+private:
+    void Release();
+
+    uint8_t* base = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    bool mapped = false;
+    bool hugePages = false;
+};
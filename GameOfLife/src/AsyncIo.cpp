@@ -0,0 +1,112 @@
+#include "AsyncIo.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+AsyncIo::AsyncIo()
+    : worker(&AsyncIo::Run, this)
+{
+}
+
+AsyncIo::~AsyncIo()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void AsyncIo::LoadLife106(const std::string& path, int rows, int columns)
+{
+    Submit(Job{IoJobResult::Kind::Load, path, rows, columns, nullptr});
+}
+
+void AsyncIo::SaveLife106(const std::string& path, std::shared_ptr<const BoardSnapshot> snapshot)
+{
+    Submit(Job{IoJobResult::Kind::Save, path, 0, 0, std::move(snapshot)});
+}
+
+void AsyncIo::LoadMacrocell(const std::string& path, int rows, int columns)
+{
+    Submit(Job{IoJobResult::Kind::Load, path, rows, columns, nullptr, true});
+}
+
+void AsyncIo::SaveMacrocell(const std::string& path, std::shared_ptr<const BoardSnapshot> snapshot)
+{
+    Submit(Job{IoJobResult::Kind::Save, path, 0, 0, std::move(snapshot), true});
+}
+
+void AsyncIo::Submit(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+        ++pendingJobs;
+    }
+    wake.notify_one();
+}
+
+bool AsyncIo::Poll(IoJobResult& result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (results.empty()) return false;
+    result = std::move(results.front());
+    results.pop_front();
+    return true;
+}
+
+void AsyncIo::Run()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            // Pending jobs are dropped on shutdown, a half-written save is worse than none
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        progress = 0.0f;
+        auto report = [this](float value) { progress = value; };
+
+        IoJobResult result;
+        result.kind = job.kind;
+        result.path = job.path;
+        if (job.kind == IoJobResult::Kind::Load)
+        {
+            result.loaded = std::make_shared<BoardSnapshot>();
+            result.ok = job.macrocell
+                ? Simulation::ParseMacrocell(job.path, job.rows, job.columns, *result.loaded, result.warnings)
+                : Simulation::ParseLife106(job.path, job.rows, job.columns, *result.loaded, result.warnings, report);
+            if (!result.ok) result.loaded.reset();
+        }
+        else
+        {
+            std::string err;
+            const std::string partPath = job.path + ".part";
+            result.ok = job.macrocell ? Simulation::WriteMacrocell(*job.snapshot, partPath, &err)
+                                      : Simulation::WriteLife106(*job.snapshot, partPath, &err, report);
+            if (result.ok && std::rename(partPath.c_str(), job.path.c_str()) != 0)
+            {
+                err = "Cannot replace " + job.path + ": " + std::strerror(errno);
+                result.ok = false;
+            }
+            if (!result.ok)
+            {
+                std::remove(partPath.c_str());
+                result.warnings.push_back(err);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(std::move(result));
+            --pendingJobs;
+        }
+    }
+}
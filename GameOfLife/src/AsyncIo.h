@@ -0,0 +1,75 @@
+#pragma once
+#include "Simulation.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct IoJobResult
+{
+    enum class Kind
+    {
+        Load,
+        Save
+    };
+
+    Kind kind = Kind::Load;
+    std::string path;
+    bool ok = false;
+    std::vector<std::string> warnings;
+    // Parsed board of a finished load, to be applied on the render thread
+    std::shared_ptr<BoardSnapshot> loaded;
+};
+
+// Background thread for pattern files so the frame loop never blocks on disk.
+// Jobs run one at a time in submission order; results are collected with Poll().
+class AsyncIo
+{
+public:
+    AsyncIo();
+    ~AsyncIo();
+
+    AsyncIo(const AsyncIo&) = delete;
+    AsyncIo& operator=(const AsyncIo&) = delete;
+
+    void LoadLife106(const std::string& path, int rows, int columns);
+    // snapshot is shared read-only, the simulation may keep stepping meanwhile.
+    // Saves go to path + ".part", renamed over path once complete, so path never holds a partial file.
+    void SaveLife106(const std::string& path, std::shared_ptr<const BoardSnapshot> snapshot);
+    // Same for Golly macrocell files
+    void LoadMacrocell(const std::string& path, int rows, int columns);
+    void SaveMacrocell(const std::string& path, std::shared_ptr<const BoardSnapshot> snapshot);
+
+    bool IsBusy() const { return pendingJobs.load() > 0; }
+    // Progress of the running job in [0, 1]
+    float GetProgress() const { return progress.load(); }
+    bool Poll(IoJobResult& result);
+
+private:
+    struct Job
+    {
+        IoJobResult::Kind kind;
+        std::string path;
+        int rows = 0;
+        int columns = 0;
+        std::shared_ptr<const BoardSnapshot> snapshot;
+        bool macrocell = false;
+    };
+
+    void Submit(Job job);
+    void Run();
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    std::deque<IoJobResult> results;
+    bool stopping = false;
+
+    std::atomic<int> pendingJobs{0};
+    std::atomic<float> progress{0.0f};
+    std::thread worker;
+};
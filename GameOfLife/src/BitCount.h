@@ -0,0 +1,34 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Bit-sliced neighbour counts: bit k of s0..s3 holds the 4-bit count of cell k.
+
+// Mask of cells whose count (s3 s2 s1 s0) equals n
+inline uint64_t CountEquals(int n, uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3)
+{
+    return ((n & 1) ? s0 : ~s0) & ((n & 2) ? s1 : ~s1) & ((n & 4) ? s2 : ~s2) & ((n & 8) ? s3 : ~s3);
+}
+
+// Adds one neighbour bit to every count
+inline void AddBit(uint64_t bit, uint64_t& s0, uint64_t& s1, uint64_t& s2, uint64_t& s3)
+{
+    uint64_t carry0 = s0 & bit;
+    s0 ^= bit;
+    uint64_t carry1 = s1 & carry0;
+    s1 ^= carry0;
+    uint64_t carry2 = s2 & carry1;
+    s2 ^= carry1;
+    s3 |= carry2;
+}
+
+// Mask of cells whose count is enabled in rule
+inline uint64_t RuleMask(const std::array<bool, 9>& rule, uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3)
+{
+    uint64_t mask = 0;
+    for (int n = 0; n <= 8; ++n)
+    {
+        if (rule[n]) mask |= CountEquals(n, s0, s1, s2, s3);
+    }
+    return mask;
+}
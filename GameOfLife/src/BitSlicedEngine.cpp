@@ -0,0 +1,152 @@
+#include "BitSlicedEngine.h"
+#include "BitCount.h"
+#include <bit>
+
+void BitSlicedEngine::Rebuild(const Grid& grid, int stateCount)
+{
+    states = stateCount;
+    int planes = PlanesForStates(states);
+    current = std::make_shared<PackedBoard>(PackedBoard::FromGrid(grid, planes));
+    next = std::make_shared<PackedBoard>(grid.GetRows(), grid.GetColumns(), planes);
+    alive = PackedBoard(grid.GetRows(), grid.GetColumns());
+    aliveWest = alive;
+    aliveEast = alive;
+    population = static_cast<long long>(current->Population());
+    valid = true;
+}
+
+void BitSlicedEngine::SetCell(int row, int column, int state)
+{
+    if (!valid) return;
+    if (!IsSoleOwner(current)) current = std::make_shared<PackedBoard>(*current);
+    population += (state != 0) - (current->GetState(row, column) != 0);
+    current->SetState(row, column, state);
+}
+
+void BitSlicedEngine::ShiftRows(const PackedBoard& source, PackedBoard& west, PackedBoard& east)
+{
+    const int words = source.GetWordsPerRow();
+    const int lastBit = (source.GetColumns() - 1) & 63;
+    const uint64_t lastMask = source.GetLastWordMask();
+
+    for (int row = 0; row < source.GetRows(); row++)
+    {
+        const uint64_t* in = source.Row(row);
+        uint64_t* w = west.Row(row);
+        uint64_t* e = east.Row(row);
+        const uint64_t firstCell = in[0] & 1;
+        const uint64_t lastCell = (in[words - 1] >> lastBit) & 1;
+
+        for (int i = 0; i < words; i++)
+        {
+            uint64_t previous = i > 0 ? in[i - 1] >> 63 : lastCell;
+            uint64_t following = i + 1 < words ? in[i + 1] << 63 : 0;
+            w[i] = (in[i] << 1) | previous;
+            e[i] = (in[i] >> 1) | following;
+        }
+        w[words - 1] &= lastMask;
+        e[words - 1] |= firstCell << lastBit;
+    }
+}
+
+void BitSlicedEngine::Step(Grid& grid, const std::array<bool, 9>& birth, const std::array<bool, 9>& survival)
+{
+    // Every word of next is rewritten, so a shared one is replaced rather than copied
+    if (!IsSoleOwner(next))
+    {
+        next = std::make_shared<PackedBoard>(current->GetRows(), current->GetColumns(), current->GetPlanes());
+    }
+    const PackedBoard& board = *current;
+    PackedBoard& out = *next;
+
+    const int rows = board.GetRows();
+    const int words = board.GetWordsPerRow();
+    const int planes = board.GetPlanes();
+    const uint64_t lastMask = board.GetLastWordMask();
+
+    // Live cells are exactly state 1
+    for (int row = 0; row < rows; row++)
+    {
+        uint64_t* live = alive.Row(row);
+        for (int i = 0; i < words; i++)
+        {
+            uint64_t higher = 0;
+            for (int plane = 1; plane < planes; plane++) higher |= board.Row(row, plane)[i];
+            live[i] = board.Row(row, 0)[i] & ~higher;
+        }
+    }
+    ShiftRows(alive, aliveWest, aliveEast);
+
+    // Generations: state + 1 wraps to 0 at C; with C a power of two the carry out does that already
+    const bool wrapNeeded = (1 << planes) != states;
+
+    population = 0;
+    for (int row = 0; row < rows; row++)
+    {
+        const int up = row == 0 ? rows - 1 : row - 1;
+        const int down = row == rows - 1 ? 0 : row + 1;
+        for (int i = 0; i < words; i++)
+        {
+            uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            AddBit(aliveWest.Row(up)[i], s0, s1, s2, s3);
+            AddBit(alive.Row(up)[i], s0, s1, s2, s3);
+            AddBit(aliveEast.Row(up)[i], s0, s1, s2, s3);
+            AddBit(aliveWest.Row(row)[i], s0, s1, s2, s3);
+            AddBit(aliveEast.Row(row)[i], s0, s1, s2, s3);
+            AddBit(aliveWest.Row(down)[i], s0, s1, s2, s3);
+            AddBit(alive.Row(down)[i], s0, s1, s2, s3);
+            AddBit(aliveEast.Row(down)[i], s0, s1, s2, s3);
+
+            const uint64_t inBoard = i == words - 1 ? lastMask : ~uint64_t{0};
+            const uint64_t live = alive.Row(row)[i];
+            uint64_t occupied = 0;
+            for (int plane = 0; plane < planes; plane++) occupied |= board.Row(row, plane)[i];
+
+            const uint64_t stay = live & RuleMask(survival, s0, s1, s2, s3);
+            const uint64_t born = ~occupied & RuleMask(birth, s0, s1, s2, s3) & inBoard;
+            // Live cells that fail survival and dying cells advance one state
+            const uint64_t advance = occupied & ~stay;
+
+            uint64_t carry = advance;
+            uint64_t sum[8];
+            for (int plane = 0; plane < planes; plane++)
+            {
+                uint64_t bit = board.Row(row, plane)[i];
+                sum[plane] = bit ^ carry;
+                carry &= bit;
+            }
+            uint64_t wrap = 0;
+            if (wrapNeeded)
+            {
+                wrap = advance;
+                for (int plane = 0; plane < planes; plane++)
+                {
+                    wrap &= ((states >> plane) & 1) ? sum[plane] : ~sum[plane];
+                }
+            }
+
+            uint64_t any = 0;
+            for (int plane = 0; plane < planes; plane++)
+            {
+                uint64_t bit = advance & sum[plane] & ~wrap;
+                if (plane == 0) bit |= stay | born;
+                out.Row(row, plane)[i] = bit;
+                any |= bit;
+            }
+            population += std::popcount(any);
+
+            uint64_t changed = 0;
+            for (int plane = 0; plane < planes; plane++)
+            {
+                changed |= out.Row(row, plane)[i] ^ board.Row(row, plane)[i];
+            }
+            for (; changed != 0; changed &= changed - 1)
+            {
+                int column = i * 64 + std::countr_zero(changed);
+                grid.Set(row, column, out.GetState(row, column));
+            }
+        }
+    }
+
+    std::swap(current, next);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Grid.h"
+#include "PackedBoard.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Step engine over bit planes: 64 cells per machine word, neighbour counts built
+// with a bit-sliced adder. Handles two-state rules and Generations rules
+// (B/S/C: state 1 alive, 2..C-1 dying, only state 1 counts as a neighbour)
+// with the state stored in PlanesForStates(C) planes.
+// Only cells whose state changed are written back to the Grid.
+// The board can be shared as a snapshot; the engine copies it before writing to it again.
+class BitSlicedEngine
+{
+public:
+    void Rebuild(const Grid& grid, int states);
+    void Invalidate() { valid = false; }
+    bool IsValid() const { return valid; }
+
+    void Step(Grid& grid, const std::array<bool, 9>& birth, const std::array<bool, 9>& survival);
+    void SetCell(int row, int column, int state);
+
+    long long GetPopulation() const { return population; }
+    int GetStates() const { return states; }
+    const PackedBoard& GetBoard() const { return *current; }
+    // Stays unchanged however the engine goes on
+    std::shared_ptr<const PackedBoard> ShareBoard() const { return current; }
+
+    // west[c] = source[c - 1], east[c] = source[c + 1] on plane 0, wrapping around the torus
+    static void ShiftRows(const PackedBoard& source, PackedBoard& west, PackedBoard& east);
+
+private:
+
+    bool valid = false;
+    int states = 2;
+    long long population = 0;
+
+    std::shared_ptr<PackedBoard> current = std::make_shared<PackedBoard>();
+    std::shared_ptr<PackedBoard> next = std::make_shared<PackedBoard>();
+    // Scratch: live (state 1) cells and their copies shifted one column west/east
+    PackedBoard alive;
+    PackedBoard aliveWest;
+    PackedBoard aliveEast;
+};
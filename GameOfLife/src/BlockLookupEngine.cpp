@@ -0,0 +1,181 @@
+#include "BlockLookupEngine.h"
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+    // 64 bits starting at bit position, words must have one word to spare
+    inline uint64_t Extract64(const uint64_t* words, int position)
+    {
+        const int word = position >> 6;
+        const int offset = position & 63;
+        if (offset == 0) return words[word];
+        return (words[word] >> offset) | (words[word + 1] << (64 - offset));
+    }
+
+    inline void OrBits(uint64_t* words, int wordCount, int position, uint64_t value)
+    {
+        const int word = position >> 6;
+        const int offset = position & 63;
+        words[word] |= value << offset;
+        if (offset != 0 && word + 1 < wordCount) words[word + 1] |= value >> (64 - offset);
+    }
+
+    // Blocks handled per extracted window: 30 blocks read 62 bits
+    constexpr int kBlocksPerWindow = 30;
+}
+
+void BlockLookupEngine::BuildTable(const std::array<bool, 9>& birth, const std::array<bool, 9>& survival)
+{
+    table.resize(1 << 16);
+    for (uint32_t index = 0; index < (1u << 16); ++index)
+    {
+        auto cell = [index](int r, int c) { return static_cast<int>((index >> (r * 4 + c)) & 1); };
+        uint8_t result = 0;
+        for (int r = 1; r <= 2; ++r)
+        {
+            for (int c = 1; c <= 2; ++c)
+            {
+                int neighbors = 0;
+                for (int dr = -1; dr <= 1; ++dr)
+                {
+                    for (int dc = -1; dc <= 1; ++dc)
+                    {
+                        if (dr != 0 || dc != 0) neighbors += cell(r + dr, c + dc);
+                    }
+                }
+                bool alive = cell(r, c) ? survival[neighbors] : birth[neighbors];
+                if (alive) result |= static_cast<uint8_t>(1 << ((r - 1) * 2 + (c - 1)));
+            }
+        }
+        table[index] = result;
+    }
+    tableBirth = birth;
+    tableSurvival = survival;
+    ++tableBuilds;
+}
+
+void BlockLookupEngine::Rebuild(const Grid& grid)
+{
+    current = BasicGrid<BitCells>(grid.GetColumns(), grid.GetRows(), 1);
+    next = BasicGrid<BitCells>(grid.GetColumns(), grid.GetRows(), 1);
+    population = 0;
+    for (int row = 0; row < grid.GetRows(); row++)
+    {
+        for (int column = 0; column < grid.GetColumns(); column++)
+        {
+            if (grid.Get(row, column) == 0) continue;
+            current.Set(row, column, 1);
+            ++population;
+        }
+    }
+    extendedWords = (grid.GetColumns() + 4 + 63) / 64 + 1;
+    extended.assign(static_cast<size_t>(extendedWords) * grid.GetRows(), 0);
+    valid = true;
+}
+
+void BlockLookupEngine::SetCell(int row, int column, bool alive)
+{
+    if (!valid) return;
+    population += static_cast<int>(alive) - static_cast<int>(current.Get(row, column));
+    current.Set(row, column, alive);
+}
+
+// Bit k of extended row r holds cell (r, (k - 1) mod columns) for k in [0, columns + 3]
+void BlockLookupEngine::BuildExtendedRows()
+{
+    const int columns = current.GetColumns();
+    const int words = static_cast<int>(current.GetStride());
+    for (int row = 0; row < current.GetRows(); row++)
+    {
+        const uint64_t* in = current.Row(row);
+        uint64_t* out = extended.data() + static_cast<size_t>(row) * extendedWords;
+        for (int i = 0; i < extendedWords; i++)
+        {
+            uint64_t low = i > 0 && i - 1 < words ? in[i - 1] >> 63 : 0;
+            out[i] = (i < words ? in[i] << 1 : 0) | low;
+        }
+        out[0] |= static_cast<uint64_t>(current.Get(row, columns - 1));
+        for (int k = columns + 1; k <= columns + 3; k++)
+        {
+            if (current.Get(row, (k - 1) % columns)) out[k >> 6] |= uint64_t{1} << (k & 63);
+        }
+    }
+}
+
+void BlockLookupEngine::Step(Grid& grid, const std::array<bool, 9>& birth, const std::array<bool, 9>& survival)
+{
+    if (table.empty() || birth != tableBirth || survival != tableSurvival) BuildTable(birth, survival);
+
+    const int rows = current.GetRows();
+    const int columns = current.GetColumns();
+    const int words = static_cast<int>(current.GetStride());
+    const uint64_t lastWordMask = columns % 64 == 0 ? ~uint64_t{0} : (uint64_t{1} << (columns % 64)) - 1;
+    const int blockRows = (rows + 1) / 2;
+    const int blockColumns = (columns + 1) / 2;
+
+    BuildExtendedRows();
+    next.Clear();
+
+    for (int blockRow = 0; blockRow < blockRows; blockRow++)
+    {
+        // With an odd row count the last block reaches one row past the board; its lower half is dropped
+        const int top = 2 * blockRow;
+        const uint64_t* window[4];
+        for (int r = 0; r < 4; r++)
+        {
+            int row = (top - 1 + r + rows) % rows;
+            window[r] = extended.data() + static_cast<size_t>(row) * extendedWords;
+        }
+        uint64_t* upperOut = next.Row(top);
+        uint64_t* lowerOut = top + 1 < rows ? next.Row(top + 1) : nullptr;
+
+        for (int first = 0; first < blockColumns; first += kBlocksPerWindow)
+        {
+            const int position = 2 * first;
+            const uint64_t w0 = Extract64(window[0], position);
+            const uint64_t w1 = Extract64(window[1], position);
+            const uint64_t w2 = Extract64(window[2], position);
+            const uint64_t w3 = Extract64(window[3], position);
+            const int count = std::min(kBlocksPerWindow, blockColumns - first);
+
+            uint64_t upper = 0;
+            uint64_t lower = 0;
+            for (int k = 0; k < count; k++)
+            {
+                const int shift = 2 * k;
+                const uint32_t index = static_cast<uint32_t>((w0 >> shift) & 15) |
+                    static_cast<uint32_t>((w1 >> shift) & 15) << 4 |
+                    static_cast<uint32_t>((w2 >> shift) & 15) << 8 |
+                    static_cast<uint32_t>((w3 >> shift) & 15) << 12;
+                const uint64_t entry = table[index];
+                upper |= (entry & 3) << shift;
+                lower |= (entry >> 2) << shift;
+            }
+            OrBits(upperOut, words, position, upper);
+            if (lowerOut) OrBits(lowerOut, words, position, lower);
+        }
+        upperOut[words - 1] &= lastWordMask;
+        if (lowerOut) lowerOut[words - 1] &= lastWordMask;
+    }
+
+    population = 0;
+    changedWords.clear();
+    for (int row = 0; row < rows; row++)
+    {
+        const uint64_t* before = current.Row(row);
+        const uint64_t* after = next.Row(row);
+        for (int i = 0; i < words; i++)
+        {
+            population += std::popcount(after[i]);
+            if (before[i] != after[i]) changedWords.push_back({row, i, after[i]});
+            for (uint64_t changed = before[i] ^ after[i]; changed != 0; changed &= changed - 1)
+            {
+                int column = i * 64 + std::countr_zero(changed);
+                grid.Set(row, column, static_cast<int>((after[i] >> (column & 63)) & 1));
+            }
+        }
+    }
+
+    current.SwapCells(next);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Grid.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Step engine for two-state rules using a 65536-entry table: the 4x4 cells around
+// a 2x2 block form the index, the entry holds the block's next 2x2 cells. Needs no
+// SIMD and handles any B/S rule (B0 included) with the same code.
+// The table is rebuilt only when the rule differs from the one it was built for.
+class BlockLookupEngine
+{
+public:
+    void Rebuild(const Grid& grid);
+    void Invalidate() { valid = false; }
+    bool IsValid() const { return valid; }
+
+    void Step(Grid& grid, const std::array<bool, 9>& birth, const std::array<bool, 9>& survival);
+    void SetCell(int row, int column, bool alive);
+
+    long long GetPopulation() const { return population; }
+
+    // A 64-cell word of a row the last Step changed, columns word * 64 onwards
+    struct ChangedWord
+    {
+        int row;
+        int word;
+        uint64_t cells;
+    };
+    const std::vector<ChangedWord>& GetChangedWords() const { return changedWords; }
+    // Number of times the table was computed, for tests
+    int GetTableBuilds() const { return tableBuilds; }
+
+private:
+    void BuildTable(const std::array<bool, 9>& birth, const std::array<bool, 9>& survival);
+    void BuildExtendedRows();
+
+    bool valid = false;
+    long long population = 0;
+
+    // One bit per cell, the layout the table windows are cut from
+    BasicGrid<BitCells> current{0, 0, 1};
+    BasicGrid<BitCells> next{0, 0, 1};
+    // Row r with column c stored at bit c + 1, wrapped columns on both ends
+    std::vector<uint64_t> extended;
+    int extendedWords = 0;
+    std::vector<ChangedWord> changedWords;
+
+    // bits r * 4 + c of the index: window cell (r, c); entry bits: (1,1) (1,2) (2,1) (2,2)
+    std::vector<uint8_t> table;
+    std::array<bool, 9> tableBirth{};
+    std::array<bool, 9> tableSurvival{};
+    int tableBuilds = 0;
+};
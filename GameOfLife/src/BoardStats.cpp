@@ -0,0 +1,200 @@
+#include "BoardStats.h"
+#include <algorithm>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BOARD_STATS_SSE2
+#endif
+
+namespace
+{
+    // Non-zero bytes of count (<= 64) cells as bits, cell i in bit i
+    inline uint64_t PackLive(const uint8_t* cells, int count)
+    {
+        uint64_t word = 0;
+        int i = 0;
+#ifdef BOARD_STATS_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i));
+            uint64_t dead = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)));
+            word |= (~dead & 0xffff) << i;
+        }
+#endif
+        for (; i < count; i++) word |= static_cast<uint64_t>(cells[i] != 0) << i;
+        return word;
+    }
+}
+
+double BoardStats::TileDensity(int tileRow, int tileColumn, int boardRows, int boardColumns) const
+{
+    const int height = std::min(kTileSize, boardRows - tileRow * kTileSize);
+    const int width = std::min(kTileSize, boardColumns - tileColumn * kTileSize);
+    if (height <= 0 || width <= 0) return 0.0;
+    return tilePopulation[static_cast<size_t>(tileRow) * tileColumns + tileColumn] / static_cast<double>(height * width);
+}
+
+void StatsTracker::Resize(int rows, int columns)
+{
+    live = PackedBoard(rows, columns);
+    stats.tileRows = (rows + BoardStats::kTileSize - 1) / BoardStats::kTileSize;
+    stats.tileColumns = live.GetWordsPerRow();
+    stats.tilePopulation.assign(static_cast<size_t>(stats.tileRows) * stats.tileColumns, 0);
+    stats.population = 0;
+}
+
+void StatsTracker::UpdateWord(int row, int word, uint64_t after)
+{
+    uint64_t& before = live.Row(row)[word];
+    if (before == after) return;
+    const int born = std::popcount(after & ~before);
+    const int died = std::popcount(before & ~after);
+    stats.births += born;
+    stats.deaths += died;
+    stats.population += born - died;
+    stats.tilePopulation[static_cast<size_t>(row / BoardStats::kTileSize) * stats.tileColumns + word] += born - died;
+    before = after;
+}
+
+void StatsTracker::Reset(const Grid& grid, long long generation)
+{
+    Resize(grid.GetRows(), grid.GetColumns());
+    Advance(grid, generation);
+    stats.births = 0;
+    stats.deaths = 0;
+}
+
+void StatsTracker::Advance(const PackedBoard& board, long long generation)
+{
+    if (board.GetRows() != live.GetRows() || board.GetColumns() != live.GetColumns())
+    {
+        Resize(board.GetRows(), board.GetColumns());
+    }
+    stats.births = 0;
+    stats.deaths = 0;
+    const int planes = board.GetPlanes();
+    for (int row = 0; row < board.GetRows(); row++)
+    {
+        for (int i = 0; i < board.GetWordsPerRow(); i++)
+        {
+            uint64_t word = 0;
+            for (int plane = 0; plane < planes; plane++) word |= board.Row(row, plane)[i];
+            UpdateWord(row, i, word);
+        }
+    }
+    stats.generation = generation;
+    UpdateBounds();
+}
+
+void StatsTracker::Advance(const Grid& grid, long long generation)
+{
+    const int columns = grid.GetColumns();
+    if (grid.GetRows() != live.GetRows() || columns != live.GetColumns()) Resize(grid.GetRows(), columns);
+    stats.births = 0;
+    stats.deaths = 0;
+    for (int row = 0; row < grid.GetRows(); row++)
+    {
+        const uint8_t* cells = grid.Row(row);
+        for (int i = 0; i < live.GetWordsPerRow(); i++)
+        {
+            UpdateWord(row, i, PackLive(cells + i * 64, std::min(64, columns - i * 64)));
+        }
+    }
+    stats.generation = generation;
+    UpdateBounds();
+}
+
+void StatsTracker::BeginStep()
+{
+    stats.births = 0;
+    stats.deaths = 0;
+}
+
+void StatsTracker::RepackWord(const Grid& grid, int row, int word)
+{
+    UpdateWord(row, word, PackLive(grid.Row(row) + word * 64, std::min(64, grid.GetColumns() - word * 64)));
+}
+
+void StatsTracker::EndStep(long long generation)
+{
+    stats.generation = generation;
+    UpdateBounds();
+}
+
+void StatsTracker::SetCell(int row, int column, bool alive)
+{
+    if (live.Get(row, column) == alive) return;
+    live.Set(row, column, alive);
+    const int delta = alive ? 1 : -1;
+    stats.population += delta;
+    stats.tilePopulation[static_cast<size_t>(row / BoardStats::kTileSize) * stats.tileColumns + column / 64] += delta;
+    if (!alive)
+    {
+        // Only a cell on the edge of the box can shrink it
+        if (row == stats.top || row == stats.bottom || column == stats.left || column == stats.right) UpdateBounds();
+    }
+    else if (stats.population == 1)
+    {
+        stats.top = stats.bottom = row;
+        stats.left = stats.right = column;
+    }
+    else
+    {
+        stats.top = std::min(stats.top, row);
+        stats.bottom = std::max(stats.bottom, row);
+        stats.left = std::min(stats.left, column);
+        stats.right = std::max(stats.right, column);
+    }
+}
+
+void StatsTracker::UpdateBounds()
+{
+    int tileTop = -1;
+    int tileBottom = -1;
+    int tileLeft = stats.tileColumns;
+    int tileRight = -1;
+    for (int tileRow = 0; tileRow < stats.tileRows; tileRow++)
+    {
+        const uint32_t* tiles = stats.tilePopulation.data() + static_cast<size_t>(tileRow) * stats.tileColumns;
+        for (int tileColumn = 0; tileColumn < stats.tileColumns; tileColumn++)
+        {
+            if (tiles[tileColumn] == 0) continue;
+            if (tileTop < 0) tileTop = tileRow;
+            tileBottom = tileRow;
+            tileLeft = std::min(tileLeft, tileColumn);
+            tileRight = std::max(tileRight, tileColumn);
+        }
+    }
+    if (tileTop < 0)
+    {
+        stats.top = stats.left = 0;
+        stats.bottom = stats.right = -1;
+        return;
+    }
+
+    auto rowHasLife = [&](int row)
+    {
+        const uint64_t* words = live.Row(row);
+        for (int i = tileLeft; i <= tileRight; i++)
+        {
+            if (words[i] != 0) return true;
+        }
+        return false;
+    };
+    stats.top = tileTop * BoardStats::kTileSize;
+    while (!rowHasLife(stats.top)) stats.top++;
+    stats.bottom = std::min(live.GetRows(), (tileBottom + 1) * BoardStats::kTileSize) - 1;
+    while (!rowHasLife(stats.bottom)) stats.bottom--;
+
+    uint64_t leftWord = 0;
+    uint64_t rightWord = 0;
+    for (int row = stats.top; row <= stats.bottom; row++)
+    {
+        leftWord |= live.Row(row)[tileLeft];
+        rightWord |= live.Row(row)[tileRight];
+    }
+    stats.left = tileLeft * 64 + std::countr_zero(leftWord);
+    stats.right = tileRight * 64 + 63 - std::countl_zero(rightWord);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "Grid.h"
+#include "PackedBoard.h"
+#include <cstdint>
+#include <vector>
+
+struct BoardStats
+{
+    // Tiles are kTileSize x kTileSize cells, one packed word wide
+    static constexpr int kTileSize = 64;
+
+    long long generation = 0;
+    // Non-zero cells
+    long long population = 0;
+    // Cells that became non-zero and became zero in the last step; edits do not count
+    long long births = 0;
+    long long deaths = 0;
+    // Smallest rectangle holding every non-zero cell, inclusive; bottom < top when the board is empty
+    int top = 0;
+    int left = 0;
+    int bottom = -1;
+    int right = -1;
+    // Non-zero cells per tile, row-major
+    int tileRows = 0;
+    int tileColumns = 0;
+    std::vector<uint32_t> tilePopulation;
+
+    bool IsEmpty() const { return bottom < top; }
+    // Share of the tile's cells that are non-zero; edge tiles only count cells on the board
+    double TileDensity(int tileRow, int tileColumn, int boardRows, int boardColumns) const;
+};
+
+// Keeps BoardStats up to date from the board after every step. The previous live
+// plane (non-zero cells) is kept packed; the new one is compared word by word and
+// only changed words pay for popcounts, so births, deaths and tile counts come
+// almost free. Engines that know what they changed feed only those words in between
+// BeginStep and EndStep, so the update costs as much as the changes, not the area.
+// The bounding box is found from the tile counts, scanning only the tiles on its edges.
+class StatsTracker
+{
+public:
+    // Full recount after the whole board was replaced; births and deaths start at 0
+    void Reset(const Grid& grid, long long generation);
+    // After a step, from the engine's packed planes or the whole byte grid
+    void Advance(const PackedBoard& board, long long generation);
+    void Advance(const Grid& grid, long long generation);
+    // After a step, from the words the engine changed; every other word must be as before
+    void BeginStep();
+    // Word (row, word) holds columns word * 64 .. word * 64 + 63
+    void UpdateWord(int row, int word, uint64_t after);
+    // Same, packed from the byte grid
+    void RepackWord(const Grid& grid, int row, int word);
+    void EndStep(long long generation);
+    // Whether the tracker was Reset on a board of this size, so BeginStep can be used
+    bool Matches(const Grid& grid) const
+    {
+        return live.GetRows() == grid.GetRows() && live.GetColumns() == grid.GetColumns();
+    }
+    // Single edit between steps
+    void SetCell(int row, int column, bool alive);
+
+    const BoardStats& Get() const { return stats; }
+
+private:
+    void Resize(int rows, int columns);
+    void UpdateBounds();
+
+    PackedBoard live;
+    BoardStats stats;
+};
@@ -0,0 +1,416 @@
+#include "ChangeStream.h"
+#include "History.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define CHANGE_STREAM_POSIX
+#endif
+
+namespace
+{
+    enum FrameKind : uint8_t
+    {
+        FrameKeyframe = 0,
+        FrameDelta = 1
+    };
+
+    // Generous bound for resynchronisation: words plus per-record varints
+    size_t MaxPayloadBytes(const StreamFrameHeader& header)
+    {
+        size_t words = static_cast<size_t>(header.rows) * ((header.columns + 63) / 64) * header.planes;
+        return words * 10 + 16;
+    }
+
+    bool IsPlausible(const StreamFrameHeader& header)
+    {
+        return header.kind <= FrameDelta && header.planes >= 1 && header.planes <= 8 && header.rows > 0 &&
+            header.columns > 0 && header.rows <= (1 << 20) && header.columns <= (1 << 20) &&
+            header.payloadBytes <= MaxPayloadBytes(header);
+    }
+
+#ifdef CHANGE_STREAM_POSIX
+    bool SetNonBlocking(int fd)
+    {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    void DisableSigpipe(int fd, bool isSocket)
+    {
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        if (isSocket) setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+#ifdef F_SETNOSIGPIPE
+        if (!isSocket) fcntl(fd, F_SETNOSIGPIPE, 1);
+#endif
+        (void)fd;
+        (void)isSocket;
+    }
+
+    // Write that reports a gone reader as EPIPE without raising SIGPIPE and without
+    // touching the process signal disposition
+    ssize_t WriteNoSignal(int fd, bool isSocket, const uint8_t* data, size_t size)
+    {
+        if (isSocket)
+        {
+#ifdef MSG_NOSIGNAL
+            return send(fd, data, size, MSG_NOSIGNAL);
+#else
+            return send(fd, data, size, 0); // SO_NOSIGPIPE is set on the socket instead
+#endif
+        }
+#ifdef F_SETNOSIGPIPE
+        return write(fd, data, size);
+#else
+        // FIFO: block SIGPIPE on this thread for the write and discard the one it raised
+        sigset_t pipeSet;
+        sigset_t oldSet;
+        sigemptyset(&pipeSet);
+        sigaddset(&pipeSet, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+        sigset_t pendingSet;
+        sigpending(&pendingSet);
+        const bool wasPending = sigismember(&pendingSet, SIGPIPE) == 1;
+        ssize_t n = write(fd, data, size);
+        int error = errno;
+        if (n < 0 && error == EPIPE && !wasPending)
+        {
+            timespec zero{};
+            while (sigtimedwait(&pipeSet, nullptr, &zero) < 0 && errno == EINTR) {}
+        }
+        pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+        errno = error;
+        return n;
+#endif
+    }
+
+    bool FillAddress(const std::string& path, sockaddr_un& address, std::string* err)
+    {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            if (err) *err = "Socket path too long: " + path;
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+#endif
+}
+
+ChangeStreamWriter::~ChangeStreamWriter()
+{
+    Close();
+}
+
+bool ChangeStreamWriter::Open(const std::string& streamPath, StreamTransport streamTransport, std::string* err)
+{
+    Close();
+#ifdef CHANGE_STREAM_POSIX
+    if (streamTransport == StreamTransport::Fifo)
+    {
+        struct stat info{};
+        if (stat(streamPath.c_str(), &info) == 0 ? !S_ISFIFO(info.st_mode) : mkfifo(streamPath.c_str(), 0600) != 0)
+        {
+            if (err) *err = "Cannot create FIFO: " + streamPath;
+            return false;
+        }
+    }
+    else
+    {
+        sockaddr_un address{};
+        if (!FillAddress(streamPath, address, err)) return false;
+        struct stat info{};
+        if (stat(streamPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) unlink(streamPath.c_str());
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenFd, 8) != 0 || !SetNonBlocking(listenFd))
+        {
+            if (err) *err = "Cannot listen on " + streamPath + ": " + std::strerror(errno);
+            if (listenFd >= 0) close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+    }
+
+    path = streamPath;
+    transport = streamTransport;
+    open = true;
+    previousGeneration = -1;
+    return true;
+#else
+    (void)streamPath;
+    (void)streamTransport;
+    if (err) *err = "Change streams are not supported on this platform";
+    return false;
+#endif
+}
+
+void ChangeStreamWriter::Close()
+{
+#ifdef CHANGE_STREAM_POSIX
+    for (Reader& reader : readers) close(reader.fd);
+    if (listenFd >= 0)
+    {
+        close(listenFd);
+        unlink(path.c_str());
+    }
+#endif
+    readers.clear();
+    listenFd = -1;
+    open = false;
+    path.clear();
+}
+
+void ChangeStreamWriter::AcceptReaders()
+{
+#ifdef CHANGE_STREAM_POSIX
+    if (!open) return;
+    if (transport == StreamTransport::Fifo)
+    {
+        if (!readers.empty()) return;
+        // Fails with ENXIO until someone opens the FIFO for reading
+        int fd = ::open(path.c_str(), O_WRONLY | O_NONBLOCK);
+        if (fd < 0) return;
+        DisableSigpipe(fd, false);
+        readers.push_back(Reader{fd});
+        return;
+    }
+    while (true)
+    {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;
+        if (!SetNonBlocking(fd))
+        {
+            close(fd);
+            continue;
+        }
+        DisableSigpipe(fd, true);
+        readers.push_back(Reader{fd});
+    }
+#endif
+}
+
+void ChangeStreamWriter::BuildFrame(uint8_t kind, long long generation, const PackedBoard& board,
+                                   const std::vector<uint64_t>& words, std::shared_ptr<std::vector<uint8_t>>& frame)
+{
+    if (!frame || frame.use_count() > 1) frame = std::make_shared<std::vector<uint8_t>>();
+
+    StreamFrameHeader header;
+    header.kind = kind;
+    header.planes = static_cast<uint8_t>(board.GetPlanes());
+    header.rows = board.GetRows();
+    header.columns = board.GetColumns();
+    header.generation = generation;
+
+    // Payload goes straight after the header, whose size is patched in afterwards
+    frame->resize(sizeof(header));
+    History::EncodeAppend(words, *frame);
+    header.payloadBytes = static_cast<uint32_t>(frame->size() - sizeof(header));
+    std::memcpy(frame->data(), &header, sizeof(header));
+}
+
+bool ChangeStreamWriter::Flush(Reader& reader)
+{
+#ifdef CHANGE_STREAM_POSIX
+    const bool isSocket = transport == StreamTransport::UnixSocket;
+    while (reader.IsBusy())
+    {
+        const std::vector<uint8_t>& frame = *reader.pending;
+        ssize_t n = WriteNoSignal(reader.fd, isSocket, frame.data() + reader.pendingOffset,
+                                  frame.size() - reader.pendingOffset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        // EPIPE included: the reader hung up
+        if (n <= 0) return false;
+        reader.pendingOffset += static_cast<size_t>(n);
+    }
+    // Let go of the frame so its buffer can be reused
+    reader.pending.reset();
+    reader.pendingOffset = 0;
+#endif
+    return true;
+}
+
+void ChangeStreamWriter::PublishCurrent(long long generation)
+{
+    const PackedBoard& board = current;
+    const bool sameShape = previousGeneration >= 0 && previous.GetRows() == board.GetRows() &&
+        previous.GetColumns() == board.GetColumns() && previous.GetPlanes() == board.GetPlanes();
+    bool keyframeBuilt = false;
+    bool deltaBuilt = false;
+
+    for (size_t i = 0; i < readers.size();)
+    {
+        Reader& reader = readers[i];
+        if (!Flush(reader))
+        {
+#ifdef CHANGE_STREAM_POSIX
+            close(reader.fd);
+#endif
+            readers.erase(readers.begin() + static_cast<std::ptrdiff_t>(i));
+            continue;
+        }
+        ++i;
+        if (reader.IsBusy())
+        {
+            // Still busy with an older frame; it will need a keyframe to catch up
+            ++framesSkipped;
+            continue;
+        }
+
+        const bool useDelta = sameShape && reader.lastGeneration == previousGeneration &&
+            previousGeneration == generation - 1;
+        if (useDelta && !deltaBuilt)
+        {
+            scratch.resize(board.Words().size());
+            for (size_t w = 0; w < scratch.size(); ++w) scratch[w] = board.Words()[w] ^ previous.Words()[w];
+            BuildFrame(FrameDelta, generation, board, scratch, delta);
+            deltaBuilt = true;
+        }
+        else if (!useDelta && !keyframeBuilt)
+        {
+            BuildFrame(FrameKeyframe, generation, board, board.Words(), keyframe);
+            keyframeBuilt = true;
+        }
+
+        reader.pending = useDelta ? delta : keyframe;
+        reader.pendingOffset = 0;
+        reader.lastGeneration = generation;
+        ++(useDelta ? deltasSent : keyframesSent);
+        // Errors surface on the next Publish
+        Flush(reader);
+    }
+
+    // The old previous becomes the buffer the next generation is filled into
+    std::swap(previous, current);
+    previousGeneration = generation;
+}
+
+ChangeStreamReader::~ChangeStreamReader()
+{
+    Close();
+}
+
+bool ChangeStreamReader::Open(const std::string& streamPath, std::string* err)
+{
+    Close();
+#ifdef CHANGE_STREAM_POSIX
+    struct stat info{};
+    if (stat(streamPath.c_str(), &info) != 0)
+    {
+        if (err) *err = "No stream at " + streamPath;
+        return false;
+    }
+    fifo = S_ISFIFO(info.st_mode);
+    if (fifo)
+    {
+        fd = ::open(streamPath.c_str(), O_RDONLY | O_NONBLOCK);
+    }
+    else
+    {
+        sockaddr_un address{};
+        if (!FillAddress(streamPath, address, err)) return false;
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || !SetNonBlocking(fd)))
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (fd < 0)
+    {
+        if (err) *err = "Cannot open stream " + streamPath + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+#else
+    (void)streamPath;
+    if (err) *err = "Change streams are not supported on this platform";
+    return false;
+#endif
+}
+
+void ChangeStreamReader::Close()
+{
+#ifdef CHANGE_STREAM_POSIX
+    if (fd >= 0) close(fd);
+#endif
+    fd = -1;
+    buffer.clear();
+}
+
+bool ChangeStreamReader::Poll()
+{
+#ifdef CHANGE_STREAM_POSIX
+    uint8_t chunk[1 << 16];
+    while (fd >= 0)
+    {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n > 0)
+        {
+            buffer.insert(buffer.end(), chunk, chunk + n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n == 0 && fifo) break;
+        Close();
+    }
+#endif
+    return ApplyFrames();
+}
+
+bool ChangeStreamReader::ApplyFrames()
+{
+    bool changed = false;
+    size_t at = 0;
+    while (buffer.size() - at >= sizeof(StreamFrameHeader))
+    {
+        StreamFrameHeader header;
+        std::memcpy(&header, buffer.data() + at, sizeof(header));
+        if (header.magic != StreamFrameHeader::kMagic || !IsPlausible(header))
+        {
+            // Joined mid-frame: slide forward until a header lines up
+            ++at;
+            continue;
+        }
+        if (buffer.size() - at - sizeof(header) < header.payloadBytes) break;
+
+        const uint8_t* payload = buffer.data() + at + sizeof(header);
+        const bool sameShape = HasBoard() && board.GetRows() == header.rows &&
+            board.GetColumns() == header.columns && board.GetPlanes() == header.planes;
+        if (header.kind == FrameKeyframe)
+        {
+            PackedBoard next(header.rows, header.columns, header.planes);
+            if (History::DecodeXor(payload, header.payloadBytes, next.Words()))
+            {
+                board = std::move(next);
+                generation = header.generation;
+                changed = true;
+            }
+        }
+        else if (sameShape && header.generation == generation + 1)
+        {
+            // Deltas without their base are skipped; one that fails to decode leaves a damaged
+            // board, so wait for the next keyframe then
+            generation = History::DecodeXor(payload, header.payloadBytes, board.Words()) ? header.generation : -1;
+            changed = true;
+        }
+        at += sizeof(header) + header.payloadBytes;
+    }
+    buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(at));
+    return changed;
+}
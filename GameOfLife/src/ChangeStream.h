@@ -0,0 +1,140 @@
+#pragma once
+#include "PackedBoard.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class StreamTransport
+{
+    UnixSocket, // listening socket, any number of viewers
+    Fifo        // named pipe, one reader at a time
+};
+
+// Frame on the wire, native byte order:
+//   u32 magic, u8 kind (0 keyframe, 1 delta), u8 planes, u16 reserved,
+//   i32 rows, i32 columns, i64 generation, u32 payload bytes, payload
+// The payload is the board (keyframe) or its XOR with the previous generation
+// (delta), packed into words and compressed with History's zero-run codec.
+struct StreamFrameHeader
+{
+    static constexpr uint32_t kMagic = 0x534c4f47; // "GOLS"
+
+    uint32_t magic = kMagic;
+    uint8_t kind = 0;
+    uint8_t planes = 1;
+    uint16_t reserved = 0;
+    int32_t rows = 0;
+    int32_t columns = 0;
+    int64_t generation = 0;
+    uint32_t payloadBytes = 0;
+};
+
+// Publishes one frame per generation to every connected reader without ever
+// blocking: all descriptors are non-blocking and a reader whose previous frame has
+// not been fully written yet is skipped. A reader that missed a generation gets a
+// keyframe as soon as it catches up, so slow readers see keyframes only while fast
+// ones get deltas. New readers start with a keyframe. Each frame is encoded once and
+// shared by every reader it goes to. Writes never raise SIGPIPE; a reader that hung
+// up is dropped.
+class ChangeStreamWriter
+{
+public:
+    ChangeStreamWriter() = default;
+    ~ChangeStreamWriter();
+
+    ChangeStreamWriter(const ChangeStreamWriter&) = delete;
+    ChangeStreamWriter& operator=(const ChangeStreamWriter&) = delete;
+
+    bool Open(const std::string& path, StreamTransport transport, std::string* err = nullptr);
+    void Close();
+    bool IsOpen() const { return open; }
+
+    // fillBoard(PackedBoard&) stores the board into the writer's buffer; it is only
+    // called when some reader needs a frame
+    template <typename FillBoard>
+    void Publish(long long generation, FillBoard&& fillBoard)
+    {
+        AcceptReaders();
+        if (readers.empty()) return;
+        fillBoard(current);
+        PublishCurrent(generation);
+    }
+
+    int GetReaderCount() const { return static_cast<int>(readers.size()); }
+    long long GetKeyframesSent() const { return keyframesSent; }
+    long long GetDeltasSent() const { return deltasSent; }
+    long long GetFramesSkipped() const { return framesSkipped; }
+
+private:
+    struct Reader
+    {
+        int fd = -1;
+        long long lastGeneration = -1;
+        // Last frame and how much of it has been written
+        std::shared_ptr<const std::vector<uint8_t>> pending{};
+        size_t pendingOffset = 0;
+
+        bool IsBusy() const { return pending && pendingOffset < pending->size(); }
+    };
+
+    void AcceptReaders();
+    void PublishCurrent(long long generation);
+    // Encodes into frame, reusing its buffer when no reader still holds it
+    static void BuildFrame(uint8_t kind, long long generation, const PackedBoard& board,
+                           const std::vector<uint64_t>& words, std::shared_ptr<std::vector<uint8_t>>& frame);
+    // false once the reader is gone
+    bool Flush(Reader& reader);
+
+    std::string path;
+    StreamTransport transport = StreamTransport::UnixSocket;
+    bool open = false;
+    int listenFd = -1;
+    std::vector<Reader> readers;
+
+    // Swapped after every publish
+    PackedBoard current;
+    PackedBoard previous;
+    long long previousGeneration = -1;
+    std::vector<uint64_t> scratch;
+    std::shared_ptr<std::vector<uint8_t>> keyframe;
+    std::shared_ptr<std::vector<uint8_t>> delta;
+
+    long long keyframesSent = 0;
+    long long deltasSent = 0;
+    long long framesSkipped = 0;
+};
+
+// Viewer side: connects to a socket or opens a FIFO, resynchronises on the frame
+// magic and rebuilds the board from the first keyframe it sees.
+class ChangeStreamReader
+{
+public:
+    ChangeStreamReader() = default;
+    ~ChangeStreamReader();
+
+    ChangeStreamReader(const ChangeStreamReader&) = delete;
+    ChangeStreamReader& operator=(const ChangeStreamReader&) = delete;
+
+    bool Open(const std::string& path, std::string* err = nullptr);
+    void Close();
+    bool IsOpen() const { return fd >= 0; }
+
+    // Reads whatever is available without blocking; true if the board changed.
+    // Closes the stream when the writer went away.
+    bool Poll();
+
+    bool HasBoard() const { return generation >= 0; }
+    const PackedBoard& GetBoard() const { return board; }
+    long long GetGeneration() const { return generation; }
+
+private:
+    bool ApplyFrames();
+
+    int fd = -1;
+    // A FIFO reads end-of-file whenever no writer has it open, which is not the end of the stream
+    bool fifo = false;
+    std::vector<uint8_t> buffer;
+    PackedBoard board;
+    long long generation = -1;
+};
@@ -0,0 +1,285 @@
+#include "EditBuffer.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace
+{
+    // Writes state into the cells of bits in one word of a row
+    void WriteBits(PackedBoard& mask, PackedBoard& values, int row, int word, uint64_t bits, int state)
+    {
+        mask.Row(row)[word] |= bits;
+        for (int plane = 0; plane < values.GetPlanes(); plane++)
+        {
+            uint64_t& value = values.Row(row, plane)[word];
+            value = (state >> plane) & 1 ? value | bits : value & ~bits;
+        }
+    }
+
+    // Columns first..last of a row, clipped to the board
+    void FillSpan(PackedBoard& mask, PackedBoard& values, int row, int first, int last, int state)
+    {
+        if (row < 0 || row >= mask.GetRows()) return;
+        first = std::max(first, 0);
+        last = std::min(last, mask.GetColumns() - 1);
+        for (int word = first / 64; first <= last && word <= last / 64; word++)
+        {
+            const int low = std::max(first - word * 64, 0);
+            const int high = std::min(last - word * 64, 63);
+            const uint64_t bits = (high == 63 ? ~uint64_t{0} : (uint64_t{1} << (high + 1)) - 1) & (~uint64_t{0} << low);
+            WriteBits(mask, values, row, word, bits, state);
+        }
+    }
+
+    void RasterizeStroke(const EditCommand& command, PackedBoard& mask, PackedBoard& values)
+    {
+        const int radius = std::max(command.radius, 0);
+        // Half width of the round brush on each of its rows
+        std::vector<int> halfWidths(2 * radius + 1);
+        for (int dy = -radius; dy <= radius; dy++)
+        {
+            halfWidths[dy + radius] = static_cast<int>(std::sqrt(static_cast<double>(radius * radius - dy * dy)));
+        }
+
+        // Bresenham, so no cell between the two ends is skipped
+        int row = command.row0;
+        int column = command.column0;
+        const int rowSteps = std::abs(command.row1 - row);
+        const int columnSteps = std::abs(command.column1 - column);
+        const int rowStep = row < command.row1 ? 1 : -1;
+        const int columnStep = column < command.column1 ? 1 : -1;
+        int error = columnSteps - rowSteps;
+        for (;;)
+        {
+            for (int dy = -radius; dy <= radius; dy++)
+            {
+                const int half = halfWidths[dy + radius];
+                FillSpan(mask, values, row + dy, column - half, column + half, command.state);
+            }
+            if (row == command.row1 && column == command.column1) break;
+            const int doubled = 2 * error;
+            if (doubled > -rowSteps)
+            {
+                error -= rowSteps;
+                column += columnStep;
+            }
+            if (doubled < columnSteps)
+            {
+                error += columnSteps;
+                row += rowStep;
+            }
+        }
+    }
+
+    void RasterizeStamp(const EditCommand& command, PackedBoard& mask, PackedBoard& values)
+    {
+        if (!command.pattern) return;
+        const PackedBoard oriented = EditBuffer::Oriented(*command.pattern, command.orientation);
+        const int rows = mask.GetRows();
+        const int columns = mask.GetColumns();
+        const int left = ((command.column0 % columns) + columns) % columns;
+        const int patternPlanes = oriented.GetPlanes();
+        const int maxState = (1 << values.GetPlanes()) - 1;
+
+        for (int row = 0; row < oriented.GetRows(); row++)
+        {
+            const int boardRow = ((command.row0 + row) % rows + rows) % rows;
+            // Word copies when the row neither wraps nor needs states lowered, cell by cell otherwise
+            if (left + oriented.GetColumns() <= columns && patternPlanes <= values.GetPlanes())
+            {
+                const int shift = left % 64;
+                for (int word = 0; word < oriented.GetWordsPerRow(); word++)
+                {
+                    uint64_t footprint = 0;
+                    if (command.opaque)
+                    {
+                        footprint = word == oriented.GetWordsPerRow() - 1 ? oriented.GetLastWordMask() : ~uint64_t{0};
+                    }
+                    else
+                    {
+                        for (int plane = 0; plane < patternPlanes; plane++) footprint |= oriented.Row(row, plane)[word];
+                    }
+                    if (footprint == 0) continue;
+
+                    for (int part = 0; part < 2; part++)
+                    {
+                        const int target = left / 64 + word + part;
+                        if (part == 1 && shift == 0) break;
+                        if (target >= mask.GetWordsPerRow()) break;
+                        auto place = [&](uint64_t bits) { return part == 0 ? bits << shift : bits >> (64 - shift); };
+                        const uint64_t bits = place(footprint);
+                        if (bits == 0) continue;
+                        mask.Row(boardRow)[target] |= bits;
+                        for (int plane = 0; plane < values.GetPlanes(); plane++)
+                        {
+                            const uint64_t state = plane < patternPlanes ? place(oriented.Row(row, plane)[word]) : 0;
+                            uint64_t& value = values.Row(boardRow, plane)[target];
+                            value = (value & ~bits) | (state & bits);
+                        }
+                    }
+                }
+                continue;
+            }
+            for (int column = 0; column < oriented.GetColumns(); column++)
+            {
+                const int state = oriented.GetState(row, column);
+                if (state == 0 && !command.opaque) continue;
+                const int boardColumn = (left + column) % columns;
+                FillSpan(mask, values, boardRow, boardColumn, boardColumn, std::min(state, maxState));
+            }
+        }
+    }
+}
+
+void EditBuffer::Stroke(int row0, int column0, int row1, int column1, int radius, int state)
+{
+    EditCommand command;
+    command.kind = EditCommand::Kind::Stroke;
+    command.row0 = row0;
+    command.column0 = column0;
+    command.row1 = row1;
+    command.column1 = column1;
+    command.radius = radius;
+    command.state = state;
+    Record(std::move(command));
+}
+
+void EditBuffer::FillRect(int top, int left, int bottom, int right, int state)
+{
+    EditCommand command;
+    command.kind = EditCommand::Kind::Rect;
+    command.row0 = std::min(top, bottom);
+    command.column0 = std::min(left, right);
+    command.row1 = std::max(top, bottom);
+    command.column1 = std::max(left, right);
+    command.state = state;
+    Record(std::move(command));
+}
+
+void EditBuffer::Stamp(std::shared_ptr<const PackedBoard> pattern, int top, int left, int orientation, bool opaque)
+{
+    EditCommand command;
+    command.kind = EditCommand::Kind::Stamp;
+    command.row0 = top;
+    command.column0 = left;
+    command.orientation = orientation & 7;
+    command.opaque = opaque;
+    command.pattern = std::move(pattern);
+    Record(std::move(command));
+}
+
+void EditBuffer::Record(EditCommand command)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    commands.push_back(std::move(command));
+    pending.store(true, std::memory_order_release);
+}
+
+std::vector<EditCommand> EditBuffer::Take()
+{
+    std::vector<EditCommand> taken;
+    std::lock_guard<std::mutex> lock(mutex);
+    taken.swap(commands);
+    pending.store(false, std::memory_order_release);
+    return taken;
+}
+
+void EditBuffer::Rasterize(const std::vector<EditCommand>& commands, int rows, int columns, int planes,
+                           PackedBoard& mask, PackedBoard& values, EditRows& dirty)
+{
+    if (mask.GetRows() != rows || mask.GetColumns() != columns)
+    {
+        mask = PackedBoard(rows, columns);
+    }
+    else if (!dirty.IsEmpty())
+    {
+        std::fill(mask.Row(dirty.begin), mask.Row(dirty.begin) + static_cast<size_t>(dirty.end - dirty.begin) *
+                  mask.GetWordsPerRow(), uint64_t{0});
+    }
+    dirty = EditRows{};
+    if (values.GetRows() != rows || values.GetColumns() != columns || values.GetPlanes() != planes)
+    {
+        values = PackedBoard(rows, columns, planes);
+    }
+    if (rows <= 0 || columns <= 0) return;
+
+    for (const EditCommand& command : commands)
+    {
+        switch (command.kind)
+        {
+        case EditCommand::Kind::Stroke:
+            RasterizeStroke(command, mask, values);
+            dirty.Include(std::max(std::min(command.row0, command.row1) - std::max(command.radius, 0), 0),
+                          std::min(std::max(command.row0, command.row1) + std::max(command.radius, 0), rows - 1));
+            break;
+        case EditCommand::Kind::Rect:
+            for (int row = std::max(command.row0, 0); row <= std::min(command.row1, rows - 1); row++)
+            {
+                FillSpan(mask, values, row, command.column0, command.column1, command.state);
+            }
+            dirty.Include(std::max(command.row0, 0), std::min(command.row1, rows - 1));
+            break;
+        case EditCommand::Kind::Stamp:
+            RasterizeStamp(command, mask, values);
+            if (command.pattern)
+            {
+                const int height = command.orientation & 4 ? command.pattern->GetColumns() : command.pattern->GetRows();
+                const int top = ((command.row0 % rows) + rows) % rows;
+                // Stamps wrap around the torus
+                if (top + height > rows) dirty.Include(0, rows - 1);
+                else dirty.Include(top, top + height - 1);
+            }
+            break;
+        }
+    }
+}
+
+PackedBoard EditBuffer::Trim(const PackedBoard& board)
+{
+    int top = board.GetRows();
+    int bottom = -1;
+    int left = board.GetColumns();
+    int right = -1;
+    for (int row = 0; row < board.GetRows(); row++)
+    {
+        for (int word = 0; word < board.GetWordsPerRow(); word++)
+        {
+            uint64_t any = 0;
+            for (int plane = 0; plane < board.GetPlanes(); plane++) any |= board.Row(row, plane)[word];
+            if (any == 0) continue;
+            top = std::min(top, row);
+            bottom = row;
+            left = std::min(left, word * 64 + std::countr_zero(any));
+            right = std::max(right, word * 64 + 63 - std::countl_zero(any));
+        }
+    }
+    if (bottom < 0) return PackedBoard(0, 0, board.GetPlanes());
+
+    PackedBoard trimmed(bottom - top + 1, right - left + 1, board.GetPlanes());
+    for (int row = 0; row < trimmed.GetRows(); row++)
+    {
+        for (int column = 0; column < trimmed.GetColumns(); column++)
+        {
+            trimmed.SetState(row, column, board.GetState(top + row, left + column));
+        }
+    }
+    return trimmed;
+}
+
+PackedBoard EditBuffer::Oriented(const PackedBoard& board, int orientation)
+{
+    if (orientation == 0) return board;
+    const bool transpose = orientation & 4;
+    PackedBoard out(transpose ? board.GetColumns() : board.GetRows(), transpose ? board.GetRows() : board.GetColumns(),
+                    board.GetPlanes());
+    for (int row = 0; row < out.GetRows(); row++)
+    {
+        for (int column = 0; column < out.GetColumns(); column++)
+        {
+            const int r = (orientation & 1) ? out.GetRows() - 1 - row : row;
+            const int c = (orientation & 2) ? out.GetColumns() - 1 - column : column;
+            out.SetState(row, column, transpose ? board.GetState(c, r) : board.GetState(r, c));
+        }
+    }
+    return out;
+}
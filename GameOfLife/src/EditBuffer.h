@@ -0,0 +1,83 @@
+#pragma once
+#include "PackedBoard.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct EditCommand
+{
+    enum class Kind
+    {
+        Stroke,
+        Rect,
+        Stamp
+    };
+
+    Kind kind = Kind::Stroke;
+    // Stroke: from (row0, column0) to (row1, column1); Rect: inclusive corners; Stamp: top-left in row0, column0
+    int row0 = 0;
+    int column0 = 0;
+    int row1 = 0;
+    int column1 = 0;
+    // Stroke: round brush, 0 paints single cells
+    int radius = 0;
+    int state = 1;
+    // Stamp: symmetry as in Pattern::Oriented, dead cells overwrite the board when opaque
+    int orientation = 0;
+    bool opaque = false;
+    std::shared_ptr<const PackedBoard> pattern;
+};
+
+// Rows [begin, end) of a rasterized mask that may hold set bits
+struct EditRows
+{
+    int begin = 0;
+    int end = 0;
+
+    bool IsEmpty() const { return begin >= end; }
+    void Include(int first, int last)
+    {
+        if (first > last) return;
+        begin = IsEmpty() ? first : std::min(begin, first);
+        end = IsEmpty() ? last + 1 : std::max(end, last + 1);
+    }
+};
+
+// Board edits recorded by one thread (the UI) and applied by another (the one
+// stepping) between two generations. Recording only appends under a lock. Applying
+// rasterizes every pending command into a mask plane and value planes, whole words
+// at a time, later commands winning where they overlap; the board is then changed
+// in one pass over the masked words.
+// Strokes and rectangles are clipped to the board, stamps wrap around the torus.
+class EditBuffer
+{
+public:
+    void Stroke(int row0, int column0, int row1, int column1, int radius, int state);
+    void FillRect(int top, int left, int bottom, int right, int state);
+    void Stamp(std::shared_ptr<const PackedBoard> pattern, int top, int left, int orientation = 0, bool opaque = false);
+
+    // Lock-free, so checking every generation costs nothing while no one edits
+    bool IsEmpty() const { return !pending.load(std::memory_order_acquire); }
+    // Hands the pending commands to the applying thread
+    std::vector<EditCommand> Take();
+
+    // mask gets a bit for every cell some command writes, values its final state in
+    // values.GetPlanes() planes; both are resized to rows x columns when needed.
+    // Only the rows in dirty, those the previous call wrote, are cleared; dirty then
+    // receives the rows this call writes, so both passes stay as small as the edit.
+    static void Rasterize(const std::vector<EditCommand>& commands, int rows, int columns, int planes,
+                          PackedBoard& mask, PackedBoard& values, EditRows& dirty);
+    // Smallest board holding every non-zero cell, e.g. a loaded pattern to stamp
+    static PackedBoard Trim(const PackedBoard& board);
+    // Symmetry 0..7 of a board, same convention as Pattern::Oriented
+    static PackedBoard Oriented(const PackedBoard& board, int orientation);
+
+private:
+    void Record(EditCommand command);
+
+    std::mutex mutex;
+    std::vector<EditCommand> commands;
+    std::atomic<bool> pending{false};
+};
@@ -0,0 +1,480 @@
+#include "FrameRecorder.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+namespace
+{
+    double SecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    uint8_t Shade(int state, int states)
+    {
+        if (state == 0) return 0;
+        if (state == 1) return 255;
+        // Dying states 2..states-1 fade from 200 to 60
+        int dying = std::max(states - 3, 1);
+        return static_cast<uint8_t>(200 - (state - 2) * 140 / dying);
+    }
+
+    // One gray byte per cell for a whole row, decoded a word at a time
+    void ShadeRow(const PackedBoard& board, int row, int states, uint8_t* out)
+    {
+        for (int w = 0; w < board.GetWordsPerRow(); w++)
+        {
+            std::array<uint64_t, 8> planeWords{};
+            for (int plane = 0; plane < board.GetPlanes(); plane++) planeWords[plane] = board.Row(row, plane)[w];
+            const int end = std::min(64, board.GetColumns() - w * 64);
+            for (int bit = 0; bit < end; bit++)
+            {
+                int state = 0;
+                for (int plane = 0; plane < board.GetPlanes(); plane++)
+                {
+                    state |= static_cast<int>((planeWords[plane] >> bit) & 1) << plane;
+                }
+                out[w * 64 + bit] = Shade(state, states);
+            }
+        }
+    }
+
+    const std::array<uint32_t, 256>& CrcTable()
+    {
+        static const std::array<uint32_t, 256> table = []
+        {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t n = 0; n < 256; n++)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+    {
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++) crc = CrcTable()[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    uint32_t Adler32(const std::vector<uint8_t>& data)
+    {
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for (size_t i = 0; i < data.size();)
+        {
+            // 5552 bytes is the longest run that cannot overflow before the modulo
+            size_t end = std::min(data.size(), i + 5552);
+            for (; i < end; i++)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    void PutBigEndian(std::vector<uint8_t>& out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+        void Put(uint32_t bits, int count)
+        {
+            buffer |= static_cast<uint64_t>(bits) << used;
+            used += count;
+            while (used >= 8)
+            {
+                out.push_back(static_cast<uint8_t>(buffer));
+                buffer >>= 8;
+                used -= 8;
+            }
+        }
+
+        // Huffman codes go out most significant bit first
+        void PutCode(uint32_t code, int length)
+        {
+            uint32_t reversed = 0;
+            for (int i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+            Put(reversed, length);
+        }
+
+        void Flush()
+        {
+            if (used > 0) out.push_back(static_cast<uint8_t>(buffer));
+            buffer = 0;
+            used = 0;
+        }
+
+    private:
+        std::vector<uint8_t>& out;
+        uint64_t buffer = 0;
+        int used = 0;
+    };
+
+    void PutLiteral(BitWriter& bits, int symbol)
+    {
+        if (symbol < 144) bits.PutCode(0x30 + symbol, 8);
+        else if (symbol < 256) bits.PutCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280) bits.PutCode(symbol - 256, 7);
+        else bits.PutCode(0xc0 + symbol - 280, 8);
+    }
+
+    void PutMatch(BitWriter& bits, int length, int distance)
+    {
+        static const int lengthBase[] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                         31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const int lengthExtra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const int distanceBase[] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,
+                                           33,  49,  65,  97,  129, 193,  257,  385,  513,  769,
+                                           1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const int distanceExtra[] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        int l = 28;
+        while (lengthBase[l] > length) l--;
+        PutLiteral(bits, 257 + l);
+        bits.Put(static_cast<uint32_t>(length - lengthBase[l]), lengthExtra[l]);
+        int d = 29;
+        while (distanceBase[d] > distance) d--;
+        bits.PutCode(static_cast<uint32_t>(d), 5);
+        bits.Put(static_cast<uint32_t>(distance - distanceBase[d]), distanceExtra[d]);
+    }
+
+    // zlib stream with one fixed-Huffman deflate block. Only two match distances are
+    // tried, the previous byte and the row above, which is where nearly all the
+    // redundancy of a Life board is; it is far cheaper than a general matcher.
+    void Deflate(const std::vector<uint8_t>& data, size_t stride, std::vector<uint8_t>& out)
+    {
+        out.push_back(0x78);
+        out.push_back(0x01);
+        BitWriter bits(out);
+        bits.Put(1, 1); // final block
+        bits.Put(1, 2); // fixed Huffman codes
+
+        auto matchLength = [&](size_t at, size_t distance)
+        {
+            if (distance == 0 || distance > at || distance > 32768) return size_t{0};
+            size_t limit = std::min<size_t>(258, data.size() - at);
+            size_t length = 0;
+            while (length < limit && data[at + length] == data[at + length - distance]) length++;
+            return length;
+        };
+
+        for (size_t at = 0; at < data.size();)
+        {
+            size_t runLength = matchLength(at, 1);
+            size_t rowLength = matchLength(at, stride);
+            size_t length = std::max(runLength, rowLength);
+            if (length >= 3)
+            {
+                PutMatch(bits, static_cast<int>(length), static_cast<int>(rowLength >= runLength ? stride : 1));
+                at += length;
+            }
+            else
+            {
+                PutLiteral(bits, data[at++]);
+            }
+        }
+        PutLiteral(bits, 256);
+        bits.Flush();
+        PutBigEndian(out, Adler32(data));
+    }
+
+    void PutChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+    {
+        PutBigEndian(out, static_cast<uint32_t>(data.size()));
+        size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        PutBigEndian(out, Crc32(out.data() + start, out.size() - start));
+    }
+
+    uint8_t ReverseBits(uint8_t value)
+    {
+        value = static_cast<uint8_t>((value & 0xf0) >> 4 | (value & 0x0f) << 4);
+        value = static_cast<uint8_t>((value & 0xcc) >> 2 | (value & 0x33) << 2);
+        return static_cast<uint8_t>((value & 0xaa) >> 1 | (value & 0x55) << 1);
+    }
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    Close();
+}
+
+bool FrameRecorder::Open(const RecordOptions& recordOptions, std::string* err)
+{
+    Close();
+    if (recordOptions.path.empty())
+    {
+        if (err) *err = "No recording path given";
+        return false;
+    }
+    options = recordOptions;
+    options.every = std::max(options.every, 1);
+    options.queueDepth = std::max(options.queueDepth, 1);
+    options.framesPerSecond = std::max(options.framesPerSecond, 1);
+    if (options.threads <= 0)
+    {
+        options.threads = std::clamp(static_cast<int>(std::thread::hardware_concurrency()) / 2, 1, 4);
+    }
+
+    if (options.format == RecordFormat::Y4m)
+    {
+        stream = std::fopen(options.path.c_str(), "wb");
+        if (!stream)
+        {
+            if (err) *err = "Cannot open file for writing: " + options.path;
+            return false;
+        }
+    }
+
+    stats = RecordStats{};
+    firstError.clear();
+    streamRows = streamColumns = 0;
+    nextSequence = nextToWrite = 0;
+    stopping = false;
+    open = true;
+    for (int t = 0; t < options.threads; t++) threads.emplace_back(&FrameRecorder::Run, this);
+    return true;
+}
+
+bool FrameRecorder::Close(std::string* err)
+{
+    if (!open) return true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    // Encoders drain the queue before they exit
+    queueChanged.notify_all();
+    for (auto& thread : threads) thread.join();
+    threads.clear();
+    if (stream) std::fclose(stream);
+    stream = nullptr;
+    finished.clear();
+    spareBoards.clear();
+    open = false;
+
+    if (!firstError.empty())
+    {
+        if (err) *err = firstError;
+        return false;
+    }
+    return true;
+}
+
+RecordStats FrameRecorder::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void FrameRecorder::Submit(long long generation, const PackedBoard& board, int states)
+{
+    if (!open) return;
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    ++stats.framesSubmitted;
+    if (options.format == RecordFormat::Y4m)
+    {
+        // A Y4m stream has one frame size
+        if (streamRows == 0)
+        {
+            streamRows = board.GetRows();
+            streamColumns = board.GetColumns();
+        }
+        if (board.GetRows() != streamRows || board.GetColumns() != streamColumns)
+        {
+            ++stats.framesFailed;
+            if (firstError.empty()) firstError = "Board size changed during a Y4M recording";
+            return;
+        }
+    }
+    queueChanged.wait(lock, [this] { return static_cast<int>(queue.size()) < options.queueDepth; });
+
+    Frame frame;
+    frame.sequence = nextSequence++;
+    frame.generation = generation;
+    frame.states = states;
+    if (!spareBoards.empty())
+    {
+        frame.board = std::move(spareBoards.back());
+        spareBoards.pop_back();
+    }
+    // Copy assignment reuses the spare board's words when the size matches
+    frame.board = board;
+    queue.push_back(std::move(frame));
+    stats.submitSeconds += SecondsSince(start);
+    lock.unlock();
+    queueChanged.notify_all();
+}
+
+void FrameRecorder::Run()
+{
+    std::vector<uint8_t> bytes;
+    while (true)
+    {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        queueChanged.notify_all();
+
+        auto start = std::chrono::steady_clock::now();
+        Encode(frame, bytes);
+        bool ok = true;
+        if (options.format != RecordFormat::Y4m)
+        {
+            std::string path = FramePath(frame.generation);
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+            ok = file && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+            if (file) ok = std::fclose(file) == 0 && ok;
+            if (!ok) Fail("Cannot write " + path);
+        }
+        double seconds = SecondsSince(start);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.encodeSeconds += seconds;
+        if (options.format == RecordFormat::Y4m)
+        {
+            WriteInOrder(frame.sequence, std::move(bytes));
+            bytes.clear();
+        }
+        else
+        {
+            ++(ok ? stats.framesWritten : stats.framesFailed);
+        }
+        spareBoards.push_back(std::move(frame.board));
+    }
+}
+
+void FrameRecorder::Encode(const Frame& frame, std::vector<uint8_t>& out) const
+{
+    out.clear();
+    if (options.format == RecordFormat::Png) EncodePng(frame.board, frame.states, out);
+    else if (options.format == RecordFormat::Ppm) EncodePpm(frame.board, frame.states, out);
+    else EncodeY4mFrame(frame.board, frame.states, out);
+}
+
+void FrameRecorder::WriteInOrder(long long sequence, std::vector<uint8_t> bytes)
+{
+    finished.emplace(sequence, std::move(bytes));
+    while (!finished.empty() && finished.begin()->first == nextToWrite)
+    {
+        const std::vector<uint8_t>& frameBytes = finished.begin()->second;
+        if (nextToWrite == 0)
+        {
+            std::fprintf(stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 Cmono\n", streamColumns, streamRows,
+                         options.framesPerSecond);
+        }
+        bool written = std::fwrite(frameBytes.data(), 1, frameBytes.size(), stream) == frameBytes.size();
+        ++(written ? stats.framesWritten : stats.framesFailed);
+        if (!written && firstError.empty()) firstError = "Cannot write " + options.path;
+        finished.erase(finished.begin());
+        ++nextToWrite;
+    }
+}
+
+std::string FrameRecorder::FramePath(long long generation) const
+{
+    char number[32];
+    std::snprintf(number, sizeof(number), "%06lld", generation);
+    return options.path + number + (options.format == RecordFormat::Png ? ".png" : ".ppm");
+}
+
+void FrameRecorder::Fail(const std::string& message)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (firstError.empty()) firstError = message;
+}
+
+void FrameRecorder::EncodePng(const PackedBoard& board, int states, std::vector<uint8_t>& out)
+{
+    const int rows = board.GetRows();
+    const int columns = board.GetColumns();
+    const bool bilevel = board.GetPlanes() == 1;
+    // Two-state boards are 1-bit grayscale, taken straight from the words
+    const size_t rowBytes = bilevel ? (static_cast<size_t>(columns) + 7) / 8 : static_cast<size_t>(columns);
+
+    std::vector<uint8_t> pixels((rowBytes + 1) * rows);
+    for (int row = 0; row < rows; row++)
+    {
+        uint8_t* line = pixels.data() + (rowBytes + 1) * row;
+        line[0] = 0; // no filter
+        if (bilevel)
+        {
+            const uint64_t* words = board.Row(row);
+            // PNG packs the leftmost pixel into the high bit, the board into the low bit
+            for (size_t b = 0; b < rowBytes; b++) line[1 + b] = ReverseBits(static_cast<uint8_t>(words[b / 8] >> (b % 8 * 8)));
+        }
+        else
+        {
+            ShadeRow(board, row, states, line + 1);
+        }
+    }
+
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    out.insert(out.end(), signature, signature + sizeof(signature));
+
+    std::vector<uint8_t> header;
+    PutBigEndian(header, static_cast<uint32_t>(columns));
+    PutBigEndian(header, static_cast<uint32_t>(rows));
+    header.push_back(bilevel ? 1 : 8); // bit depth
+    header.push_back(0);               // grayscale
+    header.push_back(0);               // deflate
+    header.push_back(0);               // adaptive filtering
+    header.push_back(0);               // not interlaced
+    PutChunk(out, "IHDR", header);
+
+    std::vector<uint8_t> compressed;
+    Deflate(pixels, rowBytes + 1, compressed);
+    PutChunk(out, "IDAT", compressed);
+    PutChunk(out, "IEND", {});
+}
+
+void FrameRecorder::EncodePpm(const PackedBoard& board, int states, std::vector<uint8_t>& out)
+{
+    char header[64];
+    int length = std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", board.GetColumns(), board.GetRows());
+    out.insert(out.end(), header, header + length);
+
+    std::vector<uint8_t> shades(static_cast<size_t>(board.GetWordsPerRow()) * 64);
+    for (int row = 0; row < board.GetRows(); row++)
+    {
+        ShadeRow(board, row, states, shades.data());
+        for (int column = 0; column < board.GetColumns(); column++) out.insert(out.end(), 3, shades[column]);
+    }
+}
+
+void FrameRecorder::EncodeY4mFrame(const PackedBoard& board, int states, std::vector<uint8_t>& out)
+{
+    static const char marker[] = "FRAME\n";
+    out.insert(out.end(), marker, marker + 6);
+    size_t start = out.size();
+    out.resize(start + static_cast<size_t>(board.GetRows()) * board.GetColumns());
+    std::vector<uint8_t> shades(static_cast<size_t>(board.GetWordsPerRow()) * 64);
+    for (int row = 0; row < board.GetRows(); row++)
+    {
+        ShadeRow(board, row, states, shades.data());
+        std::copy(shades.begin(), shades.begin() + board.GetColumns(),
+                  out.begin() + static_cast<std::ptrdiff_t>(start + static_cast<size_t>(row) * board.GetColumns()));
+    }
+}
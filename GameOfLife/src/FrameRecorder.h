@@ -0,0 +1,114 @@
+#pragma once
+#include "PackedBoard.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class RecordFormat
+{
+    Png, // one file per frame, 1-bit grayscale for two-state boards
+    Ppm, // one binary P6 file per frame
+    Y4m  // one YUV4MPEG2 stream, luma only, ready for ffmpeg
+};
+
+struct RecordOptions
+{
+    // File prefix for Png/Ppm ("frames/gen_" gives frames/gen_000042.png), file name for Y4m
+    std::string path;
+    RecordFormat format = RecordFormat::Png;
+    // Record generations divisible by every
+    int every = 1;
+    // Encoder threads, <= 0 picks a few
+    int threads = 0;
+    // Frames waiting for an encoder; Submit blocks while the queue is full
+    int queueDepth = 8;
+    // Frame rate written into the Y4m header
+    int framesPerSecond = 30;
+};
+
+struct RecordStats
+{
+    long long framesSubmitted = 0;
+    long long framesWritten = 0;
+    // Frames that failed to encode or write, or changed size in a Y4m stream
+    long long framesFailed = 0;
+    // Time the simulation thread spent copying frames and waiting for queue space
+    double submitSeconds = 0.0;
+    // Encoder thread time, summed over threads
+    double encodeSeconds = 0.0;
+};
+
+// Writes boards as images with one pixel per cell. Encoding works from the packed
+// cell words and runs on a small pool of threads behind a bounded queue, so the
+// caller only pays for one copy of the words per recorded generation. Y4m frames
+// are encoded in parallel and written in submission order.
+// States map to gray: 0 black, 1 white, dying Generations states fading from light to dark gray.
+class FrameRecorder
+{
+public:
+    FrameRecorder() = default;
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    bool Open(const RecordOptions& options, std::string* err = nullptr);
+    // Waits for queued frames; false if any frame failed
+    bool Close(std::string* err = nullptr);
+    bool IsOpen() const { return open; }
+    const RecordOptions& GetOptions() const { return options; }
+
+    bool WantsGeneration(long long generation) const { return open && generation % options.every == 0; }
+    void Submit(long long generation, const PackedBoard& board, int states);
+
+    RecordStats GetStats() const;
+
+    // Encoders, also usable on their own
+    static void EncodePng(const PackedBoard& board, int states, std::vector<uint8_t>& out);
+    static void EncodePpm(const PackedBoard& board, int states, std::vector<uint8_t>& out);
+    // FRAME marker and luma plane, without the stream header
+    static void EncodeY4mFrame(const PackedBoard& board, int states, std::vector<uint8_t>& out);
+
+private:
+    struct Frame
+    {
+        long long sequence = 0;
+        long long generation = 0;
+        int states = 2;
+        PackedBoard board;
+    };
+
+    void Run();
+    void Encode(const Frame& frame, std::vector<uint8_t>& out) const;
+    // Writes a finished Y4m frame once every earlier one is written; called with mutex held
+    void WriteInOrder(long long sequence, std::vector<uint8_t> bytes);
+    std::string FramePath(long long generation) const;
+    void Fail(const std::string& message);
+
+    RecordOptions options;
+    bool open = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable queueChanged;
+    std::deque<Frame> queue;
+    // Boards handed back by encoders, reused by Submit to avoid reallocating
+    std::vector<PackedBoard> spareBoards;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    std::FILE* stream = nullptr;
+    int streamRows = 0;
+    int streamColumns = 0;
+    long long nextSequence = 0;
+    long long nextToWrite = 0;
+    std::map<long long, std::vector<uint8_t>> finished;
+
+    RecordStats stats;
+    std::string firstError;
+};
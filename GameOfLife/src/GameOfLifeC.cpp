@@ -0,0 +1,295 @@
+#include "GameOfLifeC.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <new>
+#include <string>
+#include <vector>
+
+struct gol_simulation
+{
+    gol_simulation(int32_t rows, int32_t columns) : simulation(columns, rows, 1) {}
+
+    int Fail(int status, std::string message) const
+    {
+        error = std::move(message);
+        return status;
+    }
+
+    Simulation simulation;
+    mutable std::string error;
+    // int32 copy of the byte grid behind gol_cells_view, refreshed once per revision
+    mutable std::vector<int32_t> cells;
+    mutable long long cellsRevision = -1;
+};
+
+namespace
+{
+    // Runs the body of an entry point; no exception may reach the C caller
+    template <typename Body>
+    int Guarded(const gol_simulation* simulation, Body body)
+    {
+        try
+        {
+            return body();
+        }
+        catch (const std::bad_alloc&)
+        {
+            return simulation->Fail(GOL_ERROR_MEMORY, "Out of memory");
+        }
+        catch (const std::exception& e)
+        {
+            return simulation->Fail(GOL_ERROR_INTERNAL, e.what());
+        }
+        catch (...)
+        {
+            return simulation->Fail(GOL_ERROR_INTERNAL, "Unknown error");
+        }
+    }
+}
+
+uint32_t gol_abi_version(void)
+{
+    return GOL_ABI_VERSION;
+}
+
+gol_simulation* gol_create(int32_t rows, int32_t columns)
+{
+    if (rows <= 0 || columns <= 0) return nullptr;
+    try
+    {
+        return new gol_simulation(rows, columns);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void gol_destroy(gol_simulation* simulation)
+{
+    delete simulation;
+}
+
+int gol_set_rule(gol_simulation* simulation, const char* rule)
+{
+    if (!simulation || !rule) return GOL_ERROR_ARGUMENT;
+    return Guarded(simulation, [&]() -> int
+    {
+        std::string error;
+        if (!simulation->simulation.SetRule(rule, &error)) return simulation->Fail(GOL_ERROR_RULE, error);
+        return GOL_OK;
+    });
+}
+
+int gol_set_engine(gol_simulation* simulation, const char* engine)
+{
+    if (!simulation || !engine) return GOL_ERROR_ARGUMENT;
+    return Guarded(simulation, [&]() -> int
+    {
+        StepEngine parsed;
+        if (!Simulation::ParseStepEngine(engine, parsed))
+        {
+            return simulation->Fail(GOL_ERROR_ARGUMENT, std::string("Unknown engine: ") + engine);
+        }
+        simulation->simulation.SetStepEngine(parsed);
+        return GOL_OK;
+    });
+}
+
+int gol_step(gol_simulation* simulation, int64_t generations)
+{
+    if (!simulation) return GOL_ERROR_ARGUMENT;
+    if (generations < 0) return simulation->Fail(GOL_ERROR_ARGUMENT, "Generations must not be negative");
+    return Guarded(simulation, [&]() -> int
+    {
+        simulation->simulation.Advance(generations);
+        return GOL_OK;
+    });
+}
+
+int64_t gol_generation(const gol_simulation* simulation)
+{
+    return simulation ? simulation->simulation.GetGeneration() : 0;
+}
+
+int64_t gol_population(const gol_simulation* simulation)
+{
+    return simulation ? simulation->simulation.GetPopulation() : 0;
+}
+
+int gol_get_bytes(const gol_simulation* simulation, gol_bytes_view* out)
+{
+    if (!simulation || !out) return GOL_ERROR_ARGUMENT;
+    const Simulation& sim = simulation->simulation;
+    out->cells = sim.GetCells();
+    out->rows = sim.GetRows();
+    out->columns = sim.GetColumns();
+    out->stride = static_cast<size_t>(sim.GetColumns());
+    out->generation = sim.GetGeneration();
+    out->revision = sim.GetBoardRevision();
+    return GOL_OK;
+}
+
+int gol_get_cells(const gol_simulation* simulation, gol_cells_view* out)
+{
+    if (!simulation || !out) return GOL_ERROR_ARGUMENT;
+    return Guarded(simulation, [&]() -> int
+    {
+        const Simulation& sim = simulation->simulation;
+        // The ABI 1 view has int32 cells; the grid holds bytes, so widen them here
+        if (simulation->cellsRevision != sim.GetBoardRevision() || simulation->cells.empty())
+        {
+            const uint8_t* bytes = sim.GetCells();
+            simulation->cells.assign(bytes, bytes + static_cast<size_t>(sim.GetRows()) * sim.GetColumns());
+            simulation->cellsRevision = sim.GetBoardRevision();
+        }
+        out->cells = simulation->cells.data();
+        out->rows = sim.GetRows();
+        out->columns = sim.GetColumns();
+        out->stride = static_cast<size_t>(sim.GetColumns());
+        out->generation = sim.GetGeneration();
+        out->revision = sim.GetBoardRevision();
+        return GOL_OK;
+    });
+}
+
+int gol_get_packed(gol_simulation* simulation, gol_packed_view* out)
+{
+    if (!simulation || !out) return GOL_ERROR_ARGUMENT;
+    return Guarded(simulation, [&]() -> int
+    {
+        Simulation& sim = simulation->simulation;
+        const PackedBoard& board = sim.GetPackedCells();
+        out->words = board.Words().data();
+        out->rows = board.GetRows();
+        out->columns = board.GetColumns();
+        out->planes = board.GetPlanes();
+        out->stride = static_cast<size_t>(board.GetWordsPerRow());
+        out->plane_stride = static_cast<size_t>(board.GetWordsPerRow()) * board.GetRows();
+        out->generation = sim.GetGeneration();
+        out->revision = sim.GetBoardRevision();
+        return GOL_OK;
+    });
+}
+
+int gol_load_bytes(gol_simulation* simulation, const uint8_t* cells, size_t stride)
+{
+    if (!simulation) return GOL_ERROR_ARGUMENT;
+    Simulation& sim = simulation->simulation;
+    if (!cells || stride < static_cast<size_t>(sim.GetColumns()))
+    {
+        return simulation->Fail(GOL_ERROR_ARGUMENT, "No cells, or a stride smaller than a row");
+    }
+    return Guarded(simulation, [&]() -> int
+    {
+        // One pass for the largest state per row; a state the rule does not have would
+        // throw off the population, ages and engines
+        for (int row = 0; row < sim.GetRows(); row++)
+        {
+            const uint8_t* line = cells + row * stride;
+            if (*std::max_element(line, line + sim.GetColumns()) < sim.GetStates()) continue;
+            const int column = static_cast<int>(
+                std::find_if(line, line + sim.GetColumns(), [&](uint8_t state) { return state >= sim.GetStates(); }) -
+                line);
+            return simulation->Fail(GOL_ERROR_ARGUMENT, "Cell " + std::to_string(row) + "," +
+                                                            std::to_string(column) + " has state " +
+                                                            std::to_string(line[column]) + ", the rule has " +
+                                                            std::to_string(sim.GetStates()));
+        }
+        sim.LoadCells(cells, stride);
+        return GOL_OK;
+    });
+}
+
+int gol_load_cells(gol_simulation* simulation, const int32_t* cells, size_t stride)
+{
+    if (!simulation) return GOL_ERROR_ARGUMENT;
+    Simulation& sim = simulation->simulation;
+    if (!cells || stride < static_cast<size_t>(sim.GetColumns()))
+    {
+        return simulation->Fail(GOL_ERROR_ARGUMENT, "No cells, or a stride smaller than a row");
+    }
+    return Guarded(simulation, [&]() -> int
+    {
+        // Narrowed to the grid's bytes; a state the rule does not have would throw off
+        // the population, ages and engines
+        std::vector<uint8_t> bytes(static_cast<size_t>(sim.GetRows()) * sim.GetColumns());
+        for (int row = 0; row < sim.GetRows(); row++)
+        {
+            const int32_t* line = cells + row * stride;
+            for (int column = 0; column < sim.GetColumns(); column++)
+            {
+                if (line[column] < 0 || line[column] >= sim.GetStates())
+                {
+                    return simulation->Fail(GOL_ERROR_ARGUMENT, "Cell " + std::to_string(row) + "," +
+                                                                    std::to_string(column) + " has state " +
+                                                                    std::to_string(line[column]) + ", the rule has " +
+                                                                    std::to_string(sim.GetStates()));
+                }
+                bytes[static_cast<size_t>(row) * sim.GetColumns() + column] = static_cast<uint8_t>(line[column]);
+            }
+        }
+        sim.LoadCells(bytes.data(), static_cast<size_t>(sim.GetColumns()));
+        return GOL_OK;
+    });
+}
+
+int gol_load_packed(gol_simulation* simulation, const uint64_t* words, size_t stride, size_t plane_stride)
+{
+    if (!simulation || !words) return GOL_ERROR_ARGUMENT;
+    const Simulation& sim = simulation->simulation;
+    const size_t wordsPerRow = (static_cast<size_t>(sim.GetColumns()) + 63) / 64;
+    if (stride < wordsPerRow || (PlanesForStates(sim.GetStates()) > 1 && plane_stride < stride * sim.GetRows()))
+    {
+        return simulation->Fail(GOL_ERROR_ARGUMENT, "Strides are smaller than a row or a plane");
+    }
+    return Guarded(simulation, [&]() -> int
+    {
+        // Planes whose bits spell a state >= states, compared 64 cells at a time from the
+        // top plane down: above marks cells already known to be larger than the highest
+        // state, equal those matching it so far
+        const int planes = PlanesForStates(sim.GetStates());
+        const int highest = sim.GetStates() - 1;
+        const uint64_t lastWordMask =
+            sim.GetColumns() % 64 == 0 ? ~uint64_t{0} : (uint64_t{1} << (sim.GetColumns() % 64)) - 1;
+        for (int row = 0; planes > 1 && row < sim.GetRows(); row++)
+        {
+            for (size_t w = 0; w < wordsPerRow; w++)
+            {
+                uint64_t above = 0;
+                uint64_t equal = w + 1 == wordsPerRow ? lastWordMask : ~uint64_t{0};
+                for (int plane = planes - 1; plane >= 0; plane--)
+                {
+                    const uint64_t bits = words[plane * plane_stride + row * stride + w];
+                    if ((highest >> plane) & 1) equal &= bits;
+                    else
+                    {
+                        above |= equal & bits;
+                        equal &= ~bits;
+                    }
+                }
+                if (above == 0) continue;
+                const int column = static_cast<int>(w * 64) + std::countr_zero(above);
+                int state = 0;
+                for (int plane = 0; plane < planes; plane++)
+                {
+                    state |= static_cast<int>((words[plane * plane_stride + row * stride + w] >> (column % 64)) & 1)
+                        << plane;
+                }
+                return simulation->Fail(GOL_ERROR_ARGUMENT, "Cell " + std::to_string(row) + "," +
+                                                                std::to_string(column) + " has state " +
+                                                                std::to_string(state) + ", the rule has " +
+                                                                std::to_string(sim.GetStates()));
+            }
+        }
+        simulation->simulation.LoadPackedCells(words, stride, plane_stride);
+        return GOL_OK;
+    });
+}
+
+const char* gol_last_error(const gol_simulation* simulation)
+{
+    return simulation ? simulation->error.c_str() : "";
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* C interface for embedding the simulator. Every function is safe to call with
+ * a null simulation and reports GOL_ERROR_ARGUMENT for it. No C++ exception
+ * leaves it: failures come back as status codes with gol_last_error. A
+ * simulation must not be used from two threads at once.
+ *
+ * The views point into storage the simulation owns and stay valid until the
+ * next step, edit or load on it. gol_get_bytes and gol_load_bytes work on the
+ * simulation's own byte grid; the int32 calls of ABI 1 copy, see each below. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped when a struct or signature below changes.
+ * 2: gol_bytes_view, gol_get_bytes and gol_load_bytes */
+#define GOL_ABI_VERSION 2
+
+enum
+{
+    GOL_OK = 0,
+    GOL_ERROR_ARGUMENT = -1,
+    GOL_ERROR_RULE = -2,
+    GOL_ERROR_MEMORY = -3,
+    /* Any other failure inside the library; gol_last_error has the message */
+    GOL_ERROR_INTERNAL = -4
+};
+
+typedef struct gol_simulation gol_simulation;
+
+/* One byte per cell, row-major: the simulation's own storage */
+typedef struct gol_bytes_view
+{
+    const uint8_t* cells;
+    int32_t rows;
+    int32_t columns;
+    /* Bytes from one row to the next */
+    size_t stride;
+    int64_t generation;
+    /* Changes whenever any cell may have changed */
+    int64_t revision;
+} gol_bytes_view;
+
+/* One int32 state per cell, row-major */
+typedef struct gol_cells_view
+{
+    const int32_t* cells;
+    int32_t rows;
+    int32_t columns;
+    /* Elements from one row to the next */
+    size_t stride;
+    int64_t generation;
+    /* Changes whenever any cell may have changed */
+    int64_t revision;
+} gol_cells_view;
+
+/* One bit per cell, bit (column % 64) of word (column / 64); a cell's state is
+ * bit i of plane i. Two-state rules have one plane. */
+typedef struct gol_packed_view
+{
+    const uint64_t* words;
+    int32_t rows;
+    int32_t columns;
+    int32_t planes;
+    /* Words from one row to the next, and from one plane to the next */
+    size_t stride;
+    size_t plane_stride;
+    int64_t generation;
+    int64_t revision;
+} gol_packed_view;
+
+uint32_t gol_abi_version(void);
+
+/* Empty toroidal board running B3/S23; null on bad sizes or out of memory */
+gol_simulation* gol_create(int32_t rows, int32_t columns);
+void gol_destroy(gol_simulation* simulation);
+
+/* Rule text as the GUI takes it: B3/S23, B2/S/C3 (Generations) or R2,C2,S5..8,B6..9 (Larger than Life) */
+int gol_set_rule(gol_simulation* simulation, const char* rule);
+/* "auto", "dense", "sparse", "bitsliced", "block" or "tiled" */
+int gol_set_engine(gol_simulation* simulation, const char* engine);
+int gol_step(gol_simulation* simulation, int64_t generations);
+
+int64_t gol_generation(const gol_simulation* simulation);
+int64_t gol_population(const gol_simulation* simulation);
+
+/* Zero-copy: the view is the simulation's byte grid itself */
+int gol_get_bytes(const gol_simulation* simulation, gol_bytes_view* out);
+/* Compatibility with ABI 1. The simulation stores a byte per cell, so the first
+ * call after a change widens the board into an int32 copy it keeps; later calls
+ * reuse it. Prefer gol_get_bytes. */
+int gol_get_cells(const gol_simulation* simulation, gol_cells_view* out);
+/* Zero-copy only when the bit-sliced engine made the last step: the view is then
+ * the engine's own board. With every other engine the cells are packed into a
+ * copy the simulation keeps, once per revision, so repeated calls between steps
+ * cost nothing but the first one touches the whole board. */
+int gol_get_packed(gol_simulation* simulation, gol_packed_view* out);
+
+/* Replace every cell from a caller's buffer laid out like the views. A state
+ * not below the rule's state count fails with GOL_ERROR_ARGUMENT and leaves the
+ * board unchanged. */
+/* Rows are checked and copied straight into the byte grid */
+int gol_load_bytes(gol_simulation* simulation, const uint8_t* cells, size_t stride);
+/* Compatibility with ABI 1: narrowed into a temporary byte board first. Prefer gol_load_bytes. */
+int gol_load_cells(gol_simulation* simulation, const int32_t* cells, size_t stride);
+/* Unpacked a word (64 cells) at a time */
+int gol_load_packed(gol_simulation* simulation, const uint64_t* words, size_t stride, size_t plane_stride);
+
+/* Message for the last failed call on this simulation, "" if none */
+const char* gol_last_error(const gol_simulation* simulation);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,76 +1,72 @@
 #include "Grid.h"
 #include "raylib.h"
-#include <random>
+#include <algorithm>
+#include <array>
+#include <cmath>
 
-Grid::Grid(int width, int height, int cellSize)
-    : cellSize(cellSize)
-{
-    rows = height / cellSize;
-    columns = width / cellSize;
-    cells.resize(rows, std::vector<int>(columns, 0));
-}
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GRID_AGES_SSE2
+#endif
 
-void Grid::Draw() const
+// Young cells are bright green, then yellow, orange and finally dim purple for long-lived debris
+static const std::array<Color, 256>& AgePalette()
 {
-    for (int row = 0; row < rows; row++)
+    static const std::array<Color, 256> palette = []
     {
-        for (int column = 0; column < columns; column++)
+        const Color stops[] = {{0, 255, 80, 255}, {230, 230, 0, 255}, {255, 120, 0, 255}, {200, 0, 60, 255},
+                               {90, 40, 140, 255}};
+        const int lastStop = static_cast<int>(std::size(stops)) - 1;
+        std::array<Color, 256> colors{};
+        for (int age = 0; age < 256; age++)
         {
-            Color color = cells[row][column] ? GREEN : Color{55, 55, 55, 255};
-            DrawRectangle(column * cellSize, row * cellSize, cellSize - 1, cellSize - 1, color);
+            // Logarithmic scale, most of the interesting contrast is in the first generations
+            float t = std::log2(1.0f + age) / 8.0f * lastStop;
+            int i = std::min(static_cast<int>(t), lastStop - 1);
+            float f = std::min(t - i, 1.0f);
+            auto mix = [f](unsigned char a, unsigned char b)
+            {
+                return static_cast<unsigned char>(a + (b - a) * f);
+            };
+            colors[age] = Color{mix(stops[i].r, stops[i + 1].r), mix(stops[i].g, stops[i + 1].g),
+                                mix(stops[i].b, stops[i + 1].b), 255};
         }
-    }
-}
-
-void Grid::SetCellValue(int row, int column, int value)
-{
-    if (IsWithinBounds(row, column))
-    {
-        cells[row][column] = value;
-    }
+        return colors;
+    }();
+    return palette;
 }
 
-int Grid::GetCellValue(int row, int column) const
+void DrawGridCell(int row, int column, int cellSize, int value, const uint8_t* age)
 {
-    if (IsWithinBounds(row, column))
+    Color color = value ? GREEN : Color{55, 55, 55, 255};
+    if (value > 1)
     {
-        return cells[row][column];
+        // Dying states of Generations rules fade out
+        unsigned char fade = static_cast<unsigned char>(std::max(60, 230 - 25 * value));
+        color = Color{fade, static_cast<unsigned char>(fade / 2), 0, 255};
     }
-    return 0;
-}
-
-bool Grid::IsWithinBounds(int row, int column) const
-{
-    return row >= 0 && row < rows && column >= 0 && column < columns;
-}
-
-void Grid::FillRandom()
-{
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 3);
-
-    for (int row = 0; row < rows; row++)
+    else if (age && value == 1)
     {
-        for (int column = 0; column < columns; column++)
-        {
-            cells[row][column] = (dis(gen) == 0) ? 1 : 0;
-        }
+        color = AgePalette()[*age];
     }
+    DrawRectangle(column * cellSize, row * cellSize, cellSize - 1, cellSize - 1, color);
 }
 
-void Grid::Clear()
+void AdvanceByteAges(const uint8_t* cells, uint8_t* ages, size_t count)
 {
-    for (auto& row : cells)
+    size_t i = 0;
+#ifdef GRID_AGES_SSE2
+    // 16 cells per iteration: age = saturating(age + 1) & (cell == 1)
+    const __m128i one = _mm_set1_epi8(1);
+    for (; i + 16 <= count; i += 16)
     {
-        std::fill(row.begin(), row.end(), 0);
+        __m128i alive = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i)), one);
+        __m128i* dst = reinterpret_cast<__m128i*>(ages + i);
+        _mm_storeu_si128(dst, _mm_and_si128(_mm_adds_epu8(_mm_loadu_si128(dst), one), alive));
     }
-}
-
-void Grid::ToggleCell(int row, int column)
-{
-    if (IsWithinBounds(row, column))
+#endif
+    for (; i < count; i++)
     {
-        cells[row][column] = !cells[row][column];
+        ages[i] = cells[i] == 1 ? static_cast<uint8_t>(ages[i] + (ages[i] != 255)) : 0;
     }
 }
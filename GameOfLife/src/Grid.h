@@ -1,25 +1,320 @@
 #pragma once
+#include "Arena.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <type_traits>
 #include <vector>
 
-class Grid
+// Cell storage policies for BasicGrid. Each stores a row in RowWords(columns)
+// words and reads or writes one cell of a row without bounds checks. A grid keeps
+// a copy of its policy, so a policy may carry run-time parameters.
+
+// One byte per cell, any state below 256
+struct ByteCells
+{
+    using Word = uint8_t;
+    static constexpr int MaxStates() { return 256; }
+    static size_t RowWords(int columns) { return static_cast<size_t>(columns); }
+    static int Get(const Word* row, int column) { return row[column]; }
+    static void Set(Word* row, int column, int value) { row[column] = static_cast<Word>(value); }
+};
+
+// One bit per cell, laid out like PackedBoard: bit (column % 64) of word (column / 64).
+// The block lookup engine keeps its boards in it.
+struct BitCells
+{
+    using Word = uint64_t;
+    static constexpr int MaxStates() { return 2; }
+    static size_t RowWords(int columns) { return (static_cast<size_t>(columns) + 63) / 64; }
+    static int Get(const Word* row, int column) { return static_cast<int>((row[column / 64] >> (column % 64)) & 1); }
+    static void Set(Word* row, int column, int value)
+    {
+        const Word bit = Word{1} << (column % 64);
+        row[column / 64] = value ? row[column / 64] | bit : row[column / 64] & ~bit;
+    }
+};
+
+// planes bits per cell, the count chosen at run time (e.g. PlanesForStates of a
+// Generations rule). Each group of 64 cells takes planes consecutive words, word p
+// holding bit p of their states, so one cell is read from one cache line.
+struct PlaneCells
+{
+    using Word = uint64_t;
+    int planes = 1;
+
+    int MaxStates() const { return 1 << planes; }
+    size_t RowWords(int columns) const { return static_cast<size_t>(planes) * ((static_cast<size_t>(columns) + 63) / 64); }
+    int Get(const Word* row, int column) const
+    {
+        const Word* group = row + static_cast<size_t>(column / 64) * planes;
+        int value = 0;
+        for (int plane = 0; plane < planes; plane++) value |= static_cast<int>((group[plane] >> (column % 64)) & 1) << plane;
+        return value;
+    }
+    void Set(Word* row, int column, int value) const
+    {
+        Word* group = row + static_cast<size_t>(column / 64) * planes;
+        const Word bit = Word{1} << (column % 64);
+        for (int plane = 0; plane < planes; plane++)
+        {
+            group[plane] = (value >> plane) & 1 ? group[plane] | bit : group[plane] & ~bit;
+        }
+    }
+};
+
+// Draws one cell; shared by every layout
+void DrawGridCell(int row, int column, int cellSize, int value, const uint8_t* age);
+// Byte rows only: age = alive ? saturating(age + 1) : 0, vectorised where possible
+void AdvanceByteAges(const uint8_t* cells, uint8_t* ages, size_t count);
+
+// Cells are stored row-major in one block, GetStride() words per row, in the layout
+// of the Cells policy. With an arena the cell block and the age plane are carved
+// from it; otherwise (or once it is exhausted) the grid owns them.
+// Get/Set/Row skip bounds checks for engines; GetCellValue/SetCellValue check them.
+template <typename Cells>
+class BasicGrid
 {
 public:
-    Grid(int width, int height, int cellSize);
+    using Word = typename Cells::Word;
+
+    BasicGrid(int width, int height, int cellSize, Arena* arena = nullptr, Cells layout = Cells{})
+        : rows(height / cellSize), columns(width / cellSize), cellSize(cellSize), arena(arena), layout(layout)
+    {
+        AllocateCells();
+    }
 
-    void Draw() const;
-    void SetCellValue(int row, int column, int value);
-    int GetCellValue(int row, int column) const;
-    bool IsWithinBounds(int row, int column) const;
-    void FillRandom();
-    void Clear();
-    void ToggleCell(int row, int column);
+    BasicGrid(const BasicGrid&) = delete;
+    BasicGrid& operator=(const BasicGrid&) = delete;
+    BasicGrid(BasicGrid&&) = default;
+    BasicGrid& operator=(BasicGrid&&) = default;
+
+    // Arena bytes one grid of this size needs, age plane included
+    static size_t ArenaBytes(int rows, int columns, const Cells& layout = Cells{})
+    {
+        size_t count = static_cast<size_t>(rows) * columns;
+        return Arena::AlignUp(rows * layout.RowWords(columns) * sizeof(Word)) + Arena::AlignUp(count);
+    }
+    // Clears the board; with an arena its owner must Reset() it first
+    void Resize(int newRows, int newColumns)
+    {
+        bool hadAges = HasAges();
+        EnableAges(false);
+        rows = newRows;
+        columns = newColumns;
+        AllocateCells();
+        EnableAges(hadAges);
+    }
+
+    void Draw() const
+    {
+        for (int row = 0; row < rows; row++)
+        {
+            for (int column = 0; column < columns; column++)
+            {
+                DrawGridCell(row, column, cellSize, Get(row, column), ages ? ages + Index(row, column) : nullptr);
+            }
+        }
+    }
+
+    void SetCellValue(int row, int column, int value)
+    {
+        if (IsWithinBounds(row, column)) Set(row, column, value);
+    }
+    int GetCellValue(int row, int column) const { return IsWithinBounds(row, column) ? Get(row, column) : 0; }
+    bool IsWithinBounds(int row, int column) const { return row >= 0 && row < rows && column >= 0 && column < columns; }
+
+    // Unchecked access for engines; Set resets the age of a cell it changes
+    int Get(int row, int column) const { return layout.Get(Row(row), column); }
+    void Set(int row, int column, int value)
+    {
+        if (ages && Get(row, column) != value) ages[Index(row, column)] = 0;
+        layout.Set(Row(row), column, value);
+    }
+    Word* Row(int row) { return cells + row * stride; }
+    const Word* Row(int row) const { return cells + row * stride; }
+    // Words per row
+    size_t GetStride() const { return stride; }
+    // Every row, stride words each; moves whenever SwapCells does
+    std::span<const Word> Words() const { return {cells, rows * stride}; }
+
+    // A quarter of the cells alive; the same seed gives the same board everywhere
+    void FillRandom(uint32_t seed)
+    {
+        // mt19937 output is fixed by the standard, distributions are not
+        std::mt19937 gen(seed);
+        for (int row = 0; row < rows; row++)
+        {
+            for (int column = 0; column < columns; column++) layout.Set(Row(row), column, (gen() & 3) == 0 ? 1 : 0);
+        }
+        if (ages) std::fill(ages, ages + CellCount(), 0);
+    }
+    void Clear()
+    {
+        std::fill(cells, cells + rows * stride, Word{0});
+        if (ages) std::fill(ages, ages + CellCount(), 0);
+    }
+    void ToggleCell(int row, int column)
+    {
+        if (IsWithinBounds(row, column)) Set(row, column, !Get(row, column));
+    }
+    // Overwrites one row from stride words in this layout, resetting its ages
+    void LoadRow(int row, const Word* words)
+    {
+        std::copy(words, words + stride, Row(row));
+        if (ages) std::fill(ages + Index(row, 0), ages + Index(row, 0) + columns, 0);
+    }
+
+    // Masked write of the up to 64 cells from column span * 64: cell span * 64 + i takes
+    // values[i] where bit i of mask is set. Returns the bits of the cells that changed,
+    // whose ages are reset; wasSet receives the bits of the cells that were non-zero.
+    uint64_t BlendSpan(int row, int span, uint64_t mask, const uint8_t* values, uint64_t& wasSet)
+    {
+        const int first = span * 64;
+        const int count = std::min(64, columns - first);
+        uint64_t changed = 0;
+        wasSet = 0;
+        if constexpr (std::is_same_v<Cells, ByteCells>)
+        {
+            // Branch-free byte blend the compiler can vectorise
+            uint8_t* cells = Row(row) + first;
+            for (int i = 0; i < count; i++)
+            {
+                const uint8_t before = cells[i];
+                const uint8_t select = static_cast<uint8_t>(0 - ((mask >> i) & 1));
+                const uint8_t after = static_cast<uint8_t>((values[i] & select) | (before & ~select));
+                changed |= uint64_t{after != before} << i;
+                wasSet |= uint64_t{before != 0} << i;
+                cells[i] = after;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < count; i++)
+            {
+                const int before = Get(row, first + i);
+                wasSet |= uint64_t{before != 0} << i;
+                if (!((mask >> i) & 1) || before == values[i]) continue;
+                layout.Set(Row(row), first + i, values[i]);
+                changed |= uint64_t{1} << i;
+            }
+        }
+        if (ages)
+        {
+            for (uint64_t bits = changed; bits != 0; bits &= bits - 1) ages[Index(row, first + std::countr_zero(bits))] = 0;
+        }
+        return changed;
+    }
 
     int GetRows() const { return rows; }
     int GetColumns() const { return columns; }
+    const Cells& GetLayout() const { return layout; }
+
+    // Exchanges cell storage with a grid of the same size, O(1)
+    void SwapCells(BasicGrid& other)
+    {
+        std::swap(cells, other.cells);
+        ownedCells.swap(other.ownedCells);
+    }
+
+    // Optional age plane: generations a live cell has survived (saturating at 255),
+    // 0 for dead cells and for cells edited since the last generation.
+    // Draw() colors live cells by age through a palette while it is enabled.
+    void EnableAges(bool enabled)
+    {
+        if (!enabled)
+        {
+            ages = nullptr;
+            std::vector<uint8_t>().swap(ownedAges);
+            return;
+        }
+        if (ages) return;
+
+        if (!arenaAges && arena) arenaAges = arena->AllocateArray<uint8_t>(CellCount());
+        if (arenaAges)
+        {
+            ages = arenaAges;
+            std::fill(ages, ages + CellCount(), 0);
+        }
+        else
+        {
+            ownedAges.assign(CellCount(), 0);
+            ages = ownedAges.data();
+        }
+    }
+    bool HasAges() const { return ages != nullptr; }
+    int GetCellAge(int row, int column) const
+    {
+        return ages && IsWithinBounds(row, column) ? ages[Index(row, column)] : 0;
+    }
+    // Whole plane after a dense step: alive ? age + 1 : 0
+    void AdvanceAges()
+    {
+        if constexpr (std::is_same_v<Cells, ByteCells>)
+        {
+            AdvanceByteAges(cells, ages, CellCount());
+        }
+        else
+        {
+            for (int row = 0; row < rows; row++)
+            {
+                uint8_t* age = ages + Index(row, 0);
+                for (int column = 0; column < columns; column++)
+                {
+                    age[column] = Get(row, column) == 1 ? static_cast<uint8_t>(age[column] + (age[column] != 255)) : 0;
+                }
+            }
+        }
+    }
+    // Only the given live cells (row * columns + column), for engines that know them
+    void AdvanceAges(const std::vector<size_t>& liveCells)
+    {
+        for (size_t cell : liveCells) ages[cell] += ages[cell] != 255;
+    }
 
 private:
+    void AllocateCells()
+    {
+        stride = layout.RowWords(columns);
+        const size_t words = rows * stride;
+        cells = arena ? arena->AllocateArray<Word>(words) : nullptr;
+        if (cells)
+        {
+            std::vector<Word>().swap(ownedCells);
+            std::fill(cells, cells + words, Word{0});
+        }
+        else
+        {
+            ownedCells.assign(words, Word{0});
+            cells = ownedCells.data();
+        }
+        // The age plane is carved on demand
+        arenaAges = nullptr;
+    }
+    size_t CellCount() const { return static_cast<size_t>(rows) * columns; }
+    size_t Index(int row, int column) const { return static_cast<size_t>(row) * columns + column; }
+
     int rows;
     int columns;
     int cellSize;
-    std::vector<std::vector<int>> cells;
+    size_t stride = 0;
+    Arena* arena = nullptr;
+    [[no_unique_address]] Cells layout;
+
+    Word* cells = nullptr;
+    // nullptr while ages are disabled
+    uint8_t* ages = nullptr;
+    // Arena age plane, kept while disabled so toggling does not use up the arena
+    uint8_t* arenaAges = nullptr;
+    std::vector<Word> ownedCells;
+    std::vector<uint8_t> ownedAges;
 };
+
+// Layout of the board the simulation and its engines share. Bytes hold every
+// Generations and Larger than Life state and keep the dense step and drawing cheap.
+// The block lookup engine steps a BasicGrid<BitCells>. The bit-sliced engine keeps
+// a PackedBoard rather than a BasicGrid<PlaneCells>: its plane-major layout is the
+// packed view snapshots, the change stream and the C API share without copying.
+using Grid = BasicGrid<ByteCells>;
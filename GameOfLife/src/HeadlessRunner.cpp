@@ -0,0 +1,636 @@
+#include "HeadlessRunner.h"
+#include "AsyncIo.h"
+#include "MetricsServer.h"
+#include "PagedBoard.h"
+#include "RuleExplorer.h"
+#include "Simulation.h"
+#ifdef GOL_SLAB_CLUSTER
+#include "SlabCluster.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct HeadlessOptions
+    {
+        int rows = 120;
+        int columns = 192;
+        long long steps = 100;
+        int workers = 0;
+        int threads = 0;
+        std::string engine = "auto";
+        std::string transport = "shm";
+        std::string pin = "none";
+        bool interleave = false;
+        std::string loadPath;
+        std::string savePath;
+        std::string streamPath;
+        bool streamFifo = false;
+        std::string recordPath;
+        std::string recordFormat = "png";
+        int recordEvery = 1;
+        int recordThreads = 0;
+        std::string replayPath;
+        std::string findPattern;
+        std::string exploreRules;
+        uint32_t seed = 1;
+        bool seedGiven = false;
+        MetricsOptions metrics;
+        long long checkpointEvery = 0;
+        std::string pagedPath;
+        bool pagedResume = false;
+    };
+
+    bool ParseOptions(int argc, char** argv, HeadlessOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+            const char* v = nullptr;
+            if (arg == "--headless") continue;
+            if (arg == "--numa-interleave")
+            {
+                options.interleave = true;
+                continue;
+            }
+            if (arg == "--stream-fifo")
+            {
+                options.streamFifo = true;
+                continue;
+            }
+            if (arg == "--paged-resume")
+            {
+                options.pagedResume = true;
+                continue;
+            }
+            if (arg == "--rows" && (v = value())) options.rows = std::atoi(v);
+            else if (arg == "--cols" && (v = value())) options.columns = std::atoi(v);
+            else if (arg == "--steps" && (v = value())) options.steps = std::atoll(v);
+            else if (arg == "--workers" && (v = value())) options.workers = std::atoi(v);
+            else if (arg == "--threads" && (v = value())) options.threads = std::atoi(v);
+            else if (arg == "--engine" && (v = value())) options.engine = v;
+            else if (arg == "--transport" && (v = value())) options.transport = v;
+            else if (arg == "--pin" && (v = value())) options.pin = v;
+            else if (arg == "--load" && (v = value())) options.loadPath = v;
+            else if (arg == "--save" && (v = value())) options.savePath = v;
+            else if (arg == "--stream" && (v = value())) options.streamPath = v;
+            else if (arg == "--replay" && (v = value())) options.replayPath = v;
+            else if (arg == "--find" && (v = value())) options.findPattern = v;
+            else if (arg == "--explore-rules" && (v = value())) options.exploreRules = v;
+            else if (arg == "--seed" && (v = value()))
+            {
+                options.seed = static_cast<uint32_t>(std::strtoul(v, nullptr, 10));
+                options.seedGiven = true;
+            }
+            else if (arg == "--record" && (v = value())) options.recordPath = v;
+            else if (arg == "--record-format" && (v = value())) options.recordFormat = v;
+            else if (arg == "--record-every" && (v = value())) options.recordEvery = std::atoi(v);
+            else if (arg == "--record-threads" && (v = value())) options.recordThreads = std::atoi(v);
+            else if (arg == "--metrics-port" && (v = value())) options.metrics.port = std::atoi(v);
+            else if (arg == "--metrics-socket" && (v = value())) options.metrics.socketPath = v;
+            else if (arg == "--metrics-jsonl" && (v = value())) options.metrics.jsonlPath = v;
+            else if (arg == "--metrics-interval" && (v = value())) options.metrics.intervalSeconds = std::atof(v);
+            else if (arg == "--checkpoint-every" && (v = value())) options.checkpointEvery = std::atoll(v);
+            else if (arg == "--paged" && (v = value())) options.pagedPath = v;
+            else
+            {
+                std::fprintf(stderr, "Unknown or incomplete option: %s\n", arg.c_str());
+                return false;
+            }
+        }
+        if (options.pin != "none" && options.pin != "node" && options.pin != "core")
+        {
+            std::fprintf(stderr, "--pin expects none, node or core\n");
+            return false;
+        }
+        if (options.recordFormat != "png" && options.recordFormat != "ppm" && options.recordFormat != "y4m")
+        {
+            std::fprintf(stderr, "--record-format expects png, ppm or y4m\n");
+            return false;
+        }
+        if (options.pagedResume && options.pagedPath.empty())
+        {
+            std::fprintf(stderr, "--paged-resume needs --paged\n");
+            return false;
+        }
+        if (options.checkpointEvery > 0 && options.savePath.empty() && options.pagedPath.empty())
+        {
+            std::fprintf(stderr, "--checkpoint-every needs --save\n");
+            return false;
+        }
+        const bool metricsWanted =
+            options.metrics.port >= 0 || !options.metrics.socketPath.empty() || !options.metrics.jsonlPath.empty();
+        if (options.workers > 0 && (metricsWanted || options.checkpointEvery > 0 || !options.streamPath.empty() ||
+                                    !options.recordPath.empty() || !options.findPattern.empty()))
+        {
+            // Slab workers only step, load and save
+            std::fprintf(stderr, "--metrics-*, --checkpoint-every, --stream, --record and --find "
+                                 "do not work with --workers\n");
+            return false;
+        }
+        if (options.metrics.intervalSeconds <= 0.0)
+        {
+            std::fprintf(stderr, "--metrics-interval expects a positive number of seconds\n");
+            return false;
+        }
+        Pattern pattern;
+        std::string patternError;
+        if (!options.findPattern.empty() && !Pattern::Parse(options.findPattern, pattern, &patternError))
+        {
+            std::fprintf(stderr, "--find: %s\n", patternError.c_str());
+            return false;
+        }
+        StepEngine engine;
+        if (!Simulation::ParseStepEngine(options.engine, engine))
+        {
+            std::fprintf(stderr, "--engine expects auto, dense, sparse, bitsliced, block or tiled\n");
+            return false;
+        }
+        return options.rows > 0 && options.columns > 0;
+    }
+
+    // Golly macrocell by extension, Life 1.06 otherwise
+    bool IsMacrocellPath(const std::string& path)
+    {
+        return path.size() > 3 && path.compare(path.size() - 3, 3, ".mc") == 0;
+    }
+
+    void PrintWarnings(const std::vector<std::string>& warnings)
+    {
+        for (const auto& w : warnings)
+        {
+            std::fprintf(stderr, "warning: %s\n", w.c_str());
+        }
+    }
+
+    // Longest run of generations between two metric updates
+    constexpr long long kMetricsChunk = 16;
+
+    void PublishMetrics(const Simulation& simulation, MetricsServer& metrics)
+    {
+        long long activeTiles = 0;
+        if (simulation.GetActiveEngine() == StepEngine::Tiled)
+        {
+            const TileSchedulerStats& tiles = simulation.GetTileStats();
+            activeTiles = tiles.generations > 0 ? tiles.tasks / tiles.generations : 0;
+        }
+        else if (simulation.IsTrackingStats())
+        {
+            const std::vector<uint32_t>& tiles = simulation.Stats().tilePopulation;
+            activeTiles = std::count_if(tiles.begin(), tiles.end(), [](uint32_t count) { return count != 0; });
+        }
+        metrics.Publish(simulation.GetGeneration(), simulation.GetPopulation(), activeTiles);
+    }
+
+    // Steps in chunks so the metrics stay fresh and checkpoints land on their generation.
+    // A checkpoint is written from a snapshot by the I/O thread while stepping goes on;
+    // one that comes due while the previous is still writing is skipped, the next takes
+    // a newer snapshot anyway.
+    bool AdvanceWithProgress(Simulation& simulation, const HeadlessOptions& options, MetricsServer& metrics)
+    {
+        AsyncIo io;
+        bool ok = true;
+        auto collect = [&]()
+        {
+            IoJobResult result;
+            while (io.Poll(result))
+            {
+                if (result.ok)
+                {
+                    metrics.MarkCheckpoint();
+                    continue;
+                }
+                std::fprintf(stderr, "Checkpoint to %s failed\n", options.savePath.c_str());
+                PrintWarnings(result.warnings);
+                ok = false;
+            }
+        };
+
+        long long done = 0;
+        while (done < options.steps && ok)
+        {
+            long long chunk = std::min(options.steps - done, kMetricsChunk);
+            if (options.checkpointEvery > 0)
+            {
+                chunk = std::min(chunk, options.checkpointEvery - done % options.checkpointEvery);
+            }
+            simulation.Advance(chunk);
+            done += chunk;
+            PublishMetrics(simulation, metrics);
+            if (options.checkpointEvery > 0 && done % options.checkpointEvery == 0 && !io.IsBusy())
+            {
+                if (IsMacrocellPath(options.savePath)) io.SaveMacrocell(options.savePath, simulation.TakeSnapshot());
+                else io.SaveLife106(options.savePath, simulation.TakeSnapshot());
+            }
+            collect();
+        }
+        while (io.IsBusy())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        collect();
+        return ok;
+    }
+
+    int RunSingle(const HeadlessOptions& options)
+    {
+        Simulation simulation(options.columns, options.rows, 1);
+        StepEngine engine = StepEngine::Auto;
+        Simulation::ParseStepEngine(options.engine, engine);
+        simulation.SetStepEngine(engine);
+        simulation.ConfigureTiles(options.threads, 64);
+        if (!options.loadPath.empty())
+        {
+            std::vector<std::string> warnings;
+            bool ok = IsMacrocellPath(options.loadPath) ? simulation.LoadFromMacrocell(options.loadPath, warnings)
+                                                        : simulation.LoadFromLife106(options.loadPath, warnings);
+            PrintWarnings(warnings);
+            if (!ok) return 1;
+        }
+        else if (options.seedGiven)
+        {
+            simulation.CreateRandomState(options.seed);
+        }
+        else
+        {
+            simulation.CreateRandomState();
+        }
+
+        if (!options.streamPath.empty())
+        {
+            std::string err;
+            StreamTransport transport = options.streamFifo ? StreamTransport::Fifo : StreamTransport::UnixSocket;
+            if (!simulation.StartChangeStream(options.streamPath, transport, &err))
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+        }
+
+        if (!options.recordPath.empty())
+        {
+            RecordOptions record;
+            record.path = options.recordPath;
+            record.format = options.recordFormat == "ppm" ? RecordFormat::Ppm
+                : options.recordFormat == "y4m"          ? RecordFormat::Y4m
+                                                          : RecordFormat::Png;
+            record.every = options.recordEvery;
+            record.threads = options.recordThreads;
+            std::string err;
+            if (!simulation.StartRecording(record, &err))
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+        }
+
+        MetricsServer metrics;
+        if (options.metrics.port >= 0 || !options.metrics.socketPath.empty() || !options.metrics.jsonlPath.empty())
+        {
+            // The tiled engine counts its busy tiles itself, the others get them from the stats
+            if (engine != StepEngine::Tiled) simulation.EnableStats(true);
+            PublishMetrics(simulation, metrics);
+            std::string err;
+            if (!metrics.Start(options.metrics, &err))
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+            if (metrics.GetPort() > 0) std::printf("metrics on http://127.0.0.1:%d/metrics\n", metrics.GetPort());
+            std::fflush(stdout);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (metrics.IsRunning() || options.checkpointEvery > 0)
+        {
+            if (!AdvanceWithProgress(simulation, options, metrics)) return 1;
+        }
+        else
+        {
+            simulation.Advance(options.steps);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("generations: %lld, %.1f gens/sec\n", options.steps, options.steps / std::max(seconds, 1e-9));
+        if (simulation.GetRecorder().IsOpen())
+        {
+            std::string err;
+            bool ok = simulation.StopRecording(&err);
+            RecordStats stats = simulation.GetRecorder().GetStats();
+            std::printf("  recording: %lld frames written, %lld failed, %.1f%% of run time spent submitting, "
+                        "%.2f s encoding\n", stats.framesWritten, stats.framesFailed,
+                        stats.submitSeconds / std::max(seconds, 1e-9) * 100.0, stats.encodeSeconds);
+            if (!ok)
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+        }
+        if (simulation.GetActiveEngine() == StepEngine::Tiled)
+        {
+            const TileSchedulerStats& stats = simulation.GetTileStats();
+            std::printf("  tiles: %d threads, %.0f%% utilization, %lld tasks, %lld skipped, %lld steals\n",
+                        stats.threads, stats.utilization * 100.0, stats.tasks, stats.skipped, stats.steals);
+        }
+        if (simulation.GetChangeStream().IsOpen())
+        {
+            const ChangeStreamWriter& stream = simulation.GetChangeStream();
+            std::printf("  stream: %lld keyframes, %lld deltas, %lld frames skipped for slow readers\n",
+                        stream.GetKeyframesSent(), stream.GetDeltasSent(), stream.GetFramesSkipped());
+        }
+
+        if (!options.findPattern.empty())
+        {
+            // Counts isolated copies in any orientation, e.g. --find ".O./..O/OOO" for gliders
+            Pattern pattern;
+            Pattern::Parse(options.findPattern, pattern);
+            auto findStart = std::chrono::steady_clock::now();
+            std::vector<PatternMatch> matches = simulation.FindPattern(pattern.WithDeadBorder(), kAllOrientations,
+                                                                        options.threads);
+            double findSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - findStart).count();
+            std::printf("  pattern: %zu isolated matches in %.2f ms\n", matches.size(), findSeconds * 1000.0);
+        }
+
+        if (!options.savePath.empty())
+        {
+            std::string err;
+            bool ok = IsMacrocellPath(options.savePath) ? simulation.SaveToMacrocell(options.savePath, &err)
+                                                        : simulation.SaveToLife106(options.savePath, &err);
+            if (!ok)
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+            metrics.MarkCheckpoint();
+        }
+        return 0;
+    }
+
+    // Board file too large for memory: --load (or a --seed soup) fills a window of at most
+    // 1024 x 1024 cells in its centre, checkpoints go to the board file itself
+    int RunPaged(const HeadlessOptions& options)
+    {
+        PagedBoard board;
+        std::string err;
+        if (options.pagedResume)
+        {
+            if (!board.Resume(options.pagedPath, &err))
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+        }
+        else
+        {
+            if (!board.Create(options.pagedPath, options.rows, options.columns, &err))
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+            const int windowRows = std::min(options.rows, 1024);
+            const int windowColumns = std::min(options.columns, 1024);
+            Simulation window(windowColumns, windowRows, 1);
+            if (!options.loadPath.empty())
+            {
+                std::vector<std::string> warnings;
+                bool ok = IsMacrocellPath(options.loadPath) ? window.LoadFromMacrocell(options.loadPath, warnings)
+                                                            : window.LoadFromLife106(options.loadPath, warnings);
+                PrintWarnings(warnings);
+                if (!ok) return 1;
+            }
+            else
+            {
+                window.CreateRandomState(options.seed);
+            }
+            if (window.GetStates() != 2 || window.GetRangeRule() ||
+                !board.SetRule(window.GetBirthRule(), window.GetSurvivalRule(), &err))
+            {
+                std::fprintf(stderr, "%s\n", err.empty() ? "Paged boards run two-state Bx/Sy rules only" : err.c_str());
+                return 1;
+            }
+            board.Paste(window.GetPackedCells(), (options.rows - windowRows) / 2, (options.columns - windowColumns) / 2);
+        }
+
+        MetricsServer metrics;
+        if (options.metrics.port >= 0 || !options.metrics.socketPath.empty() || !options.metrics.jsonlPath.empty())
+        {
+            metrics.Publish(board.GetGeneration(), board.GetPopulation(), static_cast<long long>(board.GetLiveTiles()));
+            if (!metrics.Start(options.metrics, &err))
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (long long done = 0; done < options.steps;)
+        {
+            long long chunk = std::min(options.steps - done, kMetricsChunk);
+            if (options.checkpointEvery > 0)
+            {
+                chunk = std::min(chunk, options.checkpointEvery - done % options.checkpointEvery);
+            }
+            board.Advance(chunk);
+            done += chunk;
+            metrics.Publish(board.GetGeneration(), board.GetPopulation(), static_cast<long long>(board.GetLiveTiles()));
+            if (options.checkpointEvery > 0 && done % options.checkpointEvery == 0)
+            {
+                if (!board.Checkpoint(&err))
+                {
+                    std::fprintf(stderr, "%s\n", err.c_str());
+                    return 1;
+                }
+                metrics.MarkCheckpoint();
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!board.Checkpoint(&err))
+        {
+            std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+        std::printf("generations: %lld, %.1f gens/sec\n", options.steps, options.steps / std::max(seconds, 1e-9));
+        std::printf("  paged: generation %lld, population %lld, %zu live tiles of %lldx%lld cells\n",
+                    board.GetGeneration(), board.GetPopulation(), board.GetLiveTiles(),
+                    static_cast<long long>(PagedBoard::kTileRows), static_cast<long long>(PagedBoard::kTileColumns));
+        return 0;
+    }
+
+    // Rebuilds a GUI session from its log; --steps is ignored, the log decides how far to go
+    int RunReplay(const HeadlessOptions& options)
+    {
+        Simulation simulation(options.columns, options.rows, 1);
+        StepEngine engine = StepEngine::Auto;
+        Simulation::ParseStepEngine(options.engine, engine);
+        simulation.SetStepEngine(engine);
+        simulation.ConfigureTiles(options.threads, 64);
+
+        std::string err;
+        auto start = std::chrono::steady_clock::now();
+        bool ok = simulation.ReplaySessionLog(options.replayPath, &err);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!ok)
+        {
+            std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+        std::printf("replayed to generation %lld in %.3f s, board %dx%d, population %lld\n",
+                    simulation.GetGeneration(), seconds, simulation.GetRows(), simulation.GetColumns(),
+                    simulation.GetPopulation());
+
+        if (options.savePath.empty()) return 0;
+        ok = IsMacrocellPath(options.savePath) ? simulation.SaveToMacrocell(options.savePath, &err)
+                                               : simulation.SaveToLife106(options.savePath, &err);
+        if (!ok)
+        {
+            std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+    // One --seed soup under every rule of a comma separated list, --steps generations at most
+    int RunRuleExploration(const HeadlessOptions& options)
+    {
+        std::vector<std::string> rules;
+        size_t start = 0;
+        while (start <= options.exploreRules.size())
+        {
+            size_t comma = options.exploreRules.find(',', start);
+            if (comma == std::string::npos) comma = options.exploreRules.size();
+            if (comma > start) rules.push_back(options.exploreRules.substr(start, comma - start));
+            start = comma + 1;
+        }
+
+        RuleExploreOptions explore;
+        explore.rows = options.rows;
+        explore.columns = options.columns;
+        explore.seed = options.seed;
+        explore.maxGenerations = options.steps;
+        RuleExploreResult result;
+        std::string err;
+        auto begin = std::chrono::steady_clock::now();
+        bool ok = ExploreRules(rules, explore, result, &err);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if (!ok)
+        {
+            std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+
+        for (const RuleExploration& rule : result.rules)
+        {
+            if (rule.period > 0)
+            {
+                std::printf("%-16s population %lld, stable from generation %lld, period %lld\n", rule.rule.c_str(),
+                            rule.finalPopulation, rule.stableGeneration, rule.period);
+            }
+            else
+            {
+                std::printf("%-16s population %lld, unsettled after %lld generations\n", rule.rule.c_str(),
+                            rule.finalPopulation, options.steps);
+            }
+        }
+        std::printf("%zu rules in %.3f s: %lld neighbour count passes for %lld rule steps\n", result.rules.size(),
+                    seconds, result.countPasses, result.ruleSteps);
+        return 0;
+    }
+
+#ifdef GOL_SLAB_CLUSTER
+    int RunSlabs(const HeadlessOptions& options)
+    {
+        HaloTransport transport = options.transport == "socket" ? HaloTransport::UnixSocket
+                                                                : HaloTransport::SharedMemory;
+        SlabCluster cluster(options.rows, options.columns, options.workers, transport);
+        SlabPlacement placement;
+        placement.pinning = options.pin == "core" ? SlabPinning::Core
+            : options.pin == "node"               ? SlabPinning::Node
+                                                  : SlabPinning::None;
+        placement.interleave = options.interleave;
+        cluster.SetPlacement(placement);
+        std::string err;
+
+        if (!options.loadPath.empty())
+        {
+            std::vector<std::string> warnings;
+            bool ok = cluster.LoadFromLife106(options.loadPath, warnings);
+            PrintWarnings(warnings);
+            if (!ok) return 1;
+        }
+        else
+        {
+            uint32_t seed = options.seedGiven ? options.seed : std::random_device{}();
+            if (!cluster.LoadRandom(seed, &err))
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (long long done = 0; done < options.steps;)
+        {
+            int chunk = static_cast<int>(std::min<long long>(options.steps - done, INT_MAX));
+            if (!cluster.Step(chunk, &err))
+            {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+            done += chunk;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("generations: %lld, %.1f gens/sec, workers: %d, population: %lld\n", options.steps,
+                    options.steps / std::max(seconds, 1e-9), cluster.GetWorkerCount(), cluster.GetPopulation());
+        for (const NodeThroughput& node : cluster.GetNodeThroughput())
+        {
+            std::printf("  node %d: %d workers, %lld cells, %.3g cell updates/sec\n", node.node, node.workers,
+                        node.cells, node.cellsPerSecond);
+        }
+
+        if (!options.savePath.empty() && !cluster.SaveToLife106(options.savePath, &err))
+        {
+            std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+        return 0;
+    }
+#endif
+}
+
+bool IsHeadlessInvocation(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0) return true;
+    }
+    return false;
+}
+
+int RunHeadless(int argc, char** argv)
+{
+    HeadlessOptions options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!options.replayPath.empty()) return RunReplay(options);
+    if (!options.exploreRules.empty()) return RunRuleExploration(options);
+    if (!options.pagedPath.empty()) return RunPaged(options);
+
+    if (options.workers > 0)
+    {
+#ifdef GOL_SLAB_CLUSTER
+        return RunSlabs(options);
+#else
+        std::fprintf(stderr, "--workers is not supported on this platform\n");
+        return 2;
+#endif
+    }
+    return RunSingle(options);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Command line mode without a window:
+//   GameOfLife --headless [--rows N] [--cols N] [--load in.lif | --seed N] [--steps N] [--save out.lif]
+//              [--engine auto|dense|sparse|bitsliced|block|tiled] [--threads N]
+//              [--metrics-port N] [--metrics-socket path] [--metrics-jsonl out.jsonl] [--metrics-interval sec]
+//              [--checkpoint-every N] [--stream path [--stream-fifo]]
+//              [--record prefix [--record-format png|ppm|y4m] [--record-every N] [--record-threads N]]
+//              [--find pattern]
+//   GameOfLife --headless --workers N [--transport shm|socket] [--pin none|node|core] [--numa-interleave]
+//              [--rows N] [--cols N] [--load in.lif | --seed N] [--steps N] [--save out.lif]
+//   GameOfLife --headless --paged board.bin [--paged-resume] [--rows N] [--cols N] [--load in.lif | --seed N]
+//              [--steps N] [--checkpoint-every N]
+//   GameOfLife --headless --replay session.golr [--engine E] [--threads N] [--save out.lif]
+//   GameOfLife --headless --explore-rules B3/S23,B36/S23,... [--seed N] [--steps N]
+// Without --load the board starts as a random soup, the same one for the same --seed.
+// --engine picks the stepping engine, --threads the tiled engine's thread count (0: all).
+// With --workers the board is split into slabs stepped by separate processes; --pin binds
+// them to the cores or NUMA nodes and --numa-interleave spreads their pages over all nodes.
+// --metrics-* serve Prometheus metrics on 127.0.0.1 (port 0 picks one) or a Unix socket
+// and append them to a JSONL file; --checkpoint-every also writes --save every N generations.
+// --stream publishes every generation to viewers on a Unix socket (or a FIFO), see ChangeStream.
+// --record writes every --record-every-th generation as prefix000042.png/.ppm images or,
+// for y4m, into the one video file prefix names; see FrameRecorder.
+// --find counts isolated copies of a pattern ("." dead, "O" live, "/" between rows), e.g.
+// ".O./..O/OOO" for gliders, in any orientation after the last step.
+// --paged keeps the board in a sparse memory-mapped file, see PagedBoard; it is
+// checkpointed at the end and every --checkpoint-every generations, --paged-resume continues it.
+// --replay rebuilds a GUI session from its log; --explore-rules runs one soup under each rule.
+// --load and --save take Golly macrocell files when the name ends in .mc.
+// Returns the process exit code.
+int RunHeadless(int argc, char** argv);
+
+bool IsHeadlessInvocation(int argc, char** argv);
@@ -0,0 +1,206 @@
+#include "History.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    void PutVarint(std::vector<uint8_t>& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    bool GetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7)
+        {
+            uint8_t byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+}
+
+void History::Enable(size_t budgetMB, int interval)
+{
+    budgetBytes = std::max<size_t>(budgetMB, 1) * 1024 * 1024;
+    keyframeInterval = std::max(interval, 1);
+    Evict();
+}
+
+void History::Disable()
+{
+    Reset();
+    budgetBytes = 0;
+}
+
+void History::Reset()
+{
+    entries.clear();
+    usedBytes = 0;
+    last = PackedBoard();
+    lastGeneration = -1;
+}
+
+// Stream of (zero word run, literal word count, literal words) records
+void History::Encode(const std::vector<uint64_t>& words, std::vector<uint8_t>& out)
+{
+    out.clear();
+    EncodeAppend(words, out);
+}
+
+void History::EncodeAppend(const std::vector<uint64_t>& words, std::vector<uint8_t>& out)
+{
+    size_t i = 0;
+    size_t n = words.size();
+    while (i < n)
+    {
+        size_t zeros = 0;
+        while (i + zeros < n && words[i + zeros] == 0) ++zeros;
+        i += zeros;
+        size_t literals = 0;
+        while (i + literals < n && words[i + literals] != 0) ++literals;
+
+        PutVarint(out, zeros);
+        PutVarint(out, literals);
+        size_t at = out.size();
+        out.resize(at + literals * sizeof(uint64_t));
+        std::memcpy(out.data() + at, words.data() + i, literals * sizeof(uint64_t));
+        i += literals;
+    }
+}
+
+bool History::DecodeXor(const std::vector<uint8_t>& data, std::vector<uint64_t>& words)
+{
+    return DecodeXor(data.data(), data.size(), words);
+}
+
+bool History::DecodeXor(const uint8_t* data, size_t size, std::vector<uint64_t>& words)
+{
+    const uint8_t* p = data;
+    const uint8_t* end = p + size;
+    size_t i = 0;
+    while (p < end)
+    {
+        uint64_t zeros;
+        uint64_t literals;
+        if (!GetVarint(p, end, zeros) || !GetVarint(p, end, literals)) return false;
+        if (zeros > words.size() - i || literals > words.size() - i - zeros) return false;
+        if (literals > static_cast<size_t>(end - p) / sizeof(uint64_t)) return false;
+        i += zeros;
+        for (size_t k = 0; k < literals; ++k, ++i, p += sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            words[i] ^= word;
+        }
+    }
+    return true;
+}
+
+size_t History::EntryBytes(const Entry& entry)
+{
+    return sizeof(Entry) + entry.data.capacity();
+}
+
+void History::Record(long long generation, const PackedBoard& board)
+{
+    if (!IsEnabled()) return;
+
+    DiscardFrom(generation);
+
+    // Restore() relies on consecutive generations of one board size
+    bool sameShape = last.GetRows() == board.GetRows() && last.GetColumns() == board.GetColumns() &&
+        last.GetPlanes() == board.GetPlanes();
+    if (!sameShape || (!entries.empty() && entries.back().generation != generation - 1))
+    {
+        Reset();
+    }
+    bool continues = !entries.empty() && lastGeneration == generation - 1;
+
+    Entry entry{generation, !continues || generation - lastKeyframe >= keyframeInterval, {}};
+    if (entry.keyframe)
+    {
+        Encode(board.Words(), entry.data);
+        lastKeyframe = generation;
+    }
+    else
+    {
+        scratch.resize(board.Words().size());
+        for (size_t i = 0; i < scratch.size(); ++i)
+        {
+            scratch[i] = board.Words()[i] ^ last.Words()[i];
+        }
+        Encode(scratch, entry.data);
+    }
+    entry.data.shrink_to_fit();
+
+    usedBytes += EntryBytes(entry);
+    entries.push_back(std::move(entry));
+    last = board;
+    lastGeneration = generation;
+    Evict();
+}
+
+void History::Evict()
+{
+    size_t lastBytes = last.Words().size() * sizeof(uint64_t);
+    while (entries.size() > 1 && usedBytes + lastBytes > budgetBytes)
+    {
+        usedBytes -= EntryBytes(entries.front());
+        entries.pop_front();
+        // Deltas without their keyframe can never be rebuilt
+        while (!entries.empty() && !entries.front().keyframe)
+        {
+            usedBytes -= EntryBytes(entries.front());
+            entries.pop_front();
+        }
+    }
+}
+
+void History::DiscardFrom(long long generation)
+{
+    while (!entries.empty() && entries.back().generation >= generation)
+    {
+        usedBytes -= EntryBytes(entries.back());
+        entries.pop_back();
+    }
+}
+
+bool History::Contains(long long generation) const
+{
+    return !entries.empty() && generation >= entries.front().generation && generation <= entries.back().generation;
+}
+
+long long History::GetOldestGeneration() const
+{
+    return entries.empty() ? -1 : entries.front().generation;
+}
+
+long long History::GetNewestGeneration() const
+{
+    return entries.empty() ? -1 : entries.back().generation;
+}
+
+bool History::Restore(long long generation, PackedBoard& out) const
+{
+    if (!Contains(generation)) return false;
+
+    // Entries are consecutive, so the index follows from the generation
+    size_t target = static_cast<size_t>(generation - entries.front().generation);
+    size_t start = target;
+    while (!entries[start].keyframe) --start;
+
+    out = PackedBoard(last.GetRows(), last.GetColumns(), last.GetPlanes());
+    for (size_t i = start; i <= target; ++i)
+    {
+        DecodeXor(entries[i].data, out.Words());
+    }
+    return true;
+}
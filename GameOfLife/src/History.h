@@ -0,0 +1,64 @@
+#pragma once
+#include "PackedBoard.h"
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// Ring of past generations under a fixed memory budget.
+// Every keyframeInterval generations a full board is stored, in between only the XOR
+// of consecutive generations. Both are compressed with a zero-run word codec, since
+// deltas (and most boards) are dominated by empty words. Oldest entries are evicted first.
+class History
+{
+public:
+    void Enable(size_t budgetMB, int keyframeInterval = 64);
+    void Disable();
+    bool IsEnabled() const { return budgetBytes != 0; }
+    size_t GetBudgetMB() const { return budgetBytes / (1024 * 1024); }
+    int GetKeyframeInterval() const { return keyframeInterval; }
+
+    // Stores the board for the given generation, dropping any entries at or after it
+    void Record(long long generation, const PackedBoard& board);
+    // Rebuilds the board of a generation still held in the buffer
+    bool Restore(long long generation, PackedBoard& out) const;
+    void DiscardFrom(long long generation);
+    void Reset();
+
+    bool Contains(long long generation) const;
+    long long GetOldestGeneration() const;
+    long long GetNewestGeneration() const;
+    size_t GetUsedBytes() const { return usedBytes; }
+    size_t GetEntryCount() const { return entries.size(); }
+
+    // Zero-run word codec, also used for the change stream.
+    // DecodeXor XORs the decoded words into words and rejects data that does not fit.
+    static void Encode(const std::vector<uint64_t>& words, std::vector<uint8_t>& out);
+    // Same, appended after whatever out already holds
+    static void EncodeAppend(const std::vector<uint64_t>& words, std::vector<uint8_t>& out);
+    static bool DecodeXor(const std::vector<uint8_t>& data, std::vector<uint64_t>& words);
+    static bool DecodeXor(const uint8_t* data, size_t size, std::vector<uint64_t>& words);
+
+private:
+    struct Entry
+    {
+        long long generation;
+        bool keyframe;
+        std::vector<uint8_t> data;
+    };
+
+    static size_t EntryBytes(const Entry& entry);
+
+    void Evict();
+
+    size_t budgetBytes = 0;
+    size_t usedBytes = 0;
+    int keyframeInterval = 64;
+    long long lastKeyframe = 0;
+
+    std::deque<Entry> entries;
+    // Uncompressed copy of the newest entry, base for the next delta
+    PackedBoard last;
+    long long lastGeneration = -1;
+    std::vector<uint64_t> scratch;
+};
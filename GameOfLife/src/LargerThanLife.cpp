@@ -0,0 +1,303 @@
+#include "LargerThanLife.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace
+{
+    bool ParseNumber(const std::string& text, int& value)
+    {
+        if (text.empty() || text.size() > 6) return false;
+        for (char c : text)
+        {
+            if (c < '0' || c > '9') return false;
+        }
+        value = std::stoi(text);
+        return true;
+    }
+
+    // "a..b" or a single "a"
+    bool ParseInterval(const std::string& text, int& low, int& high)
+    {
+        size_t dots = text.find("..");
+        if (dots == std::string::npos)
+        {
+            if (!ParseNumber(text, low)) return false;
+            high = low;
+            return true;
+        }
+        return ParseNumber(text.substr(0, dots), low) && ParseNumber(text.substr(dots + 2), high) && low <= high;
+    }
+}
+
+bool IsLargerThanLifeRule(const std::string& text)
+{
+    size_t i = 0;
+    while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+    return i + 1 < text.size() && (text[i] == 'R' || text[i] == 'r') &&
+        std::isdigit(static_cast<unsigned char>(text[i + 1]));
+}
+
+bool ParseLargerThanLifeRule(const std::string& text, LargerThanLifeRule& out, std::string* error)
+{
+    std::string rule;
+    for (char c : text)
+    {
+        if (!std::isspace(static_cast<unsigned char>(c))) rule += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    LargerThanLifeRule parsed;
+    bool hasRange = false;
+    bool hasSurvival = false;
+    bool hasBirth = false;
+
+    std::istringstream parts(rule);
+    std::string part;
+    while (std::getline(parts, part, ','))
+    {
+        if (part.empty()) continue;
+        char key = part[0];
+        std::string value = part.substr(1);
+        bool ok = true;
+        switch (key)
+        {
+        case 'R':
+            ok = ParseNumber(value, parsed.range) && parsed.range >= 1 && parsed.range <= 10;
+            hasRange = true;
+            break;
+        case 'C':
+            ok = ParseNumber(value, parsed.states) && parsed.states <= 256;
+            parsed.states = std::max(parsed.states, 2);
+            break;
+        case 'M':
+            ok = value == "0" || value == "1";
+            parsed.countMiddle = value == "1";
+            break;
+        case 'S':
+            ok = ParseInterval(value, parsed.survivalMin, parsed.survivalMax);
+            hasSurvival = true;
+            break;
+        case 'B':
+            ok = ParseInterval(value, parsed.birthMin, parsed.birthMax);
+            hasBirth = true;
+            break;
+        case 'N':
+            ok = value == "M" || value == "N";
+            parsed.vonNeumann = value == "N";
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok)
+        {
+            if (error) *error = "invalid part '" + part + "'";
+            return false;
+        }
+    }
+
+    if (!hasRange || !hasSurvival || !hasBirth)
+    {
+        if (error) *error = "expected R, S and B parts";
+        return false;
+    }
+
+    int side = 2 * parsed.range + 1;
+    int cells = parsed.vonNeumann ? 2 * parsed.range * (parsed.range + 1) + 1 : side * side;
+    int maxCount = parsed.countMiddle ? cells : cells - 1;
+    if (parsed.survivalMax > maxCount || parsed.birthMax > maxCount)
+    {
+        if (error) *error = "interval exceeds neighbourhood size " + std::to_string(maxCount);
+        return false;
+    }
+
+    out = parsed;
+    return true;
+}
+
+std::string FormatLargerThanLifeRule(const LargerThanLifeRule& rule)
+{
+    return "R" + std::to_string(rule.range) + ",C" + std::to_string(rule.states == 2 ? 0 : rule.states) + ",M" +
+        (rule.countMiddle ? "1" : "0") + ",S" + std::to_string(rule.survivalMin) + ".." +
+        std::to_string(rule.survivalMax) + ",B" + std::to_string(rule.birthMin) + ".." +
+        std::to_string(rule.birthMax) + ",N" + (rule.vonNeumann ? "N" : "M");
+}
+
+// Copies live cells (state 1) into a plane with pad wrapped cells on every side
+void LargerThanLifeEngine::LoadPadded(const Grid& grid, int pad)
+{
+    rows = grid.GetRows();
+    columns = grid.GetColumns();
+    paddedHeight = rows + 2 * pad;
+    paddedWidth = columns + 2 * pad;
+
+    state.resize(static_cast<size_t>(rows) * columns);
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++)
+        {
+            state[static_cast<size_t>(row) * columns + column] = static_cast<uint8_t>(grid.Get(row, column));
+        }
+    }
+
+    padded.resize(static_cast<size_t>(paddedHeight) * paddedWidth);
+    for (int i = 0; i < paddedHeight; i++)
+    {
+        // Pads can be wider than the board itself, hence the double modulo
+        int row = ((i - pad) % rows + rows) % rows;
+        const uint8_t* source = state.data() + static_cast<size_t>(row) * columns;
+        uint8_t* out = padded.data() + static_cast<size_t>(i) * paddedWidth;
+        for (int j = 0; j < paddedWidth; j++)
+        {
+            int column = ((j - pad) % columns + columns) % columns;
+            out[j] = source[column] == 1;
+        }
+    }
+}
+
+void LargerThanLifeEngine::CountMoore(int range)
+{
+    // areaTable[(i + 1) * (W + 1) + (j + 1)] = sum of padded[0..i][0..j]; unsigned wraparound keeps differences exact
+    const int stride = paddedWidth + 1;
+    areaTable.assign(static_cast<size_t>(paddedHeight + 1) * stride, 0);
+    for (int i = 0; i < paddedHeight; i++)
+    {
+        uint32_t rowSum = 0;
+        const uint8_t* in = padded.data() + static_cast<size_t>(i) * paddedWidth;
+        uint32_t* above = areaTable.data() + static_cast<size_t>(i) * stride;
+        uint32_t* out = above + stride;
+        for (int j = 0; j < paddedWidth; j++)
+        {
+            rowSum += in[j];
+            out[j + 1] = above[j + 1] + rowSum;
+        }
+    }
+
+    const int side = 2 * range + 1;
+    for (int row = 0; row < rows; row++)
+    {
+        const uint32_t* top = areaTable.data() + static_cast<size_t>(row) * stride;
+        const uint32_t* bottom = areaTable.data() + static_cast<size_t>(row + side) * stride;
+        uint32_t* out = counts.data() + static_cast<size_t>(row) * columns;
+        for (int column = 0; column < columns; column++)
+        {
+            out[column] = bottom[column + side] - top[column + side] - bottom[column] + top[column];
+        }
+    }
+}
+
+void LargerThanLifeEngine::CountVonNeumann(int range)
+{
+    const int h = paddedHeight;
+    const int w = paddedWidth;
+    auto at = [w](int i, int j) { return static_cast<size_t>(i) * w + j; };
+
+    // Prefix sums along down-right (main) and down-left (anti) diagonals
+    mainDiagonal.resize(padded.size());
+    antiDiagonal.resize(padded.size());
+    for (int i = 0; i < h; i++)
+    {
+        for (int j = 0; j < w; j++)
+        {
+            uint32_t cell = padded[at(i, j)];
+            mainDiagonal[at(i, j)] = cell + (i > 0 && j > 0 ? mainDiagonal[at(i - 1, j - 1)] : 0);
+            antiDiagonal[at(i, j)] = cell + (i > 0 && j + 1 < w ? antiDiagonal[at(i - 1, j + 1)] : 0);
+        }
+    }
+
+    // len cells starting at (i, j) going down-right / down-left
+    auto mainSegment = [&](int i, int j, int len)
+    {
+        uint32_t before = i > 0 && j > 0 ? mainDiagonal[at(i - 1, j - 1)] : 0;
+        return mainDiagonal[at(i + len - 1, j + len - 1)] - before;
+    };
+    auto antiSegment = [&](int i, int j, int len)
+    {
+        uint32_t before = i > 0 && j + 1 < w ? antiDiagonal[at(i - 1, j + 1)] : 0;
+        return antiDiagonal[at(i + len - 1, j - len + 1)] - before;
+    };
+
+    const int pad = range + 1;
+    const int r = range;
+
+    // Diamond around the first cell directly, every other one by sliding
+    uint32_t rowStart = 0;
+    for (int dy = -r; dy <= r; dy++)
+    {
+        int span = r - std::abs(dy);
+        for (int dx = -span; dx <= span; dx++)
+        {
+            rowStart += padded[at(pad + dy, pad + dx)];
+        }
+    }
+
+    for (int row = 0; row < rows; row++)
+    {
+        int i = row + pad;
+        if (row > 0)
+        {
+            // Slide down from (i - 1, pad): add the bottom edges, drop the top edges
+            int j = pad;
+            int p = i - 1;
+            rowStart += mainSegment(p + 1, j - r, r + 1) + antiSegment(p + 1, j + r, r);
+            rowStart -= antiSegment(p - r, j, r + 1) + mainSegment(p - r + 1, j + 1, r);
+        }
+
+        uint32_t sum = rowStart;
+        uint32_t* out = counts.data() + static_cast<size_t>(row) * columns;
+        out[0] = sum;
+        for (int column = 1; column < columns; column++)
+        {
+            // Slide right from (i, j): add the right edges, drop the left edges
+            int j = column - 1 + pad;
+            sum += mainSegment(i - r, j + 1, r + 1) + antiSegment(i + 1, j + r, r);
+            sum -= antiSegment(i - r, j, r + 1) + mainSegment(i + 1, j - r + 1, r);
+            out[column] = sum;
+        }
+    }
+}
+
+void LargerThanLifeEngine::Step(Grid& grid, const LargerThanLifeRule& rule)
+{
+    // Diamond edges reach one cell further than the range, boxes do not
+    LoadPadded(grid, rule.vonNeumann ? rule.range + 1 : rule.range);
+    counts.resize(static_cast<size_t>(rows) * columns);
+    if (rule.vonNeumann)
+    {
+        CountVonNeumann(rule.range);
+    }
+    else
+    {
+        CountMoore(rule.range);
+    }
+
+    population = 0;
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++)
+        {
+            size_t index = static_cast<size_t>(row) * columns + column;
+            int cellValue = state[index];
+            int count = static_cast<int>(counts[index]) - (rule.countMiddle ? 0 : (cellValue == 1));
+            int nextValue;
+            if (cellValue == 1)
+            {
+                nextValue = rule.Survives(count) ? 1 : (rule.states > 2 ? 2 : 0);
+            }
+            else if (cellValue == 0)
+            {
+                nextValue = rule.Born(count) ? 1 : 0;
+            }
+            else
+            {
+                nextValue = cellValue + 1 < rule.states ? cellValue + 1 : 0;
+            }
+
+            if (nextValue != cellValue)
+            {
+                grid.Set(row, column, nextValue);
+            }
+            population += nextValue != 0;
+        }
+    }
+}
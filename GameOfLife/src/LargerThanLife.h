@@ -0,0 +1,64 @@
+#pragma once
+#include "Grid.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Range-R outer-totalistic rule in Golly's notation, e.g. Bosco's rule
+// R5,C0,M1,S34..58,B34..45,NM
+//   R  range 1..10          C  states (0 or 2 for two-state, up to 256 for Generations-style decay)
+//   M  1 counts the middle  S/B  survival and birth intervals  N  M (Moore) or N (von Neumann)
+struct LargerThanLifeRule
+{
+    int range = 1;
+    int states = 2;
+    bool countMiddle = false;
+    bool vonNeumann = false;
+    int survivalMin = 2;
+    int survivalMax = 3;
+    int birthMin = 3;
+    int birthMax = 3;
+
+    bool Survives(int count) const { return count >= survivalMin && count <= survivalMax; }
+    bool Born(int count) const { return count >= birthMin && count <= birthMax; }
+
+    bool operator==(const LargerThanLifeRule& other) const = default;
+};
+
+// True when text looks like an LtL rule (starts with R and a digit) rather than Bx/Sy
+bool IsLargerThanLifeRule(const std::string& text);
+bool ParseLargerThanLifeRule(const std::string& text, LargerThanLifeRule& out, std::string* error = nullptr);
+std::string FormatLargerThanLifeRule(const LargerThanLifeRule& rule);
+
+// Step engine for LtL rules. Every generation the live cells are copied into a
+// torus-padded plane and turned into running sums: a summed-area table for Moore
+// boxes, diagonal prefix sums for von Neumann diamonds (the diamond is slid one cell
+// at a time, adding and removing four diagonal edge segments). Each cell costs O(1)
+// whatever the range.
+class LargerThanLifeEngine
+{
+public:
+    void Step(Grid& grid, const LargerThanLifeRule& rule);
+    long long GetPopulation() const { return population; }
+
+    // Neighbourhood counts of the last Step, middle cell included, row-major
+    const std::vector<uint32_t>& GetCounts() const { return counts; }
+
+private:
+    void LoadPadded(const Grid& grid, int pad);
+    void CountMoore(int range);
+    void CountVonNeumann(int range);
+
+    int rows = 0;
+    int columns = 0;
+    int paddedWidth = 0;
+    int paddedHeight = 0;
+
+    std::vector<uint8_t> state;
+    std::vector<uint8_t> padded;
+    std::vector<uint32_t> mainDiagonal;
+    std::vector<uint32_t> antiDiagonal;
+    std::vector<uint32_t> areaTable;
+    std::vector<uint32_t> counts;
+    long long population = 0;
+};
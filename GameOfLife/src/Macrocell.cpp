@@ -0,0 +1,357 @@
+#include "Simulation.h"
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+// Golly macrocell files. After a "[M2]" header and # lines (#R rule, #G generation)
+// every line defines the next quadtree node, numbered from 1, 0 being the empty node:
+//   two states:  8x8 leaves as rows of '.' and '*' ended by '$' (trailing dead cells
+//                and rows omitted), then "level nw ne sw se" for levels 4 and up
+//   more states: "1 a b c d" holds four cell states, "level nw ne sw se" from level 2
+// The last node is the root, a 2^level square centred on the origin. Cells are at
+// (x, y) relative to the board centre as in Life 1.06, y growing downwards.
+
+namespace
+{
+    // Deep enough for any board, shallow enough for long long offsets
+    constexpr int kMaxLevel = 60;
+
+    struct MacroNode
+    {
+        int level = 0;
+        bool isLeaf = false;
+        // Children nw, ne, sw, se for inner nodes; cell states for level 1
+        int64_t parts[4] = {};
+        // Level 3 leaf: row r in bits 8r..8r+7, column c in bit c of its row
+        uint64_t leaf = 0;
+    };
+
+    // Paints nodes into a board without expanding them anywhere else: subtrees that
+    // miss the board are skipped, so only on-board cells cost anything
+    class MacroPainter
+    {
+    public:
+        MacroPainter(const std::vector<MacroNode>& nodes, PackedBoard& board, int maxState)
+            : nodes(nodes), board(board), maxState(maxState)
+        {
+        }
+
+        void Paint(int64_t index, long long top, long long left)
+        {
+            if (index == 0) return;
+            const MacroNode& node = nodes[index];
+            const long long size = 1LL << node.level;
+            if (top >= board.GetRows() || left >= board.GetColumns() || top + size <= 0 || left + size <= 0)
+            {
+                clipped = true;
+                return;
+            }
+            if (node.isLeaf)
+            {
+                for (uint64_t bits = node.leaf; bits != 0; bits &= bits - 1)
+                {
+                    const int bit = std::countr_zero(bits);
+                    SetCell(top + bit / 8, left + bit % 8, 1);
+                }
+                return;
+            }
+            if (node.level == 1)
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    if (node.parts[i] != 0) SetCell(top + i / 2, left + i % 2, static_cast<int>(node.parts[i]));
+                }
+                return;
+            }
+            const long long half = size / 2;
+            Paint(node.parts[0], top, left);
+            Paint(node.parts[1], top, left + half);
+            Paint(node.parts[2], top + half, left);
+            Paint(node.parts[3], top + half, left + half);
+        }
+
+        bool clipped = false;
+        // Some state was above the rule's last one and was lowered to it
+        bool clamped = false;
+
+    private:
+        void SetCell(long long row, long long column, int state)
+        {
+            if (row < 0 || row >= board.GetRows() || column < 0 || column >= board.GetColumns())
+            {
+                clipped = true;
+                return;
+            }
+            if (state > maxState)
+            {
+                clamped = true;
+                state = maxState;
+            }
+            board.SetState(static_cast<int>(row), static_cast<int>(column), state);
+        }
+
+        const std::vector<MacroNode>& nodes;
+        PackedBoard& board;
+        const int maxState;
+    };
+
+    struct NodeKeyHash
+    {
+        size_t operator()(const std::array<int64_t, 5>& key) const
+        {
+            size_t hash = 0;
+            for (int64_t part : key) hash = (hash ^ static_cast<size_t>(part)) * 0x100000001b3ULL;
+            return hash;
+        }
+    };
+
+    // Builds the quadtree of a board bottom-up, numbering each distinct node once
+    // and writing it as soon as it is numbered
+    class MacroWriter
+    {
+    public:
+        MacroWriter(const PackedBoard& board, std::ostream& out) : board(board), out(out), multiState(board.GetPlanes() > 1) {}
+
+        int64_t Node(int level, long long top, long long left)
+        {
+            const long long size = 1LL << level;
+            if (top >= board.GetRows() || left >= board.GetColumns() || top + size <= 0 || left + size <= 0) return 0;
+            if (!multiState && level == 3) return Leaf(top, left);
+
+            std::array<int64_t, 5> key{level, 0, 0, 0, 0};
+            const long long half = size / 2;
+            for (int i = 0; i < 4; i++)
+            {
+                const long long row = top + (i / 2) * half;
+                const long long column = left + (i % 2) * half;
+                key[i + 1] = level == 1 ? State(row, column) : Node(level - 1, row, column);
+            }
+            if (key[1] == 0 && key[2] == 0 && key[3] == 0 && key[4] == 0) return 0;
+            auto [it, added] = inner.try_emplace(key, count + 1);
+            if (added)
+            {
+                ++count;
+                out << level << ' ' << key[1] << ' ' << key[2] << ' ' << key[3] << ' ' << key[4] << '\n';
+            }
+            return it->second;
+        }
+
+    private:
+        int State(long long row, long long column) const
+        {
+            if (row < 0 || row >= board.GetRows() || column < 0 || column >= board.GetColumns()) return 0;
+            return board.GetState(static_cast<int>(row), static_cast<int>(column));
+        }
+
+        int64_t Leaf(long long top, long long left)
+        {
+            uint64_t bits = 0;
+            for (int i = 0; i < 64; i++) bits |= static_cast<uint64_t>(State(top + i / 8, left + i % 8) == 1) << i;
+            if (bits == 0) return 0;
+            auto [it, added] = leaves.try_emplace(bits, count + 1);
+            if (!added) return it->second;
+            ++count;
+            // Trailing dead cells and empty trailing rows are left out
+            const int lastRow = (63 - std::countl_zero(bits)) / 8;
+            for (int row = 0; row <= lastRow; row++)
+            {
+                const unsigned cells = static_cast<unsigned>(bits >> (row * 8)) & 0xff;
+                for (int column = 0; column < 8 - std::countl_zero(static_cast<uint8_t>(cells)); column++)
+                {
+                    out << ((cells >> column) & 1 ? '*' : '.');
+                }
+                out << '$';
+            }
+            out << '\n';
+            return it->second;
+        }
+
+        const PackedBoard& board;
+        std::ostream& out;
+        const bool multiState;
+        int64_t count = 0;
+        std::unordered_map<uint64_t, int64_t> leaves;
+        std::unordered_map<std::array<int64_t, 5>, int64_t, NodeKeyHash> inner;
+    };
+}
+
+bool Simulation::ParseMacrocell(const std::string& filePath, int rows, int columns, BoardSnapshot& out,
+                                std::vector<std::string>& warnings)
+{
+    std::ifstream in(filePath);
+    if (!in.is_open())
+    {
+        warnings.push_back("Cannot open file: " + filePath);
+        return false;
+    }
+
+    out = BoardSnapshot{};
+    out.birth.fill(false);
+    out.survival.fill(false);
+    out.birth[3] = true;
+    out.survival[2] = true;
+    out.survival[3] = true;
+    out.states = 2;
+
+    std::string line;
+    if (!std::getline(in, line) || line.rfind("[M2]", 0) != 0)
+    {
+        warnings.push_back("Missing macrocell header '[M2]'");
+        return false;
+    }
+
+    // Index 0 is the empty node
+    std::vector<MacroNode> nodes(1);
+    int lineNo = 1;
+    auto fail = [&](const std::string& message)
+    {
+        warnings.push_back(message + " at line " + std::to_string(lineNo));
+        return false;
+    };
+    while (std::getline(in, line))
+    {
+        ++lineNo;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        if (line[0] == '#')
+        {
+            std::string rest = line.size() > 2 ? line.substr(2) : std::string();
+            if (line.rfind("#R", 0) == 0)
+            {
+                std::string error;
+                bool parsed;
+                if (IsLargerThanLifeRule(rest))
+                {
+                    LargerThanLifeRule rule;
+                    parsed = ParseLargerThanLifeRule(rest, rule, &error);
+                    if (parsed)
+                    {
+                        out.rangeRule = rule;
+                        out.states = rule.states;
+                    }
+                }
+                else
+                {
+                    parsed = ParseRule(rest, out.birth, out.survival, out.states, &error);
+                    if (parsed) out.rangeRule.reset();
+                }
+                if (!parsed) warnings.push_back("Invalid #R rule at line " + std::to_string(lineNo) + " (" + error + ")");
+            }
+            else if (line.rfind("#G", 0) == 0)
+            {
+                out.generation = std::atoll(rest.c_str());
+            }
+            else if (line.rfind("#N", 0) == 0)
+            {
+                out.universeName = rest;
+            }
+            continue;
+        }
+
+        MacroNode node;
+        if (line[0] == '.' || line[0] == '*' || line[0] == '$')
+        {
+            node.level = 3;
+            node.isLeaf = true;
+            int row = 0;
+            int column = 0;
+            for (char c : line)
+            {
+                if (c == '$')
+                {
+                    row++;
+                    column = 0;
+                    continue;
+                }
+                if ((c != '.' && c != '*') || row >= 8 || column >= 8) return fail("Bad leaf");
+                if (c == '*') node.leaf |= uint64_t{1} << (row * 8 + column);
+                column++;
+            }
+        }
+        else
+        {
+            std::istringstream iss(line);
+            if (!(iss >> node.level >> node.parts[0] >> node.parts[1] >> node.parts[2] >> node.parts[3]))
+            {
+                return fail("Cannot parse node");
+            }
+            if (node.level < 1 || node.level > kMaxLevel) return fail("Unsupported node level");
+            for (int64_t part : node.parts)
+            {
+                if (node.level == 1 ? part < 0 || part > 255 : part < 0 || part >= static_cast<int64_t>(nodes.size()))
+                {
+                    return fail("Bad node reference");
+                }
+                if (node.level > 1 && part != 0 && nodes[part].level != node.level - 1) return fail("Child level mismatch");
+            }
+        }
+        nodes.push_back(node);
+    }
+
+    out.cells = PackedBoard(rows, columns, PlanesForStates(out.states));
+    if (nodes.size() == 1) return true;
+
+    // The root's centre is the board's centre
+    const MacroNode& root = nodes.back();
+    const long long half = 1LL << (root.level - 1);
+    MacroPainter painter(nodes, out.cells, out.states - 1);
+    painter.Paint(static_cast<int64_t>(nodes.size() - 1), rows / 2 - half, columns / 2 - half);
+    if (painter.clipped) warnings.push_back("Pattern is larger than the board; cells outside it were dropped");
+    if (painter.clamped) warnings.push_back("States beyond the rule's were lowered to its last state");
+    return true;
+}
+
+bool Simulation::WriteMacrocell(const BoardSnapshot& snapshot, const std::string& outPath, std::string* err)
+{
+    std::ofstream out(outPath);
+    if (!out.is_open())
+    {
+        if (err) *err = "Cannot open output file: " + outPath;
+        return false;
+    }
+
+    out << "[M2] (GameOfLife)\n";
+    out << "#R "
+        << (snapshot.rangeRule ? FormatLargerThanLifeRule(*snapshot.rangeRule)
+                               : FormatRule(snapshot.birth, snapshot.survival, snapshot.states))
+        << "\n";
+    if (snapshot.generation != 0) out << "#G " << snapshot.generation << "\n";
+    if (!snapshot.universeName.empty()) out << "#N " << snapshot.universeName << "\n";
+
+    // Smallest root centred on the board centre that still covers it
+    const PackedBoard& cells = snapshot.Cells();
+    const int centerRow = cells.GetRows() / 2;
+    const int centerCol = cells.GetColumns() / 2;
+    int level = cells.GetPlanes() > 1 ? 1 : 3;
+    while ((1LL << (level - 1)) < std::max({centerRow, centerCol, cells.GetRows() - centerRow,
+                                              cells.GetColumns() - centerCol}))
+    {
+        level++;
+    }
+    const long long half = 1LL << (level - 1);
+    MacroWriter writer(cells, out);
+    writer.Node(level, centerRow - half, centerCol - half);
+
+    if (!out)
+    {
+        if (err) *err = "Write failed: " + outPath;
+        return false;
+    }
+    return true;
+}
+
+bool Simulation::LoadFromMacrocell(const std::string& filePath, std::vector<std::string>& warnings)
+{
+    BoardSnapshot loaded;
+    if (!ParseMacrocell(filePath, grid.GetRows(), grid.GetColumns(), loaded, warnings)) return false;
+    ApplySnapshot(loaded);
+    return true;
+}
+
+bool Simulation::SaveToMacrocell(const std::string& outPath, std::string* err) const
+{
+    return WriteMacrocell(*TakeSnapshot(), outPath, err);
+}
@@ -0,0 +1,306 @@
+#include "MetricsServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define METRICS_POSIX
+#endif
+
+namespace
+{
+    double UnixTime()
+    {
+        return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    long long ResidentBytes()
+    {
+#ifdef METRICS_POSIX
+        // Second field of statm: resident pages (Linux only, 0 elsewhere)
+        FILE* file = std::fopen("/proc/self/statm", "r");
+        if (!file) return 0;
+        long long size = 0;
+        long long resident = 0;
+        int fields = std::fscanf(file, "%lld %lld", &size, &resident);
+        std::fclose(file);
+        return fields == 2 ? resident * sysconf(_SC_PAGESIZE) : 0;
+#else
+        return 0;
+#endif
+    }
+
+#ifdef METRICS_POSIX
+    bool SetNonBlocking(int fd)
+    {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    // A scraper that hangs up mid-response gets EPIPE, never SIGPIPE
+    void WriteAll(int fd, const std::string& text)
+    {
+#ifdef MSG_NOSIGNAL
+        constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+        constexpr int kSendFlags = 0; // SO_NOSIGPIPE is set on accepted clients instead
+#endif
+        size_t sent = 0;
+        while (sent < text.size())
+        {
+            ssize_t n = send(fd, text.data() + sent, text.size() - sent, kSendFlags);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            sent += static_cast<size_t>(n);
+        }
+    }
+#endif
+}
+
+MetricsServer::~MetricsServer()
+{
+    Stop();
+}
+
+bool MetricsServer::Start(const MetricsOptions& metricsOptions, std::string* err)
+{
+    Stop();
+#ifdef METRICS_POSIX
+    auto fail = [&](const std::string& message)
+    {
+        if (err) *err = message + ": " + std::strerror(errno);
+        for (int* fd : {&tcpFd, &unixFd, &wakeFds[0], &wakeFds[1]})
+        {
+            if (*fd >= 0) close(*fd);
+            *fd = -1;
+        }
+        return false;
+    };
+    options = metricsOptions;
+
+    if (options.port >= 0)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(options.port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        tcpFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        if (tcpFd >= 0) setsockopt(tcpFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        socklen_t length = sizeof(address);
+        if (tcpFd < 0 || bind(tcpFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(tcpFd, 8) != 0 || getsockname(tcpFd, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+        {
+            return fail("Cannot listen on port " + std::to_string(options.port));
+        }
+        boundPort = ntohs(address.sin_port);
+    }
+    if (!options.socketPath.empty())
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options.socketPath.size() >= sizeof(address.sun_path))
+        {
+            errno = ENAMETOOLONG;
+            return fail("Cannot listen on " + options.socketPath);
+        }
+        std::memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size() + 1);
+        struct stat info{};
+        if (stat(options.socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) unlink(options.socketPath.c_str());
+        unixFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (unixFd < 0 || bind(unixFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(unixFd, 8) != 0)
+        {
+            return fail("Cannot listen on " + options.socketPath);
+        }
+    }
+    if (!options.jsonlPath.empty())
+    {
+        FILE* file = std::fopen(options.jsonlPath.c_str(), "a");
+        if (!file) return fail("Cannot open " + options.jsonlPath);
+        std::fclose(file);
+    }
+    if (pipe(wakeFds) != 0) return fail("Cannot create wake pipe");
+    if (tcpFd >= 0) SetNonBlocking(tcpFd);
+    if (unixFd >= 0) SetNonBlocking(unixFd);
+
+    rateTime = std::chrono::steady_clock::now();
+    rateGeneration = generation.load(std::memory_order_relaxed);
+    rate = 0.0;
+    thread = std::thread([this] { Run(); });
+    return true;
+#else
+    (void)metricsOptions;
+    if (err) *err = "Metrics are not supported on this platform";
+    return false;
+#endif
+}
+
+void MetricsServer::Stop()
+{
+    if (!thread.joinable()) return;
+#ifdef METRICS_POSIX
+    char byte = 0;
+    (void)!write(wakeFds[1], &byte, 1);
+    thread.join();
+    for (int* fd : {&tcpFd, &unixFd, &wakeFds[0], &wakeFds[1]})
+    {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+    if (!options.socketPath.empty()) unlink(options.socketPath.c_str());
+#endif
+    boundPort = 0;
+}
+
+void MetricsServer::MarkCheckpoint()
+{
+    lastCheckpoint.store(UnixTime(), std::memory_order_relaxed);
+}
+
+MetricsServer::Sample MetricsServer::TakeSample()
+{
+    Sample sample;
+    sample.generation = generation.load(std::memory_order_relaxed);
+    sample.population = population.load(std::memory_order_relaxed);
+    sample.activeTiles = activeTiles.load(std::memory_order_relaxed);
+    sample.lastCheckpoint = lastCheckpoint.load(std::memory_order_relaxed);
+    sample.residentBytes = ResidentBytes();
+
+    // Rate over the last second or more; scrapes in between reuse it
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - rateTime).count();
+    if (seconds >= 1.0)
+    {
+        rate = (sample.generation - rateGeneration) / seconds;
+        rateTime = now;
+        rateGeneration = sample.generation;
+    }
+    sample.generationsPerSecond = rate;
+    return sample;
+}
+
+void MetricsServer::Run()
+{
+#ifdef METRICS_POSIX
+    using Clock = std::chrono::steady_clock;
+    const bool jsonl = !options.jsonlPath.empty();
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(options.intervalSeconds, 0.01)));
+    auto nextLine = Clock::now() + interval;
+
+    for (;;)
+    {
+        pollfd fds[3];
+        int count = 0;
+        fds[count++] = {wakeFds[0], POLLIN, 0};
+        if (tcpFd >= 0) fds[count++] = {tcpFd, POLLIN, 0};
+        if (unixFd >= 0) fds[count++] = {unixFd, POLLIN, 0};
+
+        // Wake at least once a second to keep the rate window short
+        auto wait = std::chrono::milliseconds(1000);
+        if (jsonl) wait = std::min(wait, std::chrono::duration_cast<std::chrono::milliseconds>(nextLine - Clock::now()));
+        int ready = poll(fds, count, static_cast<int>(std::max<long long>(wait.count(), 0)));
+        if (ready < 0 && errno != EINTR) break;
+        if (fds[0].revents) break;
+
+        for (int i = 1; i < count && ready > 0; i++)
+        {
+            if (!(fds[i].revents & POLLIN)) continue;
+            int client;
+            while ((client = accept(fds[i].fd, nullptr, nullptr)) >= 0)
+            {
+#ifdef SO_NOSIGPIPE
+                int on = 1;
+                setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+                Serve(client);
+                close(client);
+            }
+        }
+
+        Sample sample = TakeSample();
+        if (jsonl && Clock::now() >= nextLine)
+        {
+            AppendJsonl(sample);
+            nextLine += interval;
+            if (nextLine < Clock::now()) nextLine = Clock::now() + interval;
+        }
+    }
+    if (jsonl) AppendJsonl(TakeSample());
+#endif
+}
+
+void MetricsServer::Serve(int fd)
+{
+#ifdef METRICS_POSIX
+    // Read the request head, giving a silent client 200 ms
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+    {
+        pollfd in{fd, POLLIN, 0};
+        if (poll(&in, 1, 200) <= 0) break;
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        request.append(buffer, static_cast<size_t>(n));
+    }
+    const bool known = request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET / ", 0) == 0;
+    if (!known)
+    {
+        WriteAll(fd, "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        return;
+    }
+
+    Sample sample = TakeSample();
+    char body[1536];
+    int length = std::snprintf(body, sizeof(body),
+        "# HELP gol_generation Generations simulated.\n"
+        "# TYPE gol_generation counter\n"
+        "gol_generation %lld\n"
+        "# HELP gol_generations_per_second Generations per second over the last second or more.\n"
+        "# TYPE gol_generations_per_second gauge\n"
+        "gol_generations_per_second %.3f\n"
+        "# HELP gol_population Live cells.\n"
+        "# TYPE gol_population gauge\n"
+        "gol_population %lld\n"
+        "# HELP gol_active_tiles Tiles holding or computing live cells.\n"
+        "# TYPE gol_active_tiles gauge\n"
+        "gol_active_tiles %lld\n"
+        "# HELP gol_resident_memory_bytes Resident set size of the process.\n"
+        "# TYPE gol_resident_memory_bytes gauge\n"
+        "gol_resident_memory_bytes %lld\n"
+        "# HELP gol_last_checkpoint_timestamp_seconds Unix time of the last checkpoint, 0 if none.\n"
+        "# TYPE gol_last_checkpoint_timestamp_seconds gauge\n"
+        "gol_last_checkpoint_timestamp_seconds %.3f\n",
+        sample.generation, sample.generationsPerSecond, sample.population, sample.activeTiles,
+        sample.residentBytes, sample.lastCheckpoint);
+    std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+        std::to_string(length) + "\r\nConnection: close\r\n\r\n";
+    response.append(body, static_cast<size_t>(length));
+    WriteAll(fd, response);
+#else
+    (void)fd;
+#endif
+}
+
+void MetricsServer::AppendJsonl(const Sample& sample)
+{
+    FILE* file = std::fopen(options.jsonlPath.c_str(), "a");
+    if (!file) return;
+    std::fprintf(file,
+                 "{\"time\":%.3f,\"generation\":%lld,\"generations_per_second\":%.3f,\"population\":%lld,"
+                 "\"active_tiles\":%lld,\"resident_memory_bytes\":%lld,\"last_checkpoint\":%.3f}\n",
+                 UnixTime(), sample.generation, sample.generationsPerSecond, sample.population, sample.activeTiles,
+                 sample.residentBytes, sample.lastCheckpoint);
+    std::fclose(file);
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+struct MetricsOptions
+{
+    // TCP port on 127.0.0.1, 0 for any free one, -1 for none
+    int port = -1;
+    // Unix socket path, empty for none
+    std::string socketPath;
+    // Appends one JSON object per interval when set
+    std::string jsonlPath;
+    double intervalSeconds = 10.0;
+};
+
+// Serves the progress of a long run to Prometheus (text format 0.0.4 over HTTP, on
+// a local port and/or a Unix socket) and optionally appends the same figures to a
+// JSONL file. The stepping thread only stores into atomics; a separate thread
+// accepts scrapes, derives gens/sec from successive generation counts, reads the
+// resident set size and writes the file.
+class MetricsServer
+{
+public:
+    MetricsServer() = default;
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    bool Start(const MetricsOptions& options, std::string* err = nullptr);
+    // Writes a last JSONL line when the file is enabled
+    void Stop();
+    bool IsRunning() const { return thread.joinable(); }
+    // Port actually bound, 0 without a TCP listener
+    int GetPort() const { return boundPort; }
+
+    // Hot path: relaxed stores only
+    void Publish(long long generation, long long population, long long activeTiles)
+    {
+        this->generation.store(generation, std::memory_order_relaxed);
+        this->population.store(population, std::memory_order_relaxed);
+        this->activeTiles.store(activeTiles, std::memory_order_relaxed);
+    }
+    // A checkpoint of the board reached disk now
+    void MarkCheckpoint();
+
+private:
+    struct Sample
+    {
+        long long generation = 0;
+        long long population = 0;
+        long long activeTiles = 0;
+        double generationsPerSecond = 0.0;
+        long long residentBytes = 0;
+        // Unix time, 0 before the first checkpoint
+        double lastCheckpoint = 0.0;
+    };
+
+    void Run();
+    Sample TakeSample();
+    void Serve(int fd);
+    void AppendJsonl(const Sample& sample);
+
+    std::atomic<long long> generation{0};
+    std::atomic<long long> population{0};
+    std::atomic<long long> activeTiles{0};
+    std::atomic<double> lastCheckpoint{0.0};
+
+    MetricsOptions options;
+    int tcpFd = -1;
+    int unixFd = -1;
+    // Written by Stop() to wake the publisher
+    int wakeFds[2] = {-1, -1};
+    int boundPort = 0;
+    std::thread thread;
+
+    // Publisher thread only: rate window
+    std::chrono::steady_clock::time_point rateTime;
+    long long rateGeneration = 0;
+    double rate = 0.0;
+};
@@ -0,0 +1,137 @@
+#include "PackedBoard.h"
+#include "Grid.h"
+#include <algorithm>
+#include <bit>
+
+int PlanesForStates(int states)
+{
+    int planes = 1;
+    while ((1 << planes) < states) ++planes;
+    return planes;
+}
+
+PackedBoard::PackedBoard(int rows, int columns, int planes)
+    : rows(rows),
+      columns(columns),
+      planes(planes),
+      wordsPerRow((columns + 63) / 64),
+      words(static_cast<size_t>(rows) * ((columns + 63) / 64) * planes, 0)
+{
+}
+
+PackedBoard PackedBoard::FromGrid(const Grid& grid, int planes)
+{
+    PackedBoard board;
+    board.Assign(grid, planes);
+    return board;
+}
+
+void PackedBoard::Assign(const Grid& grid, int planeCount)
+{
+    if (rows != grid.GetRows() || columns != grid.GetColumns() || planes != planeCount)
+    {
+        *this = PackedBoard(grid.GetRows(), grid.GetColumns(), planeCount);
+    }
+    for (int row = 0; row < rows; row++)
+    {
+        const uint8_t* cells = grid.Row(row);
+        for (int word = 0; word < wordsPerRow; word++)
+        {
+            const uint8_t* span = cells + word * 64;
+            int count = std::min(64, columns - word * 64);
+            // One word per plane from up to 64 cell bytes
+            if (planes == 1)
+            {
+                uint64_t bits = 0;
+                for (int i = 0; i < count; i++) bits |= uint64_t{span[i] != 0} << i;
+                Row(row)[word] = bits;
+                continue;
+            }
+            for (int plane = 0; plane < planes; plane++)
+            {
+                uint64_t bits = 0;
+                for (int i = 0; i < count; i++) bits |= uint64_t{(span[i] >> plane) & 1u} << i;
+                Row(row, plane)[word] = bits;
+            }
+        }
+    }
+}
+
+void PackedBoard::ToGrid(Grid& grid) const
+{
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++)
+        {
+            grid.Set(row, column, GetState(row, column));
+        }
+    }
+}
+
+PackedBoard PackedBoard::WithPlanes(int planeCount) const
+{
+    PackedBoard board(rows, columns, planeCount);
+    size_t planeWords = static_cast<size_t>(rows) * wordsPerRow;
+    size_t copied = planeWords * std::min(planes, planeCount);
+    std::copy(words.begin(), words.begin() + static_cast<std::ptrdiff_t>(copied), board.words.begin());
+    return board;
+}
+
+bool PackedBoard::Get(int row, int column) const
+{
+    return (Row(row)[column >> 6] >> (column & 63)) & 1;
+}
+
+void PackedBoard::Set(int row, int column, bool value)
+{
+    uint64_t bit = uint64_t{1} << (column & 63);
+    uint64_t& word = Row(row)[column >> 6];
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+int PackedBoard::GetState(int row, int column) const
+{
+    int state = 0;
+    for (int plane = 0; plane < planes; plane++)
+    {
+        state |= static_cast<int>((Row(row, plane)[column >> 6] >> (column & 63)) & 1) << plane;
+    }
+    return state;
+}
+
+void PackedBoard::SetState(int row, int column, int state)
+{
+    uint64_t bit = uint64_t{1} << (column & 63);
+    for (int plane = 0; plane < planes; plane++)
+    {
+        uint64_t& word = Row(row, plane)[column >> 6];
+        word = ((state >> plane) & 1) ? (word | bit) : (word & ~bit);
+    }
+}
+
+void PackedBoard::Clear()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+uint64_t PackedBoard::GetLastWordMask() const
+{
+    int used = columns & 63;
+    return used == 0 ? ~uint64_t{0} : (uint64_t{1} << used) - 1;
+}
+
+size_t PackedBoard::Population() const
+{
+    size_t planeWords = static_cast<size_t>(rows) * wordsPerRow;
+    size_t count = 0;
+    for (size_t i = 0; i < planeWords; ++i)
+    {
+        uint64_t any = 0;
+        for (int plane = 0; plane < planes; plane++)
+        {
+            any |= words[plane * planeWords + i];
+        }
+        count += std::popcount(any);
+    }
+    return count;
+}
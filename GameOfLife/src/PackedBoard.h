@@ -0,0 +1,73 @@
+#pragma once
+#include "Grid.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bit-packed board: one bit per cell, every row padded to a whole number of 64-bit words.
+// Bit (column % 64) of word (column / 64) holds the cell in that column.
+// Multi-state boards use several planes, plane i holding bit i of every cell state.
+class PackedBoard
+{
+public:
+    PackedBoard() = default;
+    PackedBoard(int rows, int columns, int planes = 1);
+
+    // With one plane any non-zero cell is set, otherwise cell states are sliced into planes
+    static PackedBoard FromGrid(const Grid& grid, int planes = 1);
+    // Same, in place: reuses the words when the shape matches
+    void Assign(const Grid& grid, int planes = 1);
+    void ToGrid(Grid& grid) const;
+    // Copy with planes added (zero) or dropped
+    PackedBoard WithPlanes(int planeCount) const;
+
+    bool Get(int row, int column) const;
+    void Set(int row, int column, bool value);
+    int GetState(int row, int column) const;
+    void SetState(int row, int column, int state);
+    void Clear();
+    // Number of non-zero cells
+    size_t Population() const;
+
+    int GetRows() const { return rows; }
+    int GetColumns() const { return columns; }
+    int GetPlanes() const { return planes; }
+    int GetWordsPerRow() const { return wordsPerRow; }
+    // Valid bits of the last word in every row
+    uint64_t GetLastWordMask() const;
+
+    uint64_t* Row(int row, int plane = 0) { return words.data() + WordOffset(row, plane); }
+    const uint64_t* Row(int row, int plane = 0) const { return words.data() + WordOffset(row, plane); }
+
+    std::vector<uint64_t>& Words() { return words; }
+    const std::vector<uint64_t>& Words() const { return words; }
+
+    bool operator==(const PackedBoard& other) const = default;
+
+private:
+    size_t WordOffset(int row, int plane) const
+    {
+        return (static_cast<size_t>(plane) * rows + row) * wordsPerRow;
+    }
+
+    int rows = 0;
+    int columns = 0;
+    int planes = 1;
+    int wordsPerRow = 0;
+    std::vector<uint64_t> words;
+};
+
+// Bit planes needed for cell states 0..states-1
+int PlanesForStates(int states);
+
+// Copy-on-write check for boards handed out as snapshots: true when nobody else holds
+// board, so it may be written in place. The fence orders that write after whatever a
+// thread that just dropped its copy read.
+inline bool IsSoleOwner(const std::shared_ptr<PackedBoard>& board)
+{
+    if (!board || board.use_count() != 1) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
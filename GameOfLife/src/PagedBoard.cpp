@@ -0,0 +1,541 @@
+#include "PagedBoard.h"
+#include "BitCount.h"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PAGED_BOARD_POSIX
+#endif
+
+namespace
+{
+    struct PagedHeader
+    {
+        static constexpr uint32_t kMagic = 0x504c4f47; // "GOLP"
+        static constexpr uint32_t kVersion = 2;
+
+        uint32_t magic = kMagic;
+        uint32_t version = kVersion;
+        int64_t rows = 0;
+        int64_t columns = 0;
+        int64_t generation = 0;
+        // Plane holding the checkpointed generation
+        int32_t current = 0;
+        // Bit n set when n neighbours give birth / survival
+        uint16_t birth = 0;
+        uint16_t survival = 0;
+        // What Resume must find in that plane
+        int64_t population = 0;
+        int64_t tiles = 0;
+    };
+
+    constexpr size_t kHeaderBytes = 4096;
+    constexpr int kRows = PagedBoard::kTileRows;
+    constexpr int kWords = PagedBoard::kTileWords;
+
+    uint16_t RuleBits(const std::array<bool, 9>& rule)
+    {
+        uint16_t bits = 0;
+        for (int n = 0; n <= 8; n++) bits |= static_cast<uint16_t>(rule[n]) << n;
+        return bits;
+    }
+
+    std::array<bool, 9> RuleFromBits(uint16_t bits)
+    {
+        std::array<bool, 9> rule{};
+        for (int n = 0; n <= 8; n++) rule[n] = (bits >> n) & 1;
+        return rule;
+    }
+
+    bool IsEmpty(const uint64_t* words)
+    {
+        for (int i = 0; i < kRows * kWords; i++)
+        {
+            if (words[i] != 0) return false;
+        }
+        return true;
+    }
+}
+
+PagedBoard::~PagedBoard()
+{
+    Close();
+}
+
+bool PagedBoard::Create(const std::string& filePath, long long boardRows, long long boardColumns, std::string* err)
+{
+    Close();
+    if (boardRows <= 0 || boardColumns <= 0 || boardRows % kTileRows != 0 || boardColumns % kTileColumns != 0)
+    {
+        if (err)
+        {
+            *err = "Paged boards need rows in multiples of " + std::to_string(kTileRows) + " and columns in multiples of " +
+                std::to_string(kTileColumns);
+        }
+        return false;
+    }
+#ifdef PAGED_BOARD_POSIX
+    int file = open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+    {
+        if (err) *err = "Cannot create " + filePath + ": " + std::strerror(errno);
+        return false;
+    }
+    rows = boardRows;
+    columns = boardColumns;
+    tileRows = rows / kTileRows;
+    tileColumns = columns / kTileColumns;
+    generation = 0;
+    population = 0;
+    current = 0;
+    checkpointPlane = 0;
+    birth = RuleFromBits(1 << 3);
+    survival = RuleFromBits((1 << 2) | (1 << 3));
+    // Extending the file allocates nothing, every tile starts as a hole
+    const size_t bytes = kHeaderBytes + kPlanes * static_cast<size_t>(tileRows * tileColumns) * kTileBytes;
+    if (ftruncate(file, static_cast<off_t>(bytes)) != 0)
+    {
+        if (err) *err = "Cannot size " + filePath + ": " + std::strerror(errno);
+        close(file);
+        return false;
+    }
+    if (!Map(file, err)) return false;
+    path = filePath;
+    WriteHeader();
+    return true;
+#else
+    (void)filePath;
+    if (err) *err = "Paged boards are not supported on this platform";
+    return false;
+#endif
+}
+
+bool PagedBoard::Resume(const std::string& filePath, std::string* err)
+{
+    Close();
+#ifdef PAGED_BOARD_POSIX
+    int file = open(filePath.c_str(), O_RDWR);
+    PagedHeader header;
+    if (file < 0 || pread(file, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+    {
+        if (err) *err = "Cannot read " + filePath;
+        if (file >= 0) close(file);
+        return false;
+    }
+    if (header.magic != PagedHeader::kMagic || header.version != PagedHeader::kVersion || header.rows <= 0 ||
+        header.columns <= 0 || header.rows % kTileRows != 0 || header.columns % kTileColumns != 0 ||
+        header.current < 0 || header.current >= kPlanes || (header.birth & 1) != 0)
+    {
+        if (err) *err = "Not a paged board file: " + filePath;
+        close(file);
+        return false;
+    }
+    rows = header.rows;
+    columns = header.columns;
+    tileRows = rows / kTileRows;
+    tileColumns = columns / kTileColumns;
+    generation = header.generation;
+    current = header.current;
+    checkpointPlane = current;
+    birth = RuleFromBits(header.birth);
+    survival = RuleFromBits(header.survival);
+    if (!Map(file, err)) return false;
+    path = filePath;
+
+    population = ScanPlane(current, planeTiles[current]);
+    if (population != header.population || static_cast<int64_t>(planeTiles[current].size()) != header.tiles)
+    {
+        if (err)
+        {
+            *err = "Checkpoint in " + filePath + " is damaged: " + std::to_string(population) + " cells in " +
+                std::to_string(planeTiles[current].size()) + " tiles, the header recorded " +
+                std::to_string(header.population) + " in " + std::to_string(header.tiles);
+        }
+        Close();
+        return false;
+    }
+    // Tiles left in the other planes are released when steps reach them
+    for (int plane = 0; plane < kPlanes; plane++)
+    {
+        if (plane != current) ScanPlane(plane, planeTiles[plane]);
+    }
+    return true;
+#else
+    (void)filePath;
+    if (err) *err = "Paged boards are not supported on this platform";
+    return false;
+#endif
+}
+
+long long PagedBoard::ScanPlane(int plane, std::unordered_set<uint64_t>& tiles) const
+{
+    long long count = 0;
+#ifdef PAGED_BOARD_POSIX
+    // Only allocated extents can hold live cells; holes are skipped without reading them
+    const off_t tileBytes = static_cast<off_t>(kTileBytes);
+    const off_t planeStart = reinterpret_cast<uint8_t*>(Tile(plane, 0)) - base;
+    const off_t planeEnd = planeStart + static_cast<off_t>(tileRows * tileColumns) * tileBytes;
+    off_t offset = planeStart;
+    while (offset < planeEnd)
+    {
+#ifdef SEEK_DATA
+        const off_t data = lseek(fd, offset, SEEK_DATA);
+        if (data < 0 || data >= planeEnd) break;
+        off_t hole = lseek(fd, data, SEEK_HOLE);
+        if (hole < 0 || hole > planeEnd) hole = planeEnd;
+#else
+        const off_t data = offset;
+        const off_t hole = planeEnd;
+#endif
+        for (off_t at = data - (data - planeStart) % tileBytes; at < hole; at += tileBytes)
+        {
+            const uint64_t tile = static_cast<uint64_t>((at - planeStart) / tileBytes);
+            const uint64_t* words = Tile(plane, tile);
+            if (IsEmpty(words)) continue;
+            tiles.insert(tile);
+            for (int i = 0; i < kRows * kWords; i++) count += std::popcount(words[i]);
+        }
+        offset = std::max(hole, data + 1);
+    }
+#else
+    (void)plane;
+    (void)tiles;
+#endif
+    return count;
+}
+
+bool PagedBoard::Map(int file, std::string* err)
+{
+#ifdef PAGED_BOARD_POSIX
+    mappedBytes = kHeaderBytes + kPlanes * static_cast<size_t>(tileRows * tileColumns) * kTileBytes;
+    void* mapping = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (mapping == MAP_FAILED)
+    {
+        if (err) *err = std::string("Cannot map the board: ") + std::strerror(errno);
+        close(file);
+        mappedBytes = 0;
+        return false;
+    }
+    fd = file;
+    base = static_cast<uint8_t*>(mapping);
+    return true;
+#else
+    (void)file;
+    (void)err;
+    return false;
+#endif
+}
+
+void PagedBoard::Close()
+{
+#ifdef PAGED_BOARD_POSIX
+    if (base) munmap(base, mappedBytes);
+    if (fd >= 0) close(fd);
+#endif
+    base = nullptr;
+    fd = -1;
+    mappedBytes = 0;
+    for (int plane = 0; plane < kPlanes; plane++)
+    {
+        planeTiles[plane].clear();
+        dirtyTiles[plane].clear();
+        punched[plane] = false;
+    }
+    path.clear();
+}
+
+bool PagedBoard::SetRule(const std::array<bool, 9>& birthRule, const std::array<bool, 9>& survivalRule, std::string* err)
+{
+    if (birthRule[0])
+    {
+        if (err) *err = "B0 rules fill every empty tile, paged boards cannot run them";
+        return false;
+    }
+    birth = birthRule;
+    survival = survivalRule;
+    return true;
+}
+
+uint64_t* PagedBoard::Tile(int plane, uint64_t tile) const
+{
+    const size_t tiles = static_cast<size_t>(tileRows * tileColumns);
+    return reinterpret_cast<uint64_t*>(base + kHeaderBytes + (plane * tiles + tile) * kTileBytes);
+}
+
+uint64_t PagedBoard::TileAt(long long row, long long column) const
+{
+    return static_cast<uint64_t>(row / kTileRows * tileColumns + column / kTileColumns);
+}
+
+uint64_t PagedBoard::Neighbour(uint64_t tile, int rowOffset, int columnOffset) const
+{
+    const long long tileRow = (static_cast<long long>(tile) / tileColumns + rowOffset + tileRows) % tileRows;
+    const long long tileColumn = (static_cast<long long>(tile) % tileColumns + columnOffset + tileColumns) % tileColumns;
+    return static_cast<uint64_t>(tileRow * tileColumns + tileColumn);
+}
+
+bool PagedBoard::Get(long long row, long long column) const
+{
+    const uint64_t tile = TileAt(row, column);
+    if (!planeTiles[current].count(tile)) return false;
+    const uint64_t word = Tile(current, tile)[row % kTileRows * kWords + column % kTileColumns / 64];
+    return (word >> (column % 64)) & 1;
+}
+
+void PagedBoard::Set(long long row, long long column, bool alive)
+{
+    const uint64_t tile = TileAt(row, column);
+    if (!planeTiles[current].count(tile) && !alive) return;
+    const size_t index = row % kTileRows * kWords + column % kTileColumns / 64;
+    const uint64_t bit = uint64_t{1} << (column % 64);
+    if (planeTiles[current].count(tile) && ((Tile(current, tile)[index] & bit) != 0) == alive) return;
+
+    Detach();
+    uint64_t* words = Tile(current, tile);
+    words[index] ^= bit;
+    population += alive ? 1 : -1;
+    dirtyTiles[current].insert(tile);
+    if (alive)
+    {
+        planeTiles[current].insert(tile);
+    }
+    else if (IsEmpty(words))
+    {
+        planeTiles[current].erase(tile);
+        Release(current, tile);
+    }
+}
+
+void PagedBoard::Paste(const PackedBoard& board, long long top, long long left)
+{
+    for (int row = 0; row < board.GetRows(); row++)
+    {
+        const uint64_t* words = board.Row(row);
+        for (int i = 0; i < board.GetWordsPerRow(); i++)
+        {
+            for (uint64_t bits = words[i]; bits != 0; bits &= bits - 1)
+            {
+                const int column = i * 64 + std::countr_zero(bits);
+                Set(((top + row) % rows + rows) % rows, ((left + column) % columns + columns) % columns, true);
+            }
+        }
+    }
+}
+
+void PagedBoard::Release(int plane, uint64_t tile)
+{
+#ifdef PAGED_BOARD_POSIX
+    uint64_t* words = Tile(plane, tile);
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+    const off_t offset = reinterpret_cast<uint8_t*>(words) - base;
+    if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, static_cast<off_t>(kTileBytes)) == 0)
+    {
+        dirtyTiles[plane].erase(tile);
+        punched[plane] = true;
+        return;
+    }
+#endif
+    // No hole punching here: the tile keeps its block but reads back empty
+    std::memset(words, 0, kTileBytes);
+    dirtyTiles[plane].insert(tile);
+#else
+    (void)plane;
+    (void)tile;
+#endif
+}
+
+int PagedBoard::ScratchPlane() const
+{
+    for (int plane = 0;; plane++)
+    {
+        if (plane != current && plane != checkpointPlane) return plane;
+    }
+}
+
+void PagedBoard::ReplacePlane(int plane, std::unordered_set<uint64_t>& tiles)
+{
+    for (uint64_t tile : planeTiles[plane])
+    {
+        if (!tiles.count(tile)) Release(plane, tile);
+    }
+    planeTiles[plane].swap(tiles);
+}
+
+void PagedBoard::Detach()
+{
+    if (current != checkpointPlane) return;
+    const int target = ScratchPlane();
+    std::unordered_set<uint64_t> tiles = planeTiles[current];
+    for (uint64_t tile : tiles)
+    {
+        std::memcpy(Tile(target, tile), Tile(current, tile), kTileBytes);
+        dirtyTiles[target].insert(tile);
+    }
+    ReplacePlane(target, tiles);
+    current = target;
+}
+
+long long PagedBoard::StepTile(uint64_t tile, uint64_t* out) const
+{
+    // The tile with a one-cell border: rows -1..kRows, words -1..kWords
+    constexpr int kStride = kWords + 2;
+    uint64_t halo[(kRows + 2) * kStride] = {};
+    for (int tileRow = -1; tileRow <= 1; tileRow++)
+    {
+        for (int tileColumn = -1; tileColumn <= 1; tileColumn++)
+        {
+            const uint64_t neighbour = Neighbour(tile, tileRow, tileColumn);
+            if (!planeTiles[current].count(neighbour)) continue;
+            const uint64_t* words = Tile(current, neighbour);
+            const int firstRow = tileRow < 0 ? kRows - 1 : 0;
+            const int lastRow = tileRow > 0 ? 0 : kRows - 1;
+            const int firstWord = tileColumn < 0 ? kWords - 1 : 0;
+            const int lastWord = tileColumn > 0 ? 0 : kWords - 1;
+            for (int row = firstRow; row <= lastRow; row++)
+            {
+                uint64_t* into = halo + (row + tileRow * kRows + 1) * kStride + 1 + tileColumn * kWords;
+                for (int word = firstWord; word <= lastWord; word++) into[word] = words[row * kWords + word];
+            }
+        }
+    }
+
+    const std::array<bool, 9>& born = birth;
+    const std::array<bool, 9>& survive = survival;
+    long long count = 0;
+    for (int row = 0; row < kRows; row++)
+    {
+        for (int word = 0; word < kWords; word++)
+        {
+            uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            for (int dy = 0; dy <= 2; dy++)
+            {
+                const uint64_t* line = halo + (row + dy) * kStride + word + 1;
+                AddBit((line[0] << 1) | (line[-1] >> 63), s0, s1, s2, s3);
+                if (dy != 1) AddBit(line[0], s0, s1, s2, s3);
+                AddBit((line[0] >> 1) | (line[1] << 63), s0, s1, s2, s3);
+            }
+            const uint64_t alive = halo[(row + 1) * kStride + word + 1];
+            const uint64_t next = (alive & RuleMask(survive, s0, s1, s2, s3)) | (~alive & RuleMask(born, s0, s1, s2, s3));
+            out[row * kWords + word] = next;
+            count += std::popcount(next);
+        }
+    }
+    return count;
+}
+
+void PagedBoard::Step()
+{
+    if (!base) return;
+    // Live tiles and their neighbours are the only ones that can hold cells next generation
+    const std::unordered_set<uint64_t>& liveTiles = planeTiles[current];
+    std::vector<uint64_t> candidates;
+    candidates.reserve(liveTiles.size() * 9);
+    for (uint64_t tile : liveTiles)
+    {
+        for (int tileRow = -1; tileRow <= 1; tileRow++)
+        {
+            for (int tileColumn = -1; tileColumn <= 1; tileColumn++) candidates.push_back(Neighbour(tile, tileRow, tileColumn));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    const int next = ScratchPlane();
+    std::unordered_set<uint64_t> nextTiles;
+    long long nextPopulation = 0;
+    uint64_t words[kRows * kWords];
+    for (uint64_t tile : candidates)
+    {
+        const long long count = StepTile(tile, words);
+        if (count == 0) continue;
+        uint64_t* into = Tile(next, tile);
+        // A tile that came back to what the plane held a few generations ago is not written again
+        if (!planeTiles[next].count(tile) || std::memcmp(into, words, kTileBytes) != 0)
+        {
+            std::memcpy(into, words, kTileBytes);
+            dirtyTiles[next].insert(tile);
+        }
+        nextTiles.insert(tile);
+        nextPopulation += count;
+    }
+    ReplacePlane(next, nextTiles);
+
+    population = nextPopulation;
+    current = next;
+    generation++;
+}
+
+void PagedBoard::Advance(long long generations)
+{
+    for (long long i = 0; i < generations; i++) Step();
+}
+
+void PagedBoard::WriteHeader()
+{
+    PagedHeader header;
+    header.rows = rows;
+    header.columns = columns;
+    header.generation = generation;
+    header.current = current;
+    header.birth = RuleBits(birth);
+    header.survival = RuleBits(survival);
+    header.population = population;
+    header.tiles = static_cast<int64_t>(planeTiles[current].size());
+    std::memcpy(base, &header, sizeof(header));
+}
+
+bool PagedBoard::Checkpoint(std::string* err)
+{
+    if (!base)
+    {
+        if (err) *err = "No paged board is open";
+        return false;
+    }
+#ifdef PAGED_BOARD_POSIX
+    // Tiles first, so the header never names a plane that is not on disk yet
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto sync = [&](const void* start, size_t length)
+    {
+        const uintptr_t first = reinterpret_cast<uintptr_t>(start) / pageSize * pageSize;
+        const uintptr_t end = reinterpret_cast<uintptr_t>(start) + length;
+        return msync(reinterpret_cast<void*>(first), end - first, MS_SYNC) == 0;
+    };
+    for (uint64_t tile : dirtyTiles[current])
+    {
+        if (!sync(Tile(current, tile), kTileBytes))
+        {
+            if (err) *err = "Cannot flush " + path + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+    // A punched hole is a metadata change, only a file sync makes it durable
+#ifdef __linux__
+    if (punched[current] && fdatasync(fd) != 0)
+#else
+    if (punched[current] && fsync(fd) != 0)
+#endif
+    {
+        if (err) *err = "Cannot flush " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    dirtyTiles[current].clear();
+    punched[current] = false;
+    WriteHeader();
+    if (!sync(base, sizeof(PagedHeader)))
+    {
+        if (err) *err = "Cannot flush " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    checkpointPlane = current;
+    return true;
+#else
+    if (err) *err = "Paged boards are not supported on this platform";
+    return false;
+#endif
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "PackedBoard.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Two-state torus too large for memory, e.g. 2^20 x 2^20 and mostly empty. Cells
+// are packed in tiles of kTileRows x kTileColumns, one 4 KiB page each, kept in a
+// memory-mapped sparse file that holds kPlanes generations side by side:
+//   page 0 header, then the tiles of plane 0, 1 and 2, row-major.
+// A tile that never held a live cell is a hole, costing neither disk nor RAM; a
+// tile that empties out has its hole punched again. A step reads only the live
+// tiles of one plane and writes only tiles that come out non-empty in another,
+// so the pages touched scale with the activity, not with the board.
+//
+// The header names the plane of the last checkpoint, and nothing writes to that
+// plane until a later checkpoint replaces it: steps alternate between the other
+// two, and an edit right after a checkpoint first copies the live tiles away.
+// Checkpoint() flushes the tiles written to the current plane since it was last
+// flushed, then the header, so whenever the process dies Resume() finds the last
+// checkpoint whole. Resume() also checks the plane against the population and tile
+// count the header recorded.
+class PagedBoard
+{
+public:
+    static constexpr int kTileRows = 128;
+    static constexpr int kTileWords = 4;
+    static constexpr int kTileColumns = kTileWords * 64;
+    static constexpr size_t kTileBytes = kTileRows * kTileWords * sizeof(uint64_t);
+    static constexpr int kPlanes = 3;
+
+    PagedBoard() = default;
+    ~PagedBoard();
+
+    PagedBoard(const PagedBoard&) = delete;
+    PagedBoard& operator=(const PagedBoard&) = delete;
+
+    // Creates (or truncates) path as an empty board; rows must be a multiple of
+    // kTileRows and columns of kTileColumns
+    bool Create(const std::string& path, long long rows, long long columns, std::string* err = nullptr);
+    // Reopens the last checkpoint of a board file
+    bool Resume(const std::string& path, std::string* err = nullptr);
+    void Close();
+    bool IsOpen() const { return base != nullptr; }
+
+    // Two-state Bx/Sy rules without B0, where empty tiles would not stay empty
+    bool SetRule(const std::array<bool, 9>& birth, const std::array<bool, 9>& survival, std::string* err = nullptr);
+
+    bool Get(long long row, long long column) const;
+    void Set(long long row, long long column, bool alive);
+    // Copies a board's live cells with its top-left at (top, left), wrapping around
+    void Paste(const PackedBoard& board, long long top, long long left);
+
+    void Step();
+    void Advance(long long generations);
+    bool Checkpoint(std::string* err = nullptr);
+
+    long long GetRows() const { return rows; }
+    long long GetColumns() const { return columns; }
+    long long GetGeneration() const { return generation; }
+    long long GetPopulation() const { return population; }
+    // Tiles holding live cells, the only ones in memory or on disk
+    size_t GetLiveTiles() const { return planeTiles[current].size(); }
+
+private:
+    uint64_t* Tile(int plane, uint64_t tile) const;
+    uint64_t TileAt(long long row, long long column) const;
+    uint64_t Neighbour(uint64_t tile, int rowOffset, int columnOffset) const;
+    // Next generation of one tile into out; returns its population
+    long long StepTile(uint64_t tile, uint64_t* out) const;
+    // Plane that is neither the current nor the checkpointed one
+    int ScratchPlane() const;
+    // Moves the current generation off the checkpointed plane before it is edited
+    void Detach();
+    // tiles become the non-empty tiles of plane, every other tile it held is released
+    void ReplacePlane(int plane, std::unordered_set<uint64_t>& tiles);
+    void Release(int plane, uint64_t tile);
+    // Non-empty tiles of a plane after Resume; returns their population
+    long long ScanPlane(int plane, std::unordered_set<uint64_t>& tiles) const;
+    bool Map(int fd, std::string* err);
+    void WriteHeader();
+
+    std::string path;
+    int fd = -1;
+    uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+
+    long long rows = 0;
+    long long columns = 0;
+    long long tileRows = 0;
+    long long tileColumns = 0;
+    long long generation = 0;
+    long long population = 0;
+    int current = 0;
+    int checkpointPlane = 0;
+    std::array<bool, 9> birth{};
+    std::array<bool, 9> survival{};
+
+    // Per plane: tiles that may hold cells (in the current plane exactly the live
+    // ones), tiles written since the plane was last flushed, and whether a hole was
+    // punched in it since
+    std::array<std::unordered_set<uint64_t>, kPlanes> planeTiles;
+    std::array<std::unordered_set<uint64_t>, kPlanes> dirtyTiles;
+    std::array<bool, kPlanes> punched{};
+};
@@ -0,0 +1,267 @@
+#include "PatternSearch.h"
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+namespace
+{
+    struct Check
+    {
+        int row;
+        int shift;
+        // All ones for dead cells, so one XOR turns the board word into "cell is dead"
+        uint64_t invert;
+    };
+
+    struct Variant
+    {
+        int orientation;
+        int rows;
+        std::vector<Check> checks;
+    };
+
+    // Anchor words tested together; short enough to stop early, long enough to vectorise
+    constexpr int kBlockWords = 8;
+
+    // Row followed by its first 64 cells again, so windows near the end wrap around the torus
+    void ExtendRow(const PackedBoard& board, int row, uint64_t* out, int extendedWords)
+    {
+        const int columns = board.GetColumns();
+        const int wordsPerRow = board.GetWordsPerRow();
+        const uint64_t* words = board.Row(row);
+        std::copy(words, words + wordsPerRow, out);
+        std::fill(out + wordsPerRow, out + extendedWords, 0);
+        out[wordsPerRow - 1] &= board.GetLastWordMask();
+        if (columns >= 64)
+        {
+            const int word = columns / 64;
+            const int shift = columns % 64;
+            out[word] |= words[0] << shift;
+            if (shift != 0) out[word + 1] |= words[0] >> (64 - shift);
+            return;
+        }
+        // Narrow boards wrap more than once
+        for (int x = columns; x < columns + 64; x++)
+        {
+            int source = x % columns;
+            if ((words[0] >> source) & 1) out[x / 64] |= uint64_t{1} << (x % 64);
+        }
+    }
+
+    void SearchBand(const PackedBoard& board, const std::vector<Variant>& variants, int maxRows, int rowBegin,
+                    int rowEnd, std::vector<PatternMatch>& out)
+    {
+        const int rows = board.GetRows();
+        const int columns = board.GetColumns();
+        const int wordsPerRow = board.GetWordsPerRow();
+        // Whole blocks plus one word, so block reads never need a bounds check
+        const int blocks = (wordsPerRow + kBlockWords - 1) / kBlockWords;
+        const int extendedWords = std::max(blocks * kBlockWords, (columns + 64 + 63) / 64) + 1;
+
+        // Extended copies of the band plus the rows the tallest template reaches below it
+        const int bandRows = rowEnd - rowBegin + maxRows - 1;
+        std::vector<uint64_t> extended(static_cast<size_t>(bandRows) * extendedWords);
+        // Per extended row and block: some cell a window of the block can reach is alive
+        std::vector<uint8_t> blockLive(static_cast<size_t>(bandRows) * blocks);
+        for (int i = 0; i < bandRows; i++)
+        {
+            uint64_t* words = extended.data() + static_cast<size_t>(i) * extendedWords;
+            ExtendRow(board, (rowBegin + i) % rows, words, extendedWords);
+            for (int block = 0; block < blocks; block++)
+            {
+                uint64_t any = 0;
+                for (int w = block * kBlockWords; w <= (block + 1) * kBlockWords; w++) any |= words[w];
+                blockLive[static_cast<size_t>(i) * blocks + block] = any != 0;
+            }
+        }
+        // Templates with a live cell cannot match where all their rows are empty
+        bool needsLife = true;
+        for (const Variant& variant : variants)
+        {
+            needsLife = needsLife && !variant.checks.empty() && variant.checks[0].invert == 0;
+        }
+
+        const uint64_t lastMask = board.GetLastWordMask();
+        std::vector<uint8_t> skip(blocks, 0);
+        for (int row = rowBegin; row < rowEnd; row++)
+        {
+            const uint64_t* base = extended.data() + static_cast<size_t>(row - rowBegin) * extendedWords;
+            for (int block = 0; needsLife && block < blocks; block++)
+            {
+                bool any = false;
+                for (int i = 0; i < maxRows && !any; i++)
+                {
+                    any = blockLive[static_cast<size_t>(row - rowBegin + i) * blocks + block];
+                }
+                skip[block] = !any;
+            }
+            for (const Variant& variant : variants)
+            {
+                for (int block = 0; block < wordsPerRow; block += kBlockWords)
+                {
+                    if (skip[block / kBlockWords]) continue;
+                    const int words = std::min(kBlockWords, wordsPerRow - block);
+                    uint64_t candidates[kBlockWords];
+                    for (int i = 0; i < kBlockWords; i++) candidates[i] = ~uint64_t{0};
+                    if (block + words == wordsPerRow) candidates[words - 1] = lastMask;
+
+                    for (const Check& check : variant.checks)
+                    {
+                        // Cells at column + shift for 64 anchors per word; the double shift keeps shift 0 defined
+                        const uint64_t* cells = base + static_cast<size_t>(check.row) * extendedWords + block;
+                        const int shift = check.shift;
+                        uint64_t any = 0;
+                        for (int i = 0; i < kBlockWords; i++)
+                        {
+                            uint64_t window = (cells[i] >> shift) | ((cells[i + 1] << 1) << (63 - shift));
+                            candidates[i] &= window ^ check.invert;
+                            any |= candidates[i];
+                        }
+                        if (any == 0) break;
+                    }
+
+                    for (int i = 0; i < words; i++)
+                    {
+                        for (uint64_t bits = candidates[i]; bits != 0; bits &= bits - 1)
+                        {
+                            int column = (block + i) * 64 + std::countr_zero(bits);
+                            out.push_back(PatternMatch{row, column, variant.orientation});
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool Pattern::Parse(const std::string& text, Pattern& out, std::string* err)
+{
+    std::vector<std::string> lines(1);
+    for (char c : text)
+    {
+        if (c == '\n' || c == '/') lines.emplace_back();
+        else if (c != '\r' && c != ' ' && c != '\t') lines.back() += c;
+    }
+    while (!lines.empty() && lines.back().empty()) lines.pop_back();
+
+    size_t width = 0;
+    for (const auto& line : lines) width = std::max(width, line.size());
+    if (lines.empty() || width == 0 || lines.size() > 64 || width > 64)
+    {
+        if (err) *err = "Pattern must be between 1x1 and 64x64 cells";
+        return false;
+    }
+
+    Pattern pattern(static_cast<int>(lines.size()), static_cast<int>(width));
+    for (int row = 0; row < pattern.rows; row++)
+    {
+        for (int column = 0; column < static_cast<int>(lines[row].size()); column++)
+        {
+            char c = lines[row][column];
+            if (c == 'O' || c == 'o' || c == '*' || c == '1') pattern.Set(row, column, Alive);
+            else if (c == '?') pattern.Set(row, column, Any);
+            else if (c != '.' && c != '0')
+            {
+                if (err) *err = "Unexpected '" + std::string(1, c) + "' in pattern";
+                return false;
+            }
+        }
+    }
+    out = std::move(pattern);
+    return true;
+}
+
+Pattern Pattern::WithDeadBorder() const
+{
+    Pattern bordered(rows + 2, columns + 2);
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++) bordered.Set(row + 1, column + 1, Get(row, column));
+    }
+    return bordered;
+}
+
+Pattern Pattern::Oriented(int orientation) const
+{
+    const bool transpose = orientation & 4;
+    Pattern out(transpose ? columns : rows, transpose ? rows : columns);
+    for (int row = 0; row < out.rows; row++)
+    {
+        for (int column = 0; column < out.columns; column++)
+        {
+            int r = (orientation & 1) ? out.rows - 1 - row : row;
+            int c = (orientation & 2) ? out.columns - 1 - column : column;
+            out.Set(row, column, transpose ? Get(c, r) : Get(r, c));
+        }
+    }
+    return out;
+}
+
+std::vector<PatternMatch> FindPattern(const PackedBoard& board, const Pattern& pattern, uint8_t orientations,
+                                      int threads)
+{
+    std::vector<PatternMatch> matches;
+    if (board.GetRows() == 0 || board.GetColumns() == 0 || pattern.GetRows() == 0) return matches;
+
+    std::vector<Variant> variants;
+    std::vector<Pattern> seen;
+    int maxRows = 1;
+    for (int orientation = 0; orientation < 8; orientation++)
+    {
+        if (!(orientations & (1u << orientation))) continue;
+        Pattern oriented = pattern.Oriented(orientation);
+        if (std::find(seen.begin(), seen.end(), oriented) != seen.end()) continue;
+        seen.push_back(oriented);
+
+        Variant variant{orientation, oriented.GetRows(), {}};
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (int row = 0; row < oriented.GetRows(); row++)
+            {
+                for (int column = 0; column < oriented.GetColumns(); column++)
+                {
+                    Pattern::Cell cell = oriented.Get(row, column);
+                    if (cell == (pass == 0 ? Pattern::Alive : Pattern::Dead))
+                    {
+                        variant.checks.push_back(Check{row, column, pass == 0 ? 0 : ~uint64_t{0}});
+                    }
+                }
+            }
+        }
+        maxRows = std::max(maxRows, variant.rows);
+        variants.push_back(std::move(variant));
+    }
+    if (variants.empty()) return matches;
+
+    const int rows = board.GetRows();
+    int count = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+    // Bands shorter than this spend more time extending rows than searching
+    count = std::clamp(count, 1, std::max(1, rows / 32));
+
+    std::vector<std::vector<PatternMatch>> found(count);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < count; t++)
+    {
+        int rowBegin = static_cast<int>(static_cast<long long>(rows) * t / count);
+        int rowEnd = static_cast<int>(static_cast<long long>(rows) * (t + 1) / count);
+        if (t == count - 1)
+        {
+            SearchBand(board, variants, maxRows, rowBegin, rowEnd, found[t]);
+        }
+        else
+        {
+            workers.emplace_back(SearchBand, std::cref(board), std::cref(variants), maxRows, rowBegin, rowEnd,
+                                 std::ref(found[t]));
+        }
+    }
+    for (auto& worker : workers) worker.join();
+
+    for (auto& band : found) matches.insert(matches.end(), band.begin(), band.end());
+    std::sort(matches.begin(), matches.end(), [](const PatternMatch& a, const PatternMatch& b)
+    {
+        if (a.row != b.row) return a.row < b.row;
+        if (a.column != b.column) return a.column < b.column;
+        return a.orientation < b.orientation;
+    });
+    return matches;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "PackedBoard.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Template for FindPattern, at most 64 cells wide and high. Every cell is alive,
+// dead or don't-care; dead cells have to be dead on the board too, so a pattern
+// padded with a dead border only matches isolated objects.
+class Pattern
+{
+public:
+    enum Cell : uint8_t
+    {
+        Dead = 0,
+        Alive = 1,
+        Any = 2
+    };
+
+    Pattern() = default;
+    Pattern(int rows, int columns) : rows(rows), columns(columns), cells(static_cast<size_t>(rows) * columns, Dead) {}
+
+    // One line per row: 'O', '*' or '1' alive, '.' or '0' dead, '?' don't care.
+    // Rows are separated by newlines or '/', short rows are padded with dead cells.
+    static bool Parse(const std::string& text, Pattern& out, std::string* err = nullptr);
+
+    int GetRows() const { return rows; }
+    int GetColumns() const { return columns; }
+    Cell Get(int row, int column) const { return static_cast<Cell>(cells[static_cast<size_t>(row) * columns + column]); }
+    void Set(int row, int column, Cell cell) { cells[static_cast<size_t>(row) * columns + column] = cell; }
+
+    // Same pattern inside a ring of dead cells
+    Pattern WithDeadBorder() const;
+    // Symmetry 0..7: transpose if bit 2 is set, then mirror rows if bit 0, columns if bit 1
+    Pattern Oriented(int orientation) const;
+
+    bool operator==(const Pattern& other) const = default;
+
+private:
+    int rows = 0;
+    int columns = 0;
+    std::vector<uint8_t> cells;
+};
+
+// Bit i selects symmetry i of Pattern::Oriented
+constexpr uint8_t kIdentityOrientation = 1;
+constexpr uint8_t kAllOrientations = 0xff;
+
+struct PatternMatch
+{
+    // Top-left cell of the oriented template; matches may wrap around the torus
+    int row = 0;
+    int column = 0;
+    // Lowest symmetry index producing this template
+    int orientation = 0;
+
+    bool operator==(const PatternMatch& other) const = default;
+};
+
+// Finds every placement of pattern on the live cells (plane 0) of a toroidal
+// board. 64 anchor columns are tested at once: each template row is ANDed (alive
+// cells) or AND-NOTed (dead cells) as a shifted board word into a candidate mask,
+// alive cells first since they rule out most anchors. Symmetries that give the
+// same template are searched once. Row bands run on separate threads.
+// Results are sorted by row, column and orientation.
+std::vector<PatternMatch> FindPattern(const PackedBoard& board, const Pattern& pattern,
+                                      uint8_t orientations = kAllOrientations, int threads = 0);
@@ -0,0 +1,251 @@
+#include "RuleExplorer.h"
+#include "BitCount.h"
+#include "BitSlicedEngine.h"
+#include "Grid.h"
+#include "Simulation.h"
+#include <array>
+#include <bit>
+#include <unordered_map>
+
+namespace
+{
+    struct RuleState
+    {
+        std::array<bool, 9> birth{};
+        std::array<bool, 9> survival{};
+        // Hash of every board the rule produced -> first generation it appeared at;
+        // boards that collide get an entry each
+        std::unordered_multimap<uint64_t, long long> seen;
+    };
+
+    // Rules whose boards are identical this generation
+    struct Group
+    {
+        PackedBoard board;
+        uint64_t hash = 0;
+        std::vector<int> members;
+    };
+
+    inline uint64_t MixWord(uint64_t hash, uint64_t word)
+    {
+        hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+        return hash ^ (hash >> 32);
+    }
+
+    constexpr uint64_t kHashSeed = 0x9e3779b97f4a7c15ull;
+
+    uint64_t HashBoard(const PackedBoard& board)
+    {
+        uint64_t hash = kHashSeed;
+        for (uint64_t word : board.Words()) hash = MixWord(hash, word);
+        return hash;
+    }
+
+    // Count planes of every cell of board, counts[k] holding bit k
+    void BuildCounts(const PackedBoard& board, PackedBoard& west, PackedBoard& east, std::array<PackedBoard, 4>& counts)
+    {
+        BitSlicedEngine::ShiftRows(board, west, east);
+        const int rows = board.GetRows();
+        const int words = board.GetWordsPerRow();
+        for (int row = 0; row < rows; row++)
+        {
+            const int up = row == 0 ? rows - 1 : row - 1;
+            const int down = row == rows - 1 ? 0 : row + 1;
+            for (int i = 0; i < words; i++)
+            {
+                uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+                AddBit(west.Row(up)[i], s0, s1, s2, s3);
+                AddBit(board.Row(up)[i], s0, s1, s2, s3);
+                AddBit(east.Row(up)[i], s0, s1, s2, s3);
+                AddBit(west.Row(row)[i], s0, s1, s2, s3);
+                AddBit(east.Row(row)[i], s0, s1, s2, s3);
+                AddBit(west.Row(down)[i], s0, s1, s2, s3);
+                AddBit(board.Row(down)[i], s0, s1, s2, s3);
+                AddBit(east.Row(down)[i], s0, s1, s2, s3);
+                counts[0].Row(row)[i] = s0;
+                counts[1].Row(row)[i] = s1;
+                counts[2].Row(row)[i] = s2;
+                counts[3].Row(row)[i] = s3;
+            }
+        }
+    }
+
+    // Writes every word of next, so recycled boards need no clearing
+    void ApplyRule(const PackedBoard& board, const std::array<PackedBoard, 4>& counts, const RuleState& rule,
+                   PackedBoard& next, uint64_t& hash, long long& population)
+    {
+        const int words = board.GetWordsPerRow();
+        const uint64_t lastMask = board.GetLastWordMask();
+        hash = kHashSeed;
+        population = 0;
+        for (int row = 0; row < board.GetRows(); row++)
+        {
+            const uint64_t* live = board.Row(row);
+            const uint64_t* s0 = counts[0].Row(row);
+            const uint64_t* s1 = counts[1].Row(row);
+            const uint64_t* s2 = counts[2].Row(row);
+            const uint64_t* s3 = counts[3].Row(row);
+            uint64_t* out = next.Row(row);
+            for (int i = 0; i < words; i++)
+            {
+                const uint64_t inBoard = i == words - 1 ? lastMask : ~uint64_t{0};
+                const uint64_t stay = live[i] & RuleMask(rule.survival, s0[i], s1[i], s2[i], s3[i]);
+                const uint64_t born = ~live[i] & RuleMask(rule.birth, s0[i], s1[i], s2[i], s3[i]) & inBoard;
+                out[i] = stay | born;
+                hash = MixWord(hash, out[i]);
+                population += std::popcount(out[i]);
+            }
+        }
+    }
+
+    // Board of one rule after generations steps from the soup, to tell a repeat from a
+    // hash collision. Runs once per rule that settles, so it never costs more than the
+    // rule's own steps again.
+    PackedBoard Replay(const PackedBoard& soup, const RuleState& rule, long long generations, RuleExploreResult& out)
+    {
+        const int rows = soup.GetRows();
+        const int columns = soup.GetColumns();
+        PackedBoard board = soup;
+        PackedBoard next(rows, columns);
+        PackedBoard west(rows, columns);
+        PackedBoard east(rows, columns);
+        std::array<PackedBoard, 4> counts;
+        for (PackedBoard& plane : counts) plane = PackedBoard(rows, columns);
+        for (long long generation = 0; generation < generations; generation++)
+        {
+            uint64_t hash = 0;
+            long long population = 0;
+            BuildCounts(board, west, east, counts);
+            ApplyRule(board, counts, rule, next, hash, population);
+            out.countPasses++;
+            out.ruleSteps++;
+            std::swap(board, next);
+        }
+        return board;
+    }
+}
+
+bool ExploreRules(const std::vector<std::string>& rules, const RuleExploreOptions& options, RuleExploreResult& out,
+                  std::string* err)
+{
+    out = RuleExploreResult{};
+    if (options.rows <= 0 || options.columns <= 0)
+    {
+        if (err) *err = "Board must have at least one row and column";
+        return false;
+    }
+
+    std::vector<RuleState> states(rules.size());
+    out.rules.resize(rules.size());
+    for (size_t i = 0; i < rules.size(); i++)
+    {
+        int stateCount = 2;
+        std::string error;
+        if (!Simulation::ParseRule(rules[i], states[i].birth, states[i].survival, stateCount, &error))
+        {
+            if (err) *err = "Rule " + rules[i] + ": " + error;
+            return false;
+        }
+        if (stateCount != 2)
+        {
+            if (err) *err = "Rule exploration takes two-state rules only: " + rules[i];
+            return false;
+        }
+        out.rules[i].rule = Simulation::FormatRule(states[i].birth, states[i].survival, 2);
+    }
+
+    const int rows = options.rows;
+    const int columns = options.columns;
+    Grid grid(columns, rows, 1);
+    grid.FillRandom(options.seed);
+
+    std::vector<Group> groups;
+    const PackedBoard start = PackedBoard::FromGrid(grid);
+    if (!rules.empty())
+    {
+        Group soup{start, 0, {}};
+        soup.hash = HashBoard(soup.board);
+        const long long population = static_cast<long long>(soup.board.Population());
+        for (size_t i = 0; i < rules.size(); i++)
+        {
+            soup.members.push_back(static_cast<int>(i));
+            states[i].seen.emplace(soup.hash, 0);
+            out.rules[i].finalPopulation = population;
+        }
+        groups.push_back(std::move(soup));
+    }
+
+    PackedBoard west(rows, columns);
+    PackedBoard east(rows, columns);
+    std::array<PackedBoard, 4> counts;
+    for (PackedBoard& plane : counts) plane = PackedBoard(rows, columns);
+    std::vector<Group> nextGroups;
+    std::unordered_multimap<uint64_t, size_t> groupByHash;
+    std::vector<PackedBoard> spare;
+
+    for (long long generation = 1; generation <= options.maxGenerations && !groups.empty(); generation++)
+    {
+        nextGroups.clear();
+        groupByHash.clear();
+        for (Group& group : groups)
+        {
+            BuildCounts(group.board, west, east, counts);
+            out.countPasses++;
+
+            for (int member : group.members)
+            {
+                PackedBoard next;
+                if (spare.empty()) next = PackedBoard(rows, columns);
+                else
+                {
+                    next = std::move(spare.back());
+                    spare.pop_back();
+                }
+                uint64_t hash = 0;
+                long long population = 0;
+                ApplyRule(group.board, counts, states[member], next, hash, population);
+                out.ruleSteps++;
+
+                RuleExploration& result = out.rules[member];
+                result.finalPopulation = population;
+                long long repeated = -1;
+                auto [seenFirst, seenLast] = states[member].seen.equal_range(hash);
+                for (auto it = seenFirst; it != seenLast && repeated < 0; ++it)
+                {
+                    if (Replay(start, states[member], it->second, out) == next) repeated = it->second;
+                }
+                if (repeated >= 0)
+                {
+                    // Board repeated: settled, stop stepping this rule
+                    result.stableGeneration = repeated;
+                    result.period = generation - repeated;
+                    spare.push_back(std::move(next));
+                    continue;
+                }
+                states[member].seen.emplace(hash, generation);
+
+                bool joined = false;
+                auto [first, last] = groupByHash.equal_range(hash);
+                for (auto it = first; it != last && !joined; ++it)
+                {
+                    Group& other = nextGroups[it->second];
+                    if (other.board == next)
+                    {
+                        other.members.push_back(member);
+                        joined = true;
+                    }
+                }
+                if (joined)
+                {
+                    spare.push_back(std::move(next));
+                    continue;
+                }
+                groupByHash.emplace(hash, nextGroups.size());
+                nextGroups.push_back(Group{std::move(next), hash, {member}});
+            }
+            spare.push_back(std::move(group.board));
+        }
+        std::swap(groups, nextGroups);
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "PackedBoard.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct RuleExploreOptions
+{
+    int rows = 120;
+    int columns = 192;
+    // Soup as Grid::FillRandom(seed) makes it, the same one Simulation::CreateRandomState(seed) gives
+    uint32_t seed = 1;
+    // Rules still changing after this many generations are reported as unsettled
+    long long maxGenerations = 1000;
+};
+
+struct RuleExploration
+{
+    std::string rule;
+    // Population when the rule settled, or at maxGenerations
+    long long finalPopulation = 0;
+    // First generation of the repeating cycle, -1 if none showed up within maxGenerations
+    long long stableGeneration = -1;
+    // 1 for still lifes and empty boards, 0 while unsettled
+    long long period = 0;
+};
+
+struct RuleExploreResult
+{
+    // In the order the rules were given
+    std::vector<RuleExploration> rules;
+    // Neighbour count passes made, against rule steps applied: the gap is the work shared
+    long long countPasses = 0;
+    long long ruleSteps = 0;
+};
+
+// Runs one soup under many two-state B/S rules at once. Rules whose boards are
+// still identical form a group; every generation the bit-sliced neighbour count
+// planes are built once per group and each rule in it only applies its birth and
+// survival masks to them. Boards are regrouped by hash after every generation, so
+// rules that behave alike on this soup (B3/S23 and B3/S236 on most soups, or rules
+// that all die out) keep sharing their counts.
+// A rule settles when its board repeats. Only 64-bit hashes of past boards are
+// kept; on a hash match the rule is replayed from the soup to the earlier
+// generation and the boards compared, so a collision cannot end a rule early.
+bool ExploreRules(const std::vector<std::string>& rules, const RuleExploreOptions& options, RuleExploreResult& out,
+                  std::string* err = nullptr);
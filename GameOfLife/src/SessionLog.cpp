@@ -0,0 +1,272 @@
+#include "SessionLog.h"
+#include "History.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    const char kMagic[4] = {'G', 'O', 'L', 'R'};
+    // Buffered bytes before a write to disk
+    constexpr size_t kFlushBytes = 64 * 1024;
+}
+
+SessionLog::~SessionLog()
+{
+    if (file)
+    {
+        Flush();
+        std::fclose(file);
+    }
+}
+
+bool SessionLog::Open(const std::string& path, std::string* err)
+{
+    if (file) Close(0);
+    file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        if (err) *err = "Cannot open file for writing: " + path;
+        return false;
+    }
+    buffer.clear();
+    buffer.reserve(kFlushBytes + 1024);
+    buffer.insert(buffer.end(), kMagic, kMagic + 4);
+    for (int shift = 0; shift < 32; shift += 8) buffer.push_back(static_cast<uint8_t>(kVersion >> shift));
+    eventCount = 0;
+    return true;
+}
+
+void SessionLog::Close(long long generation)
+{
+    if (!file) return;
+    Simple(SessionEventKind::End, generation);
+    Flush();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void SessionLog::Flush()
+{
+    if (!file || buffer.empty()) return;
+    std::fwrite(buffer.data(), 1, buffer.size(), file);
+    std::fflush(file);
+    buffer.clear();
+}
+
+void SessionLog::PutVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void SessionLog::PutString(const std::string& text)
+{
+    PutVarint(text.size());
+    buffer.insert(buffer.end(), text.begin(), text.end());
+}
+
+void SessionLog::Begin(SessionEventKind kind, long long generation)
+{
+    buffer.push_back(static_cast<uint8_t>(kind));
+    PutVarint(static_cast<uint64_t>(generation));
+    ++eventCount;
+}
+
+void SessionLog::Simple(SessionEventKind kind, long long generation)
+{
+    Begin(kind, generation);
+    if (buffer.size() >= kFlushBytes) Flush();
+}
+
+void SessionLog::SetCell(long long generation, int row, int column, int value)
+{
+    Begin(SessionEventKind::SetCell, generation);
+    PutVarint(static_cast<uint64_t>(row));
+    PutVarint(static_cast<uint64_t>(column));
+    PutVarint(static_cast<uint64_t>(value));
+    if (buffer.size() >= kFlushBytes) Flush();
+}
+
+void SessionLog::Random(long long generation, uint64_t seed)
+{
+    Begin(SessionEventKind::Random, generation);
+    PutVarint(seed);
+    if (buffer.size() >= kFlushBytes) Flush();
+}
+
+// Run state changes are rare and mark the stretches worth keeping if the process dies
+void SessionLog::Start(long long generation)
+{
+    Begin(SessionEventKind::Start, generation);
+    Flush();
+}
+
+void SessionLog::Stop(long long generation)
+{
+    Begin(SessionEventKind::Stop, generation);
+    Flush();
+}
+
+void SessionLog::Board(long long generation, long long boardGeneration, const PackedBoard& board, int states,
+                       const std::string& rule, const std::string& universeName)
+{
+    Begin(SessionEventKind::Board, generation);
+    PutVarint(static_cast<uint64_t>(boardGeneration));
+    PutVarint(static_cast<uint64_t>(board.GetRows()));
+    PutVarint(static_cast<uint64_t>(board.GetColumns()));
+    PutVarint(static_cast<uint64_t>(states));
+    PutString(rule);
+    PutString(universeName);
+    History::Encode(board.Words(), scratch);
+    PutVarint(scratch.size());
+    buffer.insert(buffer.end(), scratch.begin(), scratch.end());
+    Flush();
+}
+
+void SessionLog::Rule(long long generation, const std::string& rule)
+{
+    Begin(SessionEventKind::Rule, generation);
+    PutString(rule);
+    if (buffer.size() >= kFlushBytes) Flush();
+}
+
+void SessionLog::Seek(long long generation, long long target)
+{
+    Begin(SessionEventKind::Seek, generation);
+    PutVarint(static_cast<uint64_t>(target));
+    if (buffer.size() >= kFlushBytes) Flush();
+}
+
+void SessionLog::Resize(long long generation, int rows, int columns)
+{
+    Begin(SessionEventKind::Resize, generation);
+    PutVarint(static_cast<uint64_t>(rows));
+    PutVarint(static_cast<uint64_t>(columns));
+    if (buffer.size() >= kFlushBytes) Flush();
+}
+
+void SessionLog::HistoryBudget(long long generation, size_t budgetMB, int keyframeInterval)
+{
+    Begin(SessionEventKind::History, generation);
+    PutVarint(budgetMB);
+    PutVarint(static_cast<uint64_t>(keyframeInterval));
+    if (buffer.size() >= kFlushBytes) Flush();
+}
+
+bool SessionLogReader::Open(const std::string& path, std::string* err)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        if (err) *err = "Cannot open file: " + path;
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    error.clear();
+    at = 8;
+    uint32_t version = 0;
+    for (size_t i = 4; i < 8 && i < data.size(); i++) version |= static_cast<uint32_t>(data[i]) << (8 * (i - 4));
+    if (data.size() < 8 || std::memcmp(data.data(), kMagic, 4) != 0 || version != SessionLog::kVersion)
+    {
+        if (err) *err = "Not a session log: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool SessionLogReader::Fail(const std::string& message)
+{
+    error = message;
+    at = data.size();
+    return false;
+}
+
+bool SessionLogReader::GetVarint(uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && at < data.size(); shift += 7)
+    {
+        uint8_t byte = data[at++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool SessionLogReader::GetString(std::string& text)
+{
+    uint64_t length = 0;
+    if (!GetVarint(length) || length > data.size() - at) return false;
+    text.assign(data.begin() + static_cast<std::ptrdiff_t>(at), data.begin() + static_cast<std::ptrdiff_t>(at + length));
+    at += length;
+    return true;
+}
+
+bool SessionLogReader::Next(SessionEvent& event)
+{
+    if (at >= data.size()) return false;
+    const size_t start = at;
+    uint8_t kind = data[at++];
+    if (kind < static_cast<uint8_t>(SessionEventKind::SetCell) || kind > static_cast<uint8_t>(SessionEventKind::End))
+    {
+        return Fail("Unknown event at byte " + std::to_string(start));
+    }
+    event = SessionEvent{};
+    event.kind = static_cast<SessionEventKind>(kind);
+
+    uint64_t generation = 0;
+    uint64_t a = 0;
+    uint64_t b = 0;
+    uint64_t c = 0;
+    bool ok = GetVarint(generation);
+    event.generation = static_cast<long long>(generation);
+    switch (event.kind)
+    {
+    case SessionEventKind::SetCell:
+        ok = ok && GetVarint(a) && GetVarint(b) && GetVarint(c);
+        event.row = static_cast<int>(a);
+        event.column = static_cast<int>(b);
+        event.value = static_cast<int>(c);
+        break;
+    case SessionEventKind::Random:
+    case SessionEventKind::Seek:
+        ok = ok && GetVarint(event.number);
+        break;
+    case SessionEventKind::Rule:
+        ok = ok && GetString(event.text);
+        break;
+    case SessionEventKind::Resize:
+        ok = ok && GetVarint(a) && GetVarint(b) && a > 0 && b > 0 && a <= (1u << 20) && b <= (1u << 20);
+        event.row = static_cast<int>(a);
+        event.column = static_cast<int>(b);
+        break;
+    case SessionEventKind::History:
+        ok = ok && GetVarint(event.number) && GetVarint(a);
+        event.value = static_cast<int>(a);
+        break;
+    case SessionEventKind::Board:
+    {
+        ok = ok && GetVarint(event.number) && GetVarint(a) && GetVarint(b) && GetVarint(c) && a > 0 && b > 0 && a <= (1u << 20) &&
+            b <= (1u << 20) && c >= 2 && c <= 256 && GetString(event.text) && GetString(event.universeName);
+        uint64_t size = 0;
+        ok = ok && GetVarint(size) && size <= data.size() - at;
+        if (ok)
+        {
+            event.states = static_cast<int>(c);
+            event.board = PackedBoard(static_cast<int>(a), static_cast<int>(b), PlanesForStates(event.states));
+            ok = History::DecodeXor(data.data() + at, size, event.board.Words());
+            at += size;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    if (!ok) return Fail("Truncated or damaged event at byte " + std::to_string(start));
+    return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "PackedBoard.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+enum class SessionEventKind : uint8_t
+{
+    SetCell = 1, // row, column, value
+    Clear,
+    Random,      // seed
+    Start,
+    Stop,
+    Board,       // whole board with rule and universe name: session start and loads
+    Rule,        // rule text
+    Seek,        // target generation, restored from history
+    Resize,      // rows, columns
+    History,     // budget in MB (0 disables), keyframe interval
+    End
+};
+
+struct SessionEvent
+{
+    SessionEventKind kind = SessionEventKind::End;
+    // Generation the event happened at
+    long long generation = 0;
+    int row = 0;
+    int column = 0;
+    int value = 0;
+    uint64_t number = 0; // seed, seek target, history budget or the generation a board is at
+    std::string text;    // rule of Rule and Board events
+    std::string universeName;
+    int states = 2;
+    PackedBoard board;
+};
+
+// Append-only binary log of everything that changes a session besides stepping.
+// Events are a kind byte, the generation and their fields as varints; boards use
+// History's zero-run codec. Appending only writes into a memory buffer, which goes
+// to disk when it fills, on Start/Stop and on Close.
+//   file: "GOLR" u32 version, events...
+class SessionLog
+{
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    SessionLog() = default;
+    ~SessionLog();
+
+    SessionLog(const SessionLog&) = delete;
+    SessionLog& operator=(const SessionLog&) = delete;
+
+    bool Open(const std::string& path, std::string* err = nullptr);
+    // Writes an End event and closes the file
+    void Close(long long generation);
+    bool IsOpen() const { return file != nullptr; }
+    void Flush();
+
+    void SetCell(long long generation, int row, int column, int value);
+    void Clear(long long generation) { Simple(SessionEventKind::Clear, generation); }
+    void Random(long long generation, uint64_t seed);
+    void Start(long long generation);
+    void Stop(long long generation);
+    void Board(long long generation, long long boardGeneration, const PackedBoard& board, int states,
+               const std::string& rule, const std::string& universeName);
+    void Rule(long long generation, const std::string& rule);
+    void Seek(long long generation, long long target);
+    void Resize(long long generation, int rows, int columns);
+    void HistoryBudget(long long generation, size_t budgetMB, int keyframeInterval);
+
+    long long GetEventCount() const { return eventCount; }
+
+private:
+    void Simple(SessionEventKind kind, long long generation);
+    void Begin(SessionEventKind kind, long long generation);
+    void PutVarint(uint64_t value);
+    void PutString(const std::string& text);
+
+    std::FILE* file = nullptr;
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> scratch;
+    long long eventCount = 0;
+};
+
+// Reads a log written by SessionLog, one event at a time
+class SessionLogReader
+{
+public:
+    bool Open(const std::string& path, std::string* err = nullptr);
+    // false at the end of the log; GetError() tells a damaged log from a finished one
+    bool Next(SessionEvent& event);
+    const std::string& GetError() const { return error; }
+
+private:
+    bool GetVarint(uint64_t& value);
+    bool GetString(std::string& text);
+    bool Fail(const std::string& message);
+
+    std::vector<uint8_t> data;
+    size_t at = 0;
+    std::string error;
+};
@@ -5,11 +5,15 @@
 #include <string>
 #include <algorithm>
 #include <cctype>
-#include <unordered_set>
+#include <cstdint>
+#include <bit>
+#include <cstring>
+#include <random>
 
 Simulation::Simulation(int width, int height, int cellSize)
-    : grid(width, height, cellSize),
-      tempGrid(width, height, cellSize),
+    : arena(2 * Grid::ArenaBytes(height / cellSize, width / cellSize)),
+      grid(width, height, cellSize, &arena),
+      tempGrid(width, height, cellSize, &arena),
       running(false)
 {
     birth.fill(false);
@@ -24,33 +28,344 @@ void Simulation::Draw() const
     grid.Draw();
 }
 
+void Simulation::Start()
+{
+    running = true;
+    if (sessionLog.IsOpen()) sessionLog.Start(generation);
+}
+
+void Simulation::Stop()
+{
+    running = false;
+    if (sessionLog.IsOpen()) sessionLog.Stop(generation);
+}
+
 void Simulation::Update()
 {
+    ApplyEdits();
     if (!running) return;
     Step();
 }
 
+// Auto switches to the sparse engine below 1/64 live cells and back above 1/16
+static constexpr long long kSparseEnterDivisor = 64;
+static constexpr long long kSparseLeaveDivisor = 16;
+
+StepEngine Simulation::ChooseEngine() const
+{
+    // Range rules have their own whole-board engine, Dense keeps the per-cell reference
+    if (rangeRule) return stepEngine == StepEngine::Dense ? StepEngine::Dense : StepEngine::LargerThanLife;
+    // Dying states change without any neighbour activity, only whole-board engines handle them
+    if (states > 2) return stepEngine == StepEngine::Dense ? StepEngine::Dense : StepEngine::BitSliced;
+    if (stepEngine == StepEngine::Dense || stepEngine == StepEngine::BitSliced ||
+        stepEngine == StepEngine::BlockLookup || stepEngine == StepEngine::Tiled)
+    {
+        return stepEngine;
+    }
+    // With B0 every empty region is born, there is nothing sparse about it
+    if (birth[0]) return StepEngine::Dense;
+    if (stepEngine != StepEngine::Auto) return stepEngine;
+
+    long long area = static_cast<long long>(grid.GetRows()) * grid.GetColumns();
+    long long divisor = activeEngine == StepEngine::Sparse ? kSparseLeaveDivisor : kSparseEnterDivisor;
+    return population * divisor < area ? StepEngine::Sparse : StepEngine::Dense;
+}
+
 void Simulation::Step()
 {
+    ApplyEdits();
+    if (historyDirty) RecordHistory();
+
+    activeEngine = ChooseEngine();
+    if (activeEngine == StepEngine::Sparse)
+    {
+        if (!sparse.IsValid()) sparse.Rebuild(grid);
+        sparse.Step(grid, birth, survival);
+        population = static_cast<long long>(sparse.GetPopulation());
+        if (grid.HasAges()) grid.AdvanceAges(sparse.GetLiveCells());
+    }
+    else if (activeEngine == StepEngine::BitSliced)
+    {
+        if (!bitSliced.IsValid()) bitSliced.Rebuild(grid, states);
+        bitSliced.Step(grid, birth, survival);
+        population = bitSliced.GetPopulation();
+        if (grid.HasAges()) grid.AdvanceAges();
+    }
+    else if (activeEngine == StepEngine::BlockLookup)
+    {
+        if (!blockLookup.IsValid()) blockLookup.Rebuild(grid);
+        blockLookup.Step(grid, birth, survival);
+        population = blockLookup.GetPopulation();
+        if (grid.HasAges()) grid.AdvanceAges();
+    }
+    else if (activeEngine == StepEngine::Tiled)
+    {
+        tiled.Advance(grid, birth, survival, 1);
+        population = tiled.GetPopulation();
+        if (grid.HasAges()) grid.AdvanceAges();
+    }
+    else if (activeEngine == StepEngine::LargerThanLife)
+    {
+        rangeEngine.Step(grid, *rangeRule);
+        population = rangeEngine.GetPopulation();
+        if (grid.HasAges()) grid.AdvanceAges();
+    }
+    else
+    {
+        StepDense();
+    }
+    // Engines that did not step no longer mirror the grid
+    if (activeEngine != StepEngine::Sparse) sparse.Invalidate();
+    if (activeEngine != StepEngine::BitSliced) bitSliced.Invalidate();
+    if (activeEngine != StepEngine::BlockLookup) blockLookup.Invalidate();
+    if (activeEngine != StepEngine::Tiled) tiled.Invalidate();
+    ++generation;
+    ++boardRevision;
+
+    if (statsEnabled) UpdateStats();
+    if (history.IsEnabled()) RecordHistory();
+    if (changeStream.IsOpen()) PublishChanges();
+    if (recorder.WantsGeneration(generation)) RecordFrame();
+}
+
+void Simulation::Advance(long long generations)
+{
+    ApplyEdits();
+    // Ages, history, the change stream, recordings and stats need every intermediate generation
+    if (generations > 1 && ChooseEngine() == StepEngine::Tiled && !grid.HasAges() && !history.IsEnabled() &&
+        !changeStream.IsOpen() && !recorder.IsOpen() && !statsEnabled)
+    {
+        activeEngine = StepEngine::Tiled;
+        sparse.Invalidate();
+        bitSliced.Invalidate();
+        blockLookup.Invalidate();
+        tiled.Advance(grid, birth, survival, generations);
+        population = tiled.GetPopulation();
+        generation += generations;
+        ++boardRevision;
+        return;
+    }
+    for (long long i = 0; i < generations; ++i) Step();
+}
+
+void Simulation::StepDense()
+{
+    population = 0;
     for (int row = 0; row < grid.GetRows(); row++)
     {
         for (int column = 0; column < grid.GetColumns(); column++)
         {
-            int liveNeighbors = CountLiveNeighbors(row, column);
-            int cellValue = grid.GetCellValue(row, column);
+            int cellValue = grid.Get(row, column);
+            int nextValue;
 
-            if (cellValue == 1)
+            if (rangeRule)
+            {
+                int count = CountRangeNeighbors(row, column);
+                if (cellValue == 1) nextValue = rangeRule->Survives(count) ? 1 : (states > 2 ? 2 : 0);
+                else if (cellValue == 0) nextValue = rangeRule->Born(count) ? 1 : 0;
+                else nextValue = cellValue + 1 < states ? cellValue + 1 : 0;
+            }
+            else if (cellValue == 1)
             {
-                tempGrid.SetCellValue(row, column, survival[liveNeighbors] ? 1 : 0);
+                // With Generations rules a cell that does not survive starts dying
+                nextValue = survival[CountLiveNeighbors(row, column)] ? 1 : (states > 2 ? 2 : 0);
+            }
+            else if (cellValue == 0)
+            {
+                nextValue = birth[CountLiveNeighbors(row, column)] ? 1 : 0;
             }
             else
             {
-                tempGrid.SetCellValue(row, column, birth[liveNeighbors] ? 1 : 0);
+                nextValue = cellValue + 1 < states ? cellValue + 1 : 0;
+            }
+            tempGrid.Set(row, column, nextValue);
+            population += nextValue != 0;
+        }
+    }
+
+    grid.SwapCells(tempGrid);
+    if (grid.HasAges()) grid.AdvanceAges();
+}
+
+// Called after the whole board was rewritten outside of Step
+void Simulation::OnBoardReplaced()
+{
+    ++boardRevision;
+    sparse.Invalidate();
+    bitSliced.Invalidate();
+    blockLookup.Invalidate();
+    tiled.Invalidate();
+    population = 0;
+    for (int row = 0; row < grid.GetRows(); row++)
+    {
+        for (int column = 0; column < grid.GetColumns(); column++)
+        {
+            population += grid.Get(row, column) != 0;
+        }
+    }
+    if (statsEnabled) statsTracker.Reset(grid, generation);
+}
+
+void Simulation::EnableStats(bool enabled)
+{
+    if (enabled && !statsEnabled) statsTracker.Reset(grid, generation);
+    statsEnabled = enabled;
+}
+
+void Simulation::SetStatsCallback(std::function<void(const BoardStats&)> callback)
+{
+    statsCallback = std::move(callback);
+    if (statsCallback) EnableStats(true);
+}
+
+// The bit-sliced engine's planes are already packed; the sparse, block and tiled engines
+// say which words they changed, so only those are repacked. Dense and range steps
+// repack the whole byte grid.
+void Simulation::UpdateStats()
+{
+    if (activeEngine == StepEngine::BitSliced && bitSliced.IsValid())
+    {
+        statsTracker.Advance(bitSliced.GetBoard(), generation);
+    }
+    else if (!statsTracker.Matches(grid) ||
+             (activeEngine != StepEngine::Sparse && activeEngine != StepEngine::BlockLookup &&
+              activeEngine != StepEngine::Tiled))
+    {
+        statsTracker.Advance(grid, generation);
+    }
+    else
+    {
+        statsTracker.BeginStep();
+        if (activeEngine == StepEngine::Sparse)
+        {
+            // Neighbouring changes often follow each other and share a word
+            size_t lastWord = SIZE_MAX;
+            for (size_t cell : sparse.GetChanges())
+            {
+                const int row = static_cast<int>(cell / grid.GetColumns());
+                const int word = static_cast<int>(cell % grid.GetColumns()) / 64;
+                const size_t key = static_cast<size_t>(row) * grid.GetColumns() + word;
+                if (key == lastWord) continue;
+                lastWord = key;
+                statsTracker.RepackWord(grid, row, word);
             }
         }
+        else if (activeEngine == StepEngine::BlockLookup)
+        {
+            for (const BlockLookupEngine::ChangedWord& changed : blockLookup.GetChangedWords())
+            {
+                statsTracker.UpdateWord(changed.row, changed.word, changed.cells);
+            }
+        }
+        else
+        {
+            for (int tile : tiled.GetChangedTiles())
+            {
+                int rowBegin, rowEnd, columnBegin, columnEnd;
+                tiled.GetTileBounds(tile, rowBegin, rowEnd, columnBegin, columnEnd);
+                for (int row = rowBegin; row < rowEnd; row++)
+                {
+                    for (int word = columnBegin / 64; word <= (columnEnd - 1) / 64; word++)
+                    {
+                        statsTracker.RepackWord(grid, row, word);
+                    }
+                }
+            }
+        }
+        statsTracker.EndStep(generation);
     }
+    if (statsCallback) statsCallback(statsTracker.Get());
+}
 
-    grid = tempGrid;
+void Simulation::RecordHistory()
+{
+    history.Record(generation, PackedBoard::FromGrid(grid, PlanesForStates(states)));
+    historyDirty = false;
+}
+
+bool Simulation::StartChangeStream(const std::string& path, StreamTransport transport, std::string* err)
+{
+    if (!changeStream.Open(path, transport, err)) return false;
+    PublishChanges();
+    return true;
+}
+
+const PackedBoard* Simulation::FindPackedCells() const
+{
+    // The bit-sliced engine already holds the packed board
+    if (activeEngine == StepEngine::BitSliced && bitSliced.IsValid()) return &bitSliced.GetBoard();
+    if (packedCells && packedRevision == boardRevision && packedCells->GetPlanes() == PlanesForStates(states) &&
+        packedCells->GetRows() == grid.GetRows() && packedCells->GetColumns() == grid.GetColumns())
+    {
+        return packedCells.get();
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const PackedBoard> Simulation::SharePackedCells() const
+{
+    if (activeEngine == StepEngine::BitSliced && bitSliced.IsValid()) return bitSliced.ShareBoard();
+    if (FindPackedCells()) return packedCells;
+    // Repacked in place unless a snapshot still holds the old revision
+    if (!IsSoleOwner(packedCells)) packedCells = std::make_shared<PackedBoard>();
+    packedCells->Assign(grid, PlanesForStates(states));
+    packedRevision = boardRevision;
+    return packedCells;
+}
+
+void Simulation::PublishChanges()
+{
+    // Packed straight into the writer's spare buffer unless a packed board is already at hand
+    changeStream.Publish(generation, [this](PackedBoard& board)
+    {
+        if (const PackedBoard* packed = FindPackedCells()) board = *packed;
+        else board.Assign(grid, PlanesForStates(states));
+    });
+}
+
+bool Simulation::StartRecording(const RecordOptions& options, std::string* err)
+{
+    if (!recorder.Open(options, err)) return false;
+    if (recorder.WantsGeneration(generation)) RecordFrame();
+    return true;
+}
+
+void Simulation::RecordFrame()
+{
+    recorder.Submit(generation, PackCells(), states);
+}
+
+void Simulation::EnableHistory(size_t budgetMB, int keyframeInterval)
+{
+    history.Enable(budgetMB, keyframeInterval);
+    RecordHistory();
+    if (sessionLog.IsOpen()) sessionLog.HistoryBudget(generation, history.GetBudgetMB(), keyframeInterval);
+}
+
+void Simulation::DisableHistory()
+{
+    history.Disable();
+    historyDirty = false;
+    if (sessionLog.IsOpen()) sessionLog.HistoryBudget(generation, 0, 0);
+}
+
+bool Simulation::StepBack()
+{
+    return SeekTo(generation - 1);
+}
+
+bool Simulation::SeekTo(long long targetGeneration)
+{
+    if (historyDirty) RecordHistory();
+
+    PackedBoard board;
+    if (!history.Restore(targetGeneration, board)) return false;
+    if (sessionLog.IsOpen()) sessionLog.Seek(generation, targetGeneration);
+
+    board.ToGrid(grid);
+    generation = targetGeneration;
+    OnBoardReplaced();
+    return true;
 }
 
 int Simulation::CountLiveNeighbors(int row, int column) const
@@ -68,25 +383,151 @@ int Simulation::CountLiveNeighbors(int row, int column) const
     {
         int neighborRow = (row + offset.first + grid.GetRows()) % grid.GetRows();
         int neighborColumn = (column + offset.second + grid.GetColumns()) % grid.GetColumns();
-        liveNeighbors += grid.GetCellValue(neighborRow, neighborColumn);
+        // Only state 1 is alive, dying states of Generations rules do not count
+        liveNeighbors += grid.Get(neighborRow, neighborColumn) == 1;
     }
 
     return liveNeighbors;
 }
 
+// Direct count over the range-R neighbourhood, the reference for LargerThanLifeEngine
+int Simulation::CountRangeNeighbors(int row, int column) const
+{
+    const int range = rangeRule->range;
+    const int rows = grid.GetRows();
+    const int columns = grid.GetColumns();
+    int liveNeighbors = 0;
+    for (int dy = -range; dy <= range; dy++)
+    {
+        int span = rangeRule->vonNeumann ? range - std::abs(dy) : range;
+        int neighborRow = ((row + dy) % rows + rows) % rows;
+        for (int dx = -span; dx <= span; dx++)
+        {
+            if (dy == 0 && dx == 0 && !rangeRule->countMiddle) continue;
+            int neighborColumn = ((column + dx) % columns + columns) % columns;
+            liveNeighbors += grid.Get(neighborRow, neighborColumn) == 1;
+        }
+    }
+    return liveNeighbors;
+}
+
 void Simulation::ClearGrid()
 {
     grid.Clear();
+    sparse.Invalidate();
+    bitSliced.Invalidate();
+    blockLookup.Invalidate();
+    tiled.Invalidate();
+    population = 0;
+    ++boardRevision;
+    historyDirty = history.IsEnabled();
+    if (statsEnabled) statsTracker.Reset(grid, generation);
+    if (sessionLog.IsOpen()) sessionLog.Clear(generation);
+}
+
+void Simulation::ResizeBoard(int rows, int columns)
+{
+    // Shrinking keeps the region, growing replaces it; either way the heap is not involved
+    if (sessionLog.IsOpen()) sessionLog.Resize(generation, rows, columns);
+    arena.Reset(2 * Grid::ArenaBytes(rows, columns));
+    grid.Resize(rows, columns);
+    tempGrid.Resize(rows, columns);
+    history.Reset();
+    OnBoardReplaced();
+    if (history.IsEnabled()) RecordHistory();
 }
 
 void Simulation::CreateRandomState()
 {
-    grid.FillRandom();
+    std::random_device device;
+    CreateRandomState(device());
+}
+
+void Simulation::CreateRandomState(uint32_t seed)
+{
+    grid.FillRandom(seed);
+    OnBoardReplaced();
+    historyDirty = history.IsEnabled();
+    if (sessionLog.IsOpen()) sessionLog.Random(generation, seed);
 }
 
 void Simulation::ToggleCell(int row, int column)
 {
-    grid.ToggleCell(row, column);
+    if (!grid.IsWithinBounds(row, column)) return;
+    SetCellValue(row, column, grid.GetCellValue(row, column) ? 0 : 1);
+}
+
+void Simulation::SetCellValue(int row, int column, int value)
+{
+    if (!grid.IsWithinBounds(row, column)) return;
+    int previous = grid.GetCellValue(row, column);
+    if (previous == value) return;
+    grid.SetCellValue(row, column, value);
+    OnCellChanged(row, column, previous != 0, value);
+}
+
+void Simulation::OnCellChanged(int row, int column, bool wasSet, int value)
+{
+    ++boardRevision;
+    population += (value != 0) - wasSet;
+    sparse.SetCell(row, column, value != 0);
+    bitSliced.SetCell(row, column, value);
+    blockLookup.SetCell(row, column, value != 0);
+    tiled.SetCell(row, column, value == 1);
+    if (statsEnabled) statsTracker.SetCell(row, column, value != 0);
+    historyDirty = history.IsEnabled();
+    if (sessionLog.IsOpen()) sessionLog.SetCell(generation, row, column, value);
+}
+
+// Batches up to this many changed cells keep the engines in step cell by cell;
+// larger ones let the engines rebuild from the grid
+static constexpr size_t kIncrementalEditCells = 4096;
+
+void Simulation::ApplyEdits()
+{
+    if (edits.IsEmpty()) return;
+    EditBuffer::Rasterize(edits.Take(), grid.GetRows(), grid.GetColumns(), PlanesForStates(states), editMask,
+                          editValues, editRows);
+
+    // Masked words are blended into the grid a 64-cell span at a time
+    editedSpans.clear();
+    size_t changedCells = 0;
+    uint8_t values[64];
+    for (int row = editRows.begin; row < editRows.end; row++)
+    {
+        const uint64_t* mask = editMask.Row(row);
+        for (int span = 0; span < editMask.GetWordsPerRow(); span++)
+        {
+            if (mask[span] == 0) continue;
+            std::fill(std::begin(values), std::end(values), uint8_t{0});
+            for (int plane = 0; plane < editValues.GetPlanes(); plane++)
+            {
+                const uint64_t bits = editValues.Row(row, plane)[span];
+                for (int i = 0; i < 64; i++) values[i] |= static_cast<uint8_t>(((bits >> i) & 1) << plane);
+            }
+            for (uint8_t& value : values) value = std::min<uint8_t>(value, static_cast<uint8_t>(states - 1));
+
+            uint64_t wasSet = 0;
+            const uint64_t changed = grid.BlendSpan(row, span, mask[span], values, wasSet);
+            if (changed == 0) continue;
+            editedSpans.push_back({row, span, changed, wasSet});
+            changedCells += static_cast<size_t>(std::popcount(changed));
+        }
+    }
+    if (changedCells > kIncrementalEditCells)
+    {
+        OnCellsLoaded();
+        return;
+    }
+    for (const EditedSpan& edited : editedSpans)
+    {
+        for (uint64_t bits = edited.changed; bits != 0; bits &= bits - 1)
+        {
+            const int bit = std::countr_zero(bits);
+            const int column = edited.span * 64 + bit;
+            OnCellChanged(edited.row, column, (edited.wasSet >> bit) & 1, grid.Get(edited.row, column));
+        }
+    }
 }
 
 int Simulation::GetCellValue(int row, int column) const
@@ -94,6 +535,189 @@ int Simulation::GetCellValue(int row, int column) const
     return grid.GetCellValue(row, column);
 }
 
+void Simulation::SetRule(const std::array<bool, 9>& birthRule, const std::array<bool, 9>& survivalRule,
+                         int stateCount)
+{
+    birth = birthRule;
+    survival = survivalRule;
+    rangeRule.reset();
+    ClampStates(stateCount);
+    if (sessionLog.IsOpen()) sessionLog.Rule(generation, GetRuleString());
+}
+
+void Simulation::SetRule(const LargerThanLifeRule& rule)
+{
+    rangeRule = rule;
+    ClampStates(rule.states);
+    if (sessionLog.IsOpen()) sessionLog.Rule(generation, GetRuleString());
+}
+
+void Simulation::ClampStates(int stateCount)
+{
+    if (stateCount < states)
+    {
+        // Dying states beyond the new count would never decay
+        for (int row = 0; row < grid.GetRows(); row++)
+        {
+            for (int column = 0; column < grid.GetColumns(); column++)
+            {
+                if (grid.Get(row, column) >= stateCount) grid.Set(row, column, 0);
+            }
+        }
+        OnBoardReplaced();
+    }
+    states = stateCount;
+    // Candidate cells were collected for the old rule
+    sparse.Invalidate();
+    bitSliced.Invalidate();
+    blockLookup.Invalidate();
+    tiled.Invalidate();
+}
+
+bool Simulation::SetRule(const std::string& rule, std::string* error)
+{
+    if (IsLargerThanLifeRule(rule))
+    {
+        LargerThanLifeRule parsed;
+        if (!ParseLargerThanLifeRule(rule, parsed, error)) return false;
+        SetRule(parsed);
+        return true;
+    }
+    std::array<bool, 9> birthRule{};
+    std::array<bool, 9> survivalRule{};
+    int stateCount = 2;
+    if (!ParseRule(rule, birthRule, survivalRule, stateCount, error)) return false;
+    SetRule(birthRule, survivalRule, stateCount);
+    return true;
+}
+
+bool Simulation::ParseStepEngine(const std::string& name, StepEngine& engine)
+{
+    if (name == "auto") engine = StepEngine::Auto;
+    else if (name == "dense") engine = StepEngine::Dense;
+    else if (name == "sparse") engine = StepEngine::Sparse;
+    else if (name == "bitsliced") engine = StepEngine::BitSliced;
+    else if (name == "block") engine = StepEngine::BlockLookup;
+    else if (name == "tiled") engine = StepEngine::Tiled;
+    else return false;
+    return true;
+}
+
+std::string Simulation::GetRuleString() const
+{
+    if (rangeRule) return FormatLargerThanLifeRule(*rangeRule);
+    return FormatRule(birth, survival, states);
+}
+
+// Accepts B3/S23, B3S23, S23/B3, Generations B2/S/C3 and the classic S/B/C digit form 23/3, 345/2/4
+bool Simulation::ParseRule(const std::string& text, std::array<bool, 9>& birthOut, std::array<bool, 9>& survivalOut,
+                           int& statesOut, std::string* error)
+{
+    std::string rule;
+    for (char c : text)
+    {
+        if (!std::isspace(static_cast<unsigned char>(c))) rule += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    // Split into (letter, digits) parts
+    std::vector<std::pair<char, std::string>> parts;
+    bool lettered = rule.find_first_of("BSCG") != std::string::npos;
+    if (lettered)
+    {
+        for (char c : rule)
+        {
+            if (c == 'B' || c == 'S' || c == 'C' || c == 'G') parts.push_back({c, ""});
+            else if (c == '/') continue;
+            else if (!parts.empty()) parts.back().second += c;
+            else
+            {
+                if (error) *error = "unexpected '" + std::string(1, c) + "'";
+                return false;
+            }
+        }
+    }
+    else
+    {
+        const char order[] = {'S', 'B', 'C'};
+        size_t start = 0;
+        for (int i = 0; start <= rule.size(); ++i)
+        {
+            size_t slash = rule.find('/', start);
+            if (i >= 3)
+            {
+                if (error) *error = "too many parts";
+                return false;
+            }
+            parts.push_back({order[i], rule.substr(start, slash == std::string::npos ? std::string::npos : slash - start)});
+            if (slash == std::string::npos) break;
+            start = slash + 1;
+        }
+    }
+
+    std::array<bool, 9> b{};
+    std::array<bool, 9> s{};
+    int c = 2;
+    bool hasB = false;
+    bool hasS = false;
+    bool hasC = false;
+    for (const auto& [letter, digits] : parts)
+    {
+        if (letter == 'C' || letter == 'G')
+        {
+            bool numeric = !digits.empty() && digits.size() <= 3 &&
+                std::all_of(digits.begin(), digits.end(), [](char d) { return d >= '0' && d <= '9'; });
+            c = numeric ? std::stoi(digits) : 0;
+            if (hasC || c < 2 || c > 256)
+            {
+                if (error) *error = "state count must be 2..256";
+                return false;
+            }
+            hasC = true;
+            continue;
+        }
+
+        bool& seen = letter == 'B' ? hasB : hasS;
+        std::array<bool, 9>& target = letter == 'B' ? b : s;
+        if (seen)
+        {
+            if (error) *error = "repeated " + std::string(1, letter) + " part";
+            return false;
+        }
+        seen = true;
+        for (char d : digits)
+        {
+            if (d < '0' || d > '8')
+            {
+                if (error) *error = "invalid digit '" + std::string(1, d) + "'";
+                return false;
+            }
+            target[d - '0'] = true;
+        }
+    }
+
+    if (!hasB || !hasS)
+    {
+        if (error) *error = "expected B and S parts";
+        return false;
+    }
+
+    birthOut = b;
+    survivalOut = s;
+    statesOut = c;
+    return true;
+}
+
+std::string Simulation::FormatRule(const std::array<bool, 9>& birthRule, const std::array<bool, 9>& survivalRule,
+                                   int stateCount)
+{
+    std::string rule = "B";
+    for (int i = 0; i <= 8; ++i) if (birthRule[i]) rule += static_cast<char>('0' + i);
+    rule += "/S";
+    for (int i = 0; i <= 8; ++i) if (survivalRule[i]) rule += static_cast<char>('0' + i);
+    if (stateCount > 2) rule += "/C" + std::to_string(stateCount);
+    return rule;
+}
+
 // Trim both ends (safe for empty/all-space strings)
 static std::string trim_copy(const std::string& s)
 {
@@ -107,6 +731,43 @@ static std::string trim_copy(const std::string& s)
 }
 
 bool Simulation::LoadFromLife106(const std::string& filePath, std::vector<std::string>& warnings)
+{
+    BoardSnapshot loaded;
+    if (!ParseLife106(filePath, grid.GetRows(), grid.GetColumns(), loaded, warnings))
+    {
+        return false;
+    }
+    ApplySnapshot(loaded);
+    return true;
+}
+
+bool Simulation::ParseLife106(const std::string& filePath, int rows, int columns, BoardSnapshot& out,
+                              std::vector<std::string>& warnings, const std::function<void(float)>& progress)
+{
+    PackedBoard cells(rows, columns);
+    auto setCell = [&](int row, int col)
+    {
+        if (cells.Get(row, col)) return false;
+        cells.Set(row, col, true);
+        return true;
+    };
+    if (!ReadLife106(filePath, rows, columns, out, setCell, warnings, progress))
+    {
+        return false;
+    }
+    out.cells = std::move(cells);
+
+    // Coordinates only describe live cells, dying states start empty
+    if (out.states > 2)
+    {
+        out.cells = out.cells.WithPlanes(PlanesForStates(out.states));
+    }
+    return true;
+}
+
+bool Simulation::ReadLife106(const std::string& filePath, int rows, int columns, BoardSnapshot& out,
+                             const std::function<bool(int, int)>& setCell, std::vector<std::string>& warnings,
+                             const std::function<void(float)>& progress)
 {
     std::ifstream in(filePath);
     if (!in.is_open())
@@ -115,29 +776,34 @@ bool Simulation::LoadFromLife106(const std::string& filePath, std::vector<std::s
         return false;
     }
 
-    universeName.clear();
+    in.seekg(0, std::ios::end);
+    const double fileSize = std::max<double>(static_cast<double>(in.tellg()), 1.0);
+    in.seekg(0, std::ios::beg);
+
+    out = BoardSnapshot{};
     bool hasName = false;
     bool hasRule = false;
 
-    birth.fill(false);
-    survival.fill(false);
-    birth[3] = true;
-    survival[2] = true;
-    survival[3] = true;
-
-    grid.Clear();
-    tempGrid = grid;
+    out.birth.fill(false);
+    out.survival.fill(false);
+    out.birth[3] = true;
+    out.survival[2] = true;
+    out.survival[3] = true;
+    out.states = 2;
 
     std::string line;
     int lineNo = 0;
     bool headerChecked = false;
-    std::unordered_set<long long> placed;
-    int centerRow = grid.GetRows() / 2;
-    int centerCol = grid.GetColumns() / 2;
+    int centerRow = rows / 2;
+    int centerCol = columns / 2;
 
     while (std::getline(in, line))
     {
         ++lineNo;
+        if (progress && (lineNo & 0xffff) == 0)
+        {
+            progress(static_cast<float>(static_cast<double>(in.tellg()) / fileSize));
+        }
         std::string t = trim_copy(line);
         if (t.empty()) continue;
 
@@ -149,6 +815,10 @@ bool Simulation::LoadFromLife106(const std::string& filePath, std::vector<std::s
                 warnings.push_back(
                     "Missing or invalid header 'Life 1.06' at line " + std::to_string(lineNo) + "; found: '" + t + "'");
             }
+            else
+            {
+                continue;
+            }
         }
 
         if (!t.empty() && t[0] == '#')
@@ -158,60 +828,38 @@ bool Simulation::LoadFromLife106(const std::string& filePath, std::vector<std::s
             {
                 // #N <name>
                 std::string name = t.size() > 2 ? trim_copy(t.substr(2)) : std::string();
-                universeName = name;
+                out.universeName = name;
                 hasName = true;
             }
             else if (t.size() >= 2 && (t[1] == 'R' || t[1] == 'r'))
             {
-                // #R Bx/Sy
+                // #R Bx/Sy, Bx/Sy/Cn or a Larger-than-Life rule
                 std::string rest = t.size() > 2 ? trim_copy(t.substr(2)) : std::string();
-                rest.erase(std::remove_if(rest.begin(), rest.end(), ::isspace), rest.end());
-                // Expect format with B
-                size_t posB = rest.find_first_of("Bb");
-                size_t posS = rest.find_first_of("Ss");
-                if (posB == std::string::npos || posS == std::string::npos)
+                std::string error;
+                bool parsed;
+                if (IsLargerThanLifeRule(rest))
                 {
-                    warnings.push_back("Invalid #R rule at line " + std::to_string(lineNo) + ": '" + t + "'");
+                    LargerThanLifeRule rule;
+                    parsed = ParseLargerThanLifeRule(rest, rule, &error);
+                    if (parsed)
+                    {
+                        out.rangeRule = rule;
+                        out.states = rule.states;
+                    }
                 }
                 else
                 {
-                    std::string bpart = rest.substr(posB + 1, posS - (posB + 1));
-                    std::string spart = rest.substr(posS + 1);
-                    // reset rules
-                    birth.fill(false);
-                    survival.fill(false);
-                    bool ok = true;
-                    for (char c : bpart)
-                    {
-                        if (c >= '0' && c <= '8')
-                        {
-                            birth[c - '0'] = true;
-                        }
-                        else
-                        {
-                            ok = false;
-                        }
-                    }
-                    for (char c : spart)
-                    {
-                        if (c >= '0' && c <= '8')
-                        {
-                            survival[c - '0'] = true;
-                        }
-                        else
-                        {
-                            ok = false;
-                        }
-                    }
-                    if (!ok)
-                    {
-                        warnings.push_back(
-                            "Invalid digits in #R rule at line " + std::to_string(lineNo) + ": '" + t + "'");
-                    }
-                    else
-                    {
-                        hasRule = true;
-                    }
+                    parsed = ParseRule(rest, out.birth, out.survival, out.states, &error);
+                    if (parsed) out.rangeRule.reset();
+                }
+                if (!parsed)
+                {
+                    warnings.push_back(
+                        "Invalid #R rule at line " + std::to_string(lineNo) + ": '" + t + "' (" + error + ")");
+                }
+                else
+                {
+                    hasRule = true;
                 }
             }
             continue;
@@ -228,7 +876,7 @@ bool Simulation::LoadFromLife106(const std::string& filePath, std::vector<std::s
         int row = centerRow + y;
         int col = centerCol + x;
 
-        if (!grid.IsWithinBounds(row, col))
+        if (row < 0 || row >= rows || col < 0 || col >= columns)
         {
             warnings.push_back(
                 "Coordinate out of bounds at line " + std::to_string(lineNo) + ": (" + std::to_string(x) + "," +
@@ -236,17 +884,12 @@ bool Simulation::LoadFromLife106(const std::string& filePath, std::vector<std::s
             continue;
         }
 
-        long long key = (static_cast<long long>(row) << 32) | static_cast<unsigned int>(col);
-        if (placed.find(key) != placed.end())
+        if (!setCell(row, col))
         {
             warnings.push_back(
                 "Duplicate coordinate (same cell) at line " + std::to_string(lineNo) + ": (" + std::to_string(x) + "," +
                 std::to_string(y) + ")");
-            continue;
         }
-
-        grid.SetCellValue(row, col, 1);
-        placed.insert(key);
     }
 
     if (!hasName)
@@ -258,12 +901,232 @@ bool Simulation::LoadFromLife106(const std::string& filePath, std::vector<std::s
         warnings.push_back("No rule (#R Bx/Sy) found in file — defaulting to B3/S23");
     }
 
-    tempGrid = grid;
+    if (progress) progress(1.0f);
+    return true;
+}
+
+void Simulation::ApplySnapshot(const BoardSnapshot& snapshot)
+{
+    if (sessionLog.IsOpen())
+    {
+        std::string rule = snapshot.rangeRule ? FormatLargerThanLifeRule(*snapshot.rangeRule)
+                                              : FormatRule(snapshot.birth, snapshot.survival, snapshot.states);
+        sessionLog.Board(generation, snapshot.generation, snapshot.Cells(), snapshot.states, rule,
+                         snapshot.universeName);
+    }
+    birth = snapshot.birth;
+    survival = snapshot.survival;
+    states = snapshot.states;
+    rangeRule = snapshot.rangeRule;
+    universeName = snapshot.universeName;
+
+    grid.Clear();
+    snapshot.Cells().ToGrid(grid);
+    generation = snapshot.generation;
+    history.Reset();
+    OnBoardReplaced();
+    if (history.IsEnabled()) RecordHistory();
+}
+
+void Simulation::LoadCells(const uint8_t* cells, size_t stride)
+{
+    for (int row = 0; row < grid.GetRows(); row++) grid.LoadRow(row, cells + row * stride);
+    OnCellsLoaded();
+}
+
+// Bit i of the index as byte i in memory, to unpack eight cells at once
+static const std::array<uint64_t, 256> kSpreadBits = []
+{
+    std::array<uint64_t, 256> table{};
+    for (int bits = 0; bits < 256; bits++)
+    {
+        uint8_t bytes[8];
+        for (int i = 0; i < 8; i++) bytes[i] = static_cast<uint8_t>((bits >> i) & 1);
+        std::memcpy(&table[bits], bytes, sizeof(bytes));
+    }
+    return table;
+}();
+
+void Simulation::LoadPackedCells(const uint64_t* words, size_t stride, size_t planeStride)
+{
+    const int planes = PlanesForStates(states);
+    const size_t wordsPerRow = (static_cast<size_t>(grid.GetColumns()) + 63) / 64;
+    // Whole words are unpacked; bits past the last column land in the padding
+    std::vector<uint8_t> values(wordsPerRow * 64);
+    for (int row = 0; row < grid.GetRows(); row++)
+    {
+        std::fill(values.begin(), values.end(), 0);
+        for (int plane = 0; plane < planes; plane++)
+        {
+            const uint64_t* in = words + plane * planeStride + row * stride;
+            for (size_t w = 0; w < wordsPerRow; w++)
+            {
+                const uint64_t bits = in[w];
+                if (bits == 0) continue;
+                uint8_t* out = values.data() + w * 64;
+                for (int shift = 0; shift < 64; shift += 8)
+                {
+                    uint64_t span;
+                    std::memcpy(&span, out + shift, sizeof(span));
+                    span |= kSpreadBits[(bits >> shift) & 0xff] << plane;
+                    std::memcpy(out + shift, &span, sizeof(span));
+                }
+            }
+        }
+        grid.LoadRow(row, values.data());
+    }
+    OnCellsLoaded();
+}
+
+void Simulation::OnCellsLoaded()
+{
+    OnBoardReplaced();
+    historyDirty = history.IsEnabled();
+    if (sessionLog.IsOpen())
+    {
+        sessionLog.Board(generation, generation, PackCells(), states, GetRuleString(), universeName);
+    }
+}
+
+std::vector<PatternMatch> Simulation::FindPattern(const Pattern& pattern, uint8_t orientations, int threads) const
+{
+    if (states == 2) return ::FindPattern(PackedBoard::FromGrid(grid), pattern, orientations, threads);
 
+    // Only state 1 is alive: plane 0 without any higher plane
+    const PackedBoard sliced = bitSliced.IsValid() ? bitSliced.GetBoard() : PackedBoard::FromGrid(grid, PlanesForStates(states));
+    PackedBoard live(sliced.GetRows(), sliced.GetColumns());
+    for (int row = 0; row < live.GetRows(); row++)
+    {
+        for (int w = 0; w < live.GetWordsPerRow(); w++)
+        {
+            uint64_t higher = 0;
+            for (int plane = 1; plane < sliced.GetPlanes(); plane++) higher |= sliced.Row(row, plane)[w];
+            live.Row(row)[w] = sliced.Row(row)[w] & ~higher;
+        }
+    }
+    return ::FindPattern(live, pattern, orientations, threads);
+}
+
+bool Simulation::StartSessionLog(const std::string& path, std::string* err)
+{
+    if (!sessionLog.Open(path, err)) return false;
+    // The log starts from the current board, so it can be replayed into any Simulation
+    sessionLog.Board(generation, generation, PackedBoard::FromGrid(grid, PlanesForStates(states)), states,
+                     GetRuleString(), universeName);
+    if (history.IsEnabled())
+    {
+        sessionLog.HistoryBudget(generation, history.GetBudgetMB(), history.GetKeyframeInterval());
+    }
+    if (running) sessionLog.Start(generation);
+    return true;
+}
+
+bool Simulation::ReplaySessionLog(const std::string& path, std::string* err)
+{
+    SessionLogReader reader;
+    if (!reader.Open(path, err)) return false;
+
+    SessionEvent event;
+    while (reader.Next(event))
+    {
+        // Everything between two events was plain stepping
+        if (event.generation > generation) Advance(event.generation - generation);
+
+        std::string error;
+        bool ok = true;
+        switch (event.kind)
+        {
+        case SessionEventKind::SetCell:
+            SetCellValue(event.row, event.column, event.value);
+            break;
+        case SessionEventKind::Clear:
+            ClearGrid();
+            break;
+        case SessionEventKind::Random:
+            CreateRandomState(static_cast<uint32_t>(event.number));
+            break;
+        case SessionEventKind::Start:
+            running = true;
+            break;
+        case SessionEventKind::Stop:
+            running = false;
+            break;
+        case SessionEventKind::Board:
+        {
+            BoardSnapshot snapshot;
+            if (IsLargerThanLifeRule(event.text))
+            {
+                LargerThanLifeRule rule;
+                ok = ParseLargerThanLifeRule(event.text, rule, &error);
+                snapshot.rangeRule = rule;
+            }
+            else
+            {
+                ok = ParseRule(event.text, snapshot.birth, snapshot.survival, snapshot.states, &error);
+            }
+            snapshot.states = event.states;
+            snapshot.cells = std::move(event.board);
+            snapshot.universeName = event.universeName;
+            snapshot.generation = static_cast<long long>(event.number);
+            if (snapshot.cells.GetRows() != grid.GetRows() || snapshot.cells.GetColumns() != grid.GetColumns())
+            {
+                ResizeBoard(snapshot.cells.GetRows(), snapshot.cells.GetColumns());
+            }
+            if (ok) ApplySnapshot(snapshot);
+            break;
+        }
+        case SessionEventKind::Rule:
+            ok = SetRule(event.text, &error);
+            break;
+        case SessionEventKind::Seek:
+            ok = SeekTo(static_cast<long long>(event.number));
+            if (!ok) error = "generation " + std::to_string(event.number) + " is not in history";
+            break;
+        case SessionEventKind::Resize:
+            ResizeBoard(event.row, event.column);
+            break;
+        case SessionEventKind::History:
+            if (event.number == 0) DisableHistory();
+            else EnableHistory(static_cast<size_t>(event.number), event.value);
+            break;
+        case SessionEventKind::End:
+            return true;
+        }
+        if (!ok)
+        {
+            if (err) *err = "Replay diverged at generation " + std::to_string(event.generation) + ": " + error;
+            return false;
+        }
+    }
+    if (!reader.GetError().empty())
+    {
+        if (err) *err = reader.GetError();
+        return false;
+    }
     return true;
 }
 
+std::shared_ptr<const BoardSnapshot> Simulation::TakeSnapshot() const
+{
+    auto snapshot = std::make_shared<BoardSnapshot>();
+    // No copy: the simulation leaves this board alone and packs or steps into another one
+    snapshot->sharedCells = SharePackedCells();
+    snapshot->birth = birth;
+    snapshot->survival = survival;
+    snapshot->states = states;
+    snapshot->rangeRule = rangeRule;
+    snapshot->universeName = universeName;
+    snapshot->generation = generation;
+    return snapshot;
+}
+
 bool Simulation::SaveToLife106(const std::string& outPath, std::string* err) const
+{
+    return WriteLife106(*TakeSnapshot(), outPath, err);
+}
+
+bool Simulation::WriteLife106(const BoardSnapshot& snapshot, const std::string& outPath, std::string* err,
+                              const std::function<void(float)>& progress)
 {
     std::ofstream out(outPath);
     if (!out.is_open())
@@ -273,31 +1136,46 @@ bool Simulation::SaveToLife106(const std::string& outPath, std::string* err) con
     }
 
     out << "Life 1.06\n";
-    if (!universeName.empty())
+    if (!snapshot.universeName.empty())
     {
-        out << "#N " << universeName << "\n";
+        out << "#N " << snapshot.universeName << "\n";
     }
     // write rule
-    out << "#R B";
-    for (int i = 0; i <= 8; ++i) if (birth[i]) out << i;
-    out << "/S";
-    for (int i = 0; i <= 8; ++i) if (survival[i]) out << i;
-    out << "\n";
+    out << "#R "
+        << (snapshot.rangeRule ? FormatLargerThanLifeRule(*snapshot.rangeRule)
+                               : FormatRule(snapshot.birth, snapshot.survival, snapshot.states))
+        << "\n";
 
-    int centerRow = grid.GetRows() / 2;
-    int centerCol = grid.GetColumns() / 2;
-    for (int r = 0; r < grid.GetRows(); ++r)
+    const PackedBoard& cells = snapshot.Cells();
+    int centerRow = cells.GetRows() / 2;
+    int centerCol = cells.GetColumns() / 2;
+    for (int r = 0; r < cells.GetRows(); ++r)
     {
-        for (int c = 0; c < grid.GetColumns(); ++c)
+        const uint64_t* words = cells.Row(r);
+        for (int w = 0; w < cells.GetWordsPerRow(); ++w)
         {
-            if (grid.GetCellValue(r, c) != 0)
+            // Only live cells (state 1) have coordinates in Life 1.06
+            uint64_t higher = 0;
+            for (int plane = 1; plane < cells.GetPlanes(); ++plane) higher |= cells.Row(r, plane)[w];
+            for (uint64_t bits = words[w] & ~higher; bits != 0; bits &= bits - 1)
             {
+                int c = w * 64 + std::countr_zero(bits);
                 int x = c - centerCol;
                 int y = r - centerRow;
                 out << x << " " << y << "\n";
             }
         }
+        if (progress && (r & 0xff) == 0)
+        {
+            progress(static_cast<float>(r) / static_cast<float>(cells.GetRows()));
+        }
     }
 
+    if (progress) progress(1.0f);
+    if (!out)
+    {
+        if (err) *err = "Write failed: " + outPath;
+        return false;
+    }
     return true;
 }
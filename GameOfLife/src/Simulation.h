@@ -1,8 +1,52 @@
 #pragma once
 #include "Grid.h"
+#include "History.h"
+#include "SparseEngine.h"
+#include "BitSlicedEngine.h"
+#include "BlockLookupEngine.h"
+#include "TiledEngine.h"
+#include "BoardStats.h"
+#include "EditBuffer.h"
+#include "ChangeStream.h"
+#include "FrameRecorder.h"
+#include "SessionLog.h"
+#include "PatternSearch.h"
+#include "LargerThanLife.h"
 #include <string>
 #include <vector>
 #include <array>
+#include <functional>
+#include <memory>
+#include <optional>
+
+// Immutable copy of one generation, safe to hand to another thread
+struct BoardSnapshot
+{
+    // Loaded boards
+    PackedBoard cells;
+    // Taken snapshots share the simulation's packed board instead, see Simulation::TakeSnapshot
+    std::shared_ptr<const PackedBoard> sharedCells;
+    const PackedBoard& Cells() const { return sharedCells ? *sharedCells : cells; }
+    std::array<bool, 9> birth{};
+    std::array<bool, 9> survival{};
+    // Generations rules: states 0..states-1, cells sliced into PlanesForStates(states) planes
+    int states = 2;
+    // Set for Larger-than-Life rules, birth/survival are unused then
+    std::optional<LargerThanLifeRule> rangeRule;
+    std::string universeName;
+    long long generation = 0;
+};
+
+enum class StepEngine
+{
+    Auto,   // sparse below a density threshold, dense above it
+    Dense,    // scan every cell
+    Sparse,   // only cells next to changes
+    BitSliced, // 64 cells per word, also used for Generations rules
+    BlockLookup, // 4x4 neighbourhood table per 2x2 block, two-state rules only
+    Tiled, // work-stealing thread pool over tiles, two-state rules only
+    LargerThanLife // running sums for range-R rules
+};
 
 class Simulation
 {
@@ -12,34 +56,219 @@ public:
     void Draw() const;
     void Update();
     void Step();
+    // Same as calling Step() generations times; the tiled engine runs them without a per-generation barrier
+    void Advance(long long generations);
     void ClearGrid();
     void CreateRandomState();
+    void CreateRandomState(uint32_t seed);
     void ToggleCell(int row, int column);
-    void Start() { running = true; }
-    void Stop() { running = false; }
+    // Strokes, rectangles and stamps recorded from any thread; Update, Step and Advance
+    // apply them at the generation boundary, before stepping
+    EditBuffer& Edits() { return edits; }
+    void ApplyEdits();
+    // New empty board; cell planes are carved again from the same arena
+    void ResizeBoard(int rows, int columns);
+    const Arena& GetArena() const { return arena; }
+    void Start();
+    void Stop();
     bool IsRunning() const { return running; }
 
+    void SetStepEngine(StepEngine engine) { stepEngine = engine; }
+    // auto, dense, sparse, bitsliced, block or tiled
+    static bool ParseStepEngine(const std::string& name, StepEngine& engine);
+    StepEngine GetStepEngine() const { return stepEngine; }
+    // Engine used by the last Step (never Auto)
+    StepEngine GetActiveEngine() const { return activeEngine; }
+    long long GetPopulation() const { return population; }
+
+    // threads <= 0 uses every hardware thread
+    void ConfigureTiles(int threads, int tileSize) { tiled.Configure(threads, tileSize); }
+    const TileSchedulerStats& GetTileStats() const { return tiled.GetStats(); }
+
+    // Per-cell age plane for heatmap rendering; free while disabled
+    void SetAgeTracking(bool enabled)
+    {
+        grid.EnableAges(enabled);
+        ++boardRevision;
+    }
+    bool IsAgeTracking() const { return grid.HasAges(); }
+    int GetCellAge(int row, int column) const { return grid.GetCellAge(row, column); }
+
+    // Population, births, deaths, bounding box and per-tile counts, kept up to date by
+    // every Step and edit while enabled, see StatsTracker
+    void EnableStats(bool enabled);
+    bool IsTrackingStats() const { return statsEnabled; }
+    const BoardStats& Stats() const { return statsTracker.Get(); }
+    // Called after every Step with the new stats; setting one enables tracking
+    void SetStatsCallback(std::function<void(const BoardStats&)> callback);
+
+    // Rewind buffer: keyframes + XOR deltas within budgetMB, oldest evicted first
+    void EnableHistory(size_t budgetMB, int keyframeInterval = 64);
+    void DisableHistory();
+    bool StepBack();
+    bool SeekTo(long long targetGeneration);
+    long long GetGeneration() const { return generation; }
+    // Changes whenever something Draw shows may have changed, so a renderer can skip unchanged frames
+    long long GetBoardRevision() const { return boardRevision; }
+    const History& GetHistory() const { return history; }
+
     bool LoadFromLife106(const std::string& filePath, std::vector<std::string>& warnings);
     bool SaveToLife106(const std::string& outPath, std::string* err = nullptr) const;
 
+    // Parsing and writing without touching a live Simulation, for background I/O.
+    // progress receives values in [0, 1].
+    static bool ParseLife106(const std::string& filePath, int rows, int columns, BoardSnapshot& out,
+                             std::vector<std::string>& warnings, const std::function<void(float)>& progress = {});
+    static bool WriteLife106(const BoardSnapshot& snapshot, const std::string& outPath, std::string* err = nullptr,
+                             const std::function<void(float)>& progress = {});
+    // ParseLife106 without the board: name and rule go to header, each live cell (centred and
+    // inside rows x columns) to setCell, which returns false for a cell it already has.
+    static bool ReadLife106(const std::string& filePath, int rows, int columns, BoardSnapshot& header,
+                            const std::function<bool(int, int)>& setCell, std::vector<std::string>& warnings,
+                            const std::function<void(float)>& progress = {});
+
+    // Golly macrocell (.mc): a quadtree storing identical subtrees once. Loading paints
+    // the nodes straight into the board, skipping subtrees that miss it; saving writes
+    // each distinct node once. Defined in Macrocell.cpp.
+    bool LoadFromMacrocell(const std::string& filePath, std::vector<std::string>& warnings);
+    bool SaveToMacrocell(const std::string& outPath, std::string* err = nullptr) const;
+    static bool ParseMacrocell(const std::string& filePath, int rows, int columns, BoardSnapshot& out,
+                               std::vector<std::string>& warnings);
+    static bool WriteMacrocell(const BoardSnapshot& snapshot, const std::string& outPath, std::string* err = nullptr);
+
+    // Publishes every generation to viewers on a Unix socket or FIFO, see ChangeStreamWriter
+    bool StartChangeStream(const std::string& path, StreamTransport transport, std::string* err = nullptr);
+    void StopChangeStream() { changeStream.Close(); }
+    const ChangeStreamWriter& GetChangeStream() const { return changeStream; }
+
+    // Writes every options.every-th generation as an image, see FrameRecorder
+    bool StartRecording(const RecordOptions& options, std::string* err = nullptr);
+    bool StopRecording(std::string* err = nullptr) { return recorder.Close(err); }
+    const FrameRecorder& GetRecorder() const { return recorder; }
+
+    // Logs edits, seeds, run state changes, loads, rule and size changes with their generation.
+    // Replaying the log into a fresh Simulation rebuilds the session, stepping at full speed.
+    bool StartSessionLog(const std::string& path, std::string* err = nullptr);
+    void StopSessionLog() { sessionLog.Close(generation); }
+    const SessionLog& GetSessionLog() const { return sessionLog; }
+    bool ReplaySessionLog(const std::string& path, std::string* err = nullptr);
+
+    // Every placement of pattern among the live cells, see FindPattern in PatternSearch.h
+    std::vector<PatternMatch> FindPattern(const Pattern& pattern, uint8_t orientations = kAllOrientations,
+                                          int threads = 0) const;
+
+    // Current generation without copying: one byte per cell, GetColumns() per row.
+    // Valid until the next step, edit or load.
+    const uint8_t* GetCells() const { return grid.Words().data(); }
+    // Current generation as PlanesForStates(GetStates()) bit planes: the bit-sliced engine's
+    // own board when it made the last step, otherwise packed once per board revision
+    const PackedBoard& GetPackedCells() const { return PackCells(); }
+    // Replace every cell from a caller's buffer; strides count elements between rows
+    void LoadCells(const uint8_t* cells, size_t stride);
+    // planeStride words separate the planes of a multi-state board
+    void LoadPackedCells(const uint64_t* words, size_t stride, size_t planeStride);
+
+    std::shared_ptr<const BoardSnapshot> TakeSnapshot() const;
+    void ApplySnapshot(const BoardSnapshot& snapshot);
+
     const std::string& GetUniverseName() const { return universeName; }
+    void SetUniverseName(const std::string& name) { universeName = name; }
+
+    const std::array<bool, 9>& GetBirthRule() const { return birth; }
+    const std::array<bool, 9>& GetSurvivalRule() const { return survival; }
+    int GetStates() const { return states; }
+    void SetRule(const std::array<bool, 9>& birthRule, const std::array<bool, 9>& survivalRule, int stateCount = 2);
+    // Accepts Bx/Sy[/Cn] as well as Larger-than-Life rules such as R5,C0,M1,S34..58,B34..45,NM
+    bool SetRule(const std::string& rule, std::string* error = nullptr);
+    std::string GetRuleString() const;
+    void SetRule(const LargerThanLifeRule& rule);
+    const std::optional<LargerThanLifeRule>& GetRangeRule() const { return rangeRule; }
+
+    // Rule text: Bx/Sy, optionally /Cn for Generations rules with n states
+    static bool ParseRule(const std::string& text, std::array<bool, 9>& birthOut, std::array<bool, 9>& survivalOut,
+                          int& statesOut, std::string* error = nullptr);
+    static std::string FormatRule(const std::array<bool, 9>& birthRule, const std::array<bool, 9>& survivalRule,
+                                  int stateCount);
 
     // helpers for tests
     int GetCellValue(int row, int column) const;
+    void SetCellValue(int row, int column, int value);
     int GetRows() const { return grid.GetRows(); }
     int GetColumns() const { return grid.GetColumns(); }
 
 private:
     int CountLiveNeighbors(int row, int column) const;
+    int CountRangeNeighbors(int row, int column) const;
+    void ClampStates(int stateCount);
+    void StepDense();
+    StepEngine ChooseEngine() const;
+    void OnBoardReplaced();
+    void RecordHistory();
+    void PublishChanges();
+    void RecordFrame();
+    const PackedBoard& PackCells() const { return *SharePackedCells(); }
+    // Packed board of this revision, kept unchanged for as long as it is held
+    std::shared_ptr<const PackedBoard> SharePackedCells() const;
+    // PackCells result without packing: the bit-sliced board or a current cache, else null
+    const PackedBoard* FindPackedCells() const;
+    void OnCellsLoaded();
+    // Keeps engines, stats, history and the session log in step with one cell the grid already changed
+    void OnCellChanged(int row, int column, bool wasSet, int value);
+    void UpdateStats();
 
+    // Backs both cell planes and the age plane; declared before the grids that use it
+    Arena arena;
     Grid grid;
     Grid tempGrid;
     bool running;
+    long long generation = 0;
+    long long population = 0;
+    long long boardRevision = 0;
+
+    StepEngine stepEngine = StepEngine::Auto;
+    StepEngine activeEngine = StepEngine::Dense;
+    SparseEngine sparse;
+    BitSlicedEngine bitSliced;
+    BlockLookupEngine blockLookup;
+    TiledEngine tiled;
+    LargerThanLifeEngine rangeEngine;
+
+    History history;
+    // Current board was edited since it was last recorded
+    bool historyDirty = false;
+
+    ChangeStreamWriter changeStream;
+    FrameRecorder recorder;
+    SessionLog sessionLog;
+    bool statsEnabled = false;
+    StatsTracker statsTracker;
+    std::function<void(const BoardStats&)> statsCallback;
+    EditBuffer edits;
+    // Rasterized pending edits, kept to reuse their storage
+    PackedBoard editMask;
+    PackedBoard editValues;
+    EditRows editRows;
+    struct EditedSpan
+    {
+        int row;
+        int span;
+        uint64_t changed;
+        uint64_t wasSet;
+    };
+    std::vector<EditedSpan> editedSpans;
+    // Packed copy of the grid for snapshots, the change stream, the recorder and GetPackedCells.
+    // Copy on write: replaced instead of repacked while a snapshot holds it
+    mutable std::shared_ptr<PackedBoard> packedCells;
+    mutable long long packedRevision = -1;
 
     // birth[n] == true => dead cell with n neighbors becomes alive
     // survival[n] == true => live cell with n neighbors survives
     std::array<bool, 9> birth{};
     std::array<bool, 9> survival{};
+    // 2 for plain rules, C for Generations rules (1 alive, 2..C-1 dying)
+    int states = 2;
+    // Replaces birth/survival while set
+    std::optional<LargerThanLifeRule> rangeRule;
 
     // Optional name parsed from #N comment
     std::string universeName;
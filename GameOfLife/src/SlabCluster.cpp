@@ -0,0 +1,848 @@
+#include "SlabCluster.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <random>
+#include <unordered_set>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    enum Command : uint32_t
+    {
+        CommandNone = 0,
+        CommandLoad,
+        CommandGather,
+        CommandStep,
+        CommandQuit
+    };
+
+    // Two slots are enough: a worker can only run one generation ahead of its neighbours
+    constexpr uint64_t kRingSlots = 2;
+
+    // How long Shutdown waits for workers to quit before killing them
+    constexpr int64_t kShutdownNanos = 2000000000;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory counters must be lock-free");
+
+    size_t AlignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Spin briefly, then yield, then sleep: workers may outnumber cores
+    void Backoff(int& spins)
+    {
+        ++spins;
+        if (spins < 128) return;
+        if (spins < 4096)
+        {
+            sched_yield();
+            return;
+        }
+        usleep(50);
+    }
+
+    // Sends out[i] over fds[i] while filling in[i] from it, on both sockets at once.
+    // The sockets are nonblocking, so a row wider than the socket buffer (which the
+    // kernel may clamp below what was asked for) cannot leave both neighbours stuck
+    // in a write. Fails when a peer goes away or the parent died.
+    bool ExchangeRows(const int fds[2], const uint8_t* const out[2], uint8_t* const in[2], size_t size, pid_t parent)
+    {
+#ifdef MSG_NOSIGNAL
+        constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+        constexpr int kSendFlags = 0; // SO_NOSIGPIPE is set on the sockets instead
+#endif
+        size_t sent[2] = {0, 0};
+        size_t received[2] = {0, 0};
+        while (sent[0] < size || sent[1] < size || received[0] < size || received[1] < size)
+        {
+            pollfd polls[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                polls[i].fd = fds[i];
+                polls[i].events =
+                    static_cast<short>((sent[i] < size ? POLLOUT : 0) | (received[i] < size ? POLLIN : 0));
+                polls[i].revents = 0;
+            }
+            int ready = poll(polls, 2, 1000);
+            if (ready < 0 && errno != EINTR) return false;
+            if (ready <= 0)
+            {
+                if (getppid() != parent) return false;
+                continue;
+            }
+            for (int i = 0; i < 2; ++i)
+            {
+                if ((polls[i].revents & POLLOUT) && sent[i] < size)
+                {
+                    ssize_t n = send(fds[i], out[i] + sent[i], size - sent[i], kSendFlags);
+                    if (n > 0) sent[i] += static_cast<size_t>(n);
+                    else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+                }
+                if ((polls[i].revents & POLLIN) && received[i] < size)
+                {
+                    ssize_t n = read(fds[i], in[i] + received[i], size - received[i]);
+                    if (n == 0) return false;
+                    if (n > 0) received[i] += static_cast<size_t>(n);
+                    else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+                }
+                if ((polls[i].revents & (POLLERR | POLLNVAL)) ||
+                    ((polls[i].revents & POLLHUP) && !(polls[i].revents & POLLIN)))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    int64_t NowNanos()
+    {
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    }
+
+    // "0-3,8,10-11" as used in /sys/devices/system/node
+    std::vector<int> ParseIdList(const std::string& text)
+    {
+        std::vector<int> ids;
+        size_t start = 0;
+        while (start < text.size())
+        {
+            size_t comma = text.find(',', start);
+            std::string range = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+            size_t dash = range.find('-');
+            int first = std::atoi(range.c_str());
+            int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+            if (!range.empty() && range[0] >= '0' && range[0] <= '9')
+            {
+                for (int id = first; id <= last; ++id) ids.push_back(id);
+            }
+            if (comma == std::string::npos) break;
+            start = comma + 1;
+        }
+        return ids;
+    }
+
+    std::string ReadLine(const std::string& path)
+    {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    // Fills ids/cpus with the NUMA nodes that have CPUs this process may run on
+    void DetectNodes(std::vector<int>& ids, std::vector<std::vector<int>>& cpus)
+    {
+        ids.clear();
+        cpus.clear();
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool haveAffinity = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        auto usable = [&](int cpu) { return !haveAffinity || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)); };
+
+        for (int node : ParseIdList(ReadLine("/sys/devices/system/node/online")))
+        {
+            std::vector<int> nodeCpus;
+            for (int cpu : ParseIdList(ReadLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")))
+            {
+                if (usable(cpu)) nodeCpus.push_back(cpu);
+            }
+            if (nodeCpus.empty()) continue;
+            ids.push_back(node);
+            cpus.push_back(std::move(nodeCpus));
+        }
+        if (!ids.empty()) return;
+
+        std::vector<int> all;
+        for (int cpu = 0; haveAffinity && cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed)) all.push_back(cpu);
+        }
+        ids.push_back(0);
+        cpus.push_back(std::move(all));
+#else
+        ids.push_back(0);
+        cpus.emplace_back();
+#endif
+    }
+
+    uint16_t ToMask(const std::array<bool, 9>& rule)
+    {
+        uint16_t mask = 0;
+        for (int i = 0; i <= 8; ++i) if (rule[i]) mask |= static_cast<uint16_t>(1u << i);
+        return mask;
+    }
+
+    std::array<bool, 9> FromMask(uint16_t mask)
+    {
+        std::array<bool, 9> rule{};
+        for (int i = 0; i <= 8; ++i) rule[i] = (mask >> i) & 1;
+        return rule;
+    }
+}
+
+struct SlabCluster::Shared
+{
+    std::atomic<uint64_t> commandSeq;
+    std::atomic<uint32_t> command;
+    int32_t stepCount;
+    // Board rows held by the transfer window for CommandLoad and CommandGather
+    int32_t transferBegin;
+    int32_t transferCount;
+    uint16_t birthMask;
+    uint16_t survivalMask;
+
+    struct WorkerSlot
+    {
+        alignas(64) std::atomic<uint64_t> doneSeq;
+        int64_t population;
+        // Wall time of the last CommandStep
+        int64_t stepNanos;
+    };
+
+    WorkerSlot* Slots() { return reinterpret_cast<WorkerSlot*>(reinterpret_cast<uint8_t*>(this) + AlignUp(sizeof(Shared), 64)); }
+};
+
+// Single-producer/single-consumer ring of rows; slot data follows the header
+struct SlabCluster::Ring
+{
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+
+    uint8_t* Slot(uint64_t index, int columns)
+    {
+        return reinterpret_cast<uint8_t*>(this) + sizeof(Ring) + (index % kRingSlots) * columns;
+    }
+};
+
+SlabCluster::SlabCluster(int rows, int columns, int workers, HaloTransport transport)
+    : rows(rows),
+      columns(columns),
+      workerCount(std::clamp(workers, 1, std::max(rows, 1))),
+      transport(transport)
+{
+}
+
+SlabCluster::~SlabCluster()
+{
+    Shutdown();
+}
+
+SlabCluster::Ring* SlabCluster::UpRing(int worker) const
+{
+    uint8_t* base = reinterpret_cast<uint8_t*>(shared) + AlignUp(sizeof(Shared), 64) +
+        AlignUp(sizeof(Shared::WorkerSlot) * workerCount, 64);
+    return reinterpret_cast<Ring*>(base + ringStride * (2 * static_cast<size_t>(worker)));
+}
+
+SlabCluster::Ring* SlabCluster::DownRing(int worker) const
+{
+    return reinterpret_cast<Ring*>(reinterpret_cast<uint8_t*>(UpRing(worker)) + ringStride);
+}
+
+static uint8_t* TransferArea(void* shared, size_t sharedBytes, int transferRows, int columns)
+{
+    return static_cast<uint8_t*>(shared) + sharedBytes - static_cast<size_t>(transferRows) * columns;
+}
+
+bool SlabCluster::Start(std::string* err)
+{
+    if (IsStarted()) return true;
+    if (rows <= 0 || columns <= 0)
+    {
+        if (err) *err = "Invalid board size";
+        return false;
+    }
+
+    ringStride = AlignUp(sizeof(Ring) + kRingSlots * columns, 64);
+    transferRows = static_cast<int>(std::clamp<size_t>(transferBytes / columns, 1, rows));
+    sharedBytes = AlignUp(sizeof(Shared), 64) + AlignUp(sizeof(Shared::WorkerSlot) * workerCount, 64) +
+        ringStride * 2 * workerCount + static_cast<size_t>(transferRows) * columns;
+
+    DetectNodes(nodeIds, nodeCpus);
+
+    static std::atomic<int> instanceCounter{0};
+    std::string name = "/gol-slab-" + std::to_string(getpid()) + "-" + std::to_string(instanceCounter++);
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        if (err) *err = "shm_open failed: " + std::string(std::strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(sharedBytes)) != 0)
+    {
+        if (err) *err = "ftruncate failed: " + std::string(std::strerror(errno));
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, sharedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    // The mapping stays valid in every forked worker, so the name is not needed anymore
+    shm_unlink(name.c_str());
+    if (memory == MAP_FAILED)
+    {
+        if (err) *err = "mmap failed: " + std::string(std::strerror(errno));
+        return false;
+    }
+
+    shared = new (memory) Shared{};
+    for (int w = 0; w < workerCount; ++w)
+    {
+        new (&shared->Slots()[w]) Shared::WorkerSlot{};
+        new (UpRing(w)) Ring{};
+        new (DownRing(w)) Ring{};
+    }
+
+    if (transport == HaloTransport::UnixSocket)
+    {
+        edgeSockets.assign(workerCount, {-1, -1});
+        for (auto& edge : edgeSockets)
+        {
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, edge.data()) != 0)
+            {
+                if (err) *err = "socketpair failed: " + std::string(std::strerror(errno));
+                Shutdown();
+                return false;
+            }
+            // Rows are exchanged with poll, so the buffer size is only a hint for fewer rounds
+            int bufferSize = std::max(columns * 2, 1 << 16);
+            for (int end : edge)
+            {
+                setsockopt(end, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+                fcntl(end, F_SETFL, fcntl(end, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+                int on = 1;
+                setsockopt(end, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+            }
+        }
+    }
+
+    for (int w = 0; w < workerCount; ++w)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            if (err) *err = "fork failed: " + std::string(std::strerror(errno));
+            Shutdown();
+            return false;
+        }
+        if (pid == 0)
+        {
+            WorkerMain(w);
+            _exit(0);
+        }
+        pids.push_back(pid);
+    }
+    return true;
+}
+
+void SlabCluster::Shutdown()
+{
+    if (!pids.empty())
+    {
+        shared->command.store(CommandQuit, std::memory_order_relaxed);
+        shared->commandSeq.fetch_add(1, std::memory_order_release);
+        // A worker stuck on a halo that never comes would block a plain waitpid forever
+        const int64_t deadline = NowNanos() + kShutdownNanos;
+        int status = 0;
+        while (true)
+        {
+            std::erase_if(pids, [&](pid_t pid) { return waitpid(pid, &status, WNOHANG) != 0; });
+            if (pids.empty() || NowNanos() >= deadline) break;
+            usleep(1000);
+        }
+        for (pid_t pid : pids) kill(pid, SIGKILL);
+        for (pid_t pid : pids) waitpid(pid, &status, 0);
+        pids.clear();
+    }
+    for (auto& edge : edgeSockets)
+    {
+        if (edge[0] >= 0) close(edge[0]);
+        if (edge[1] >= 0) close(edge[1]);
+    }
+    edgeSockets.clear();
+    if (shared)
+    {
+        munmap(shared, sharedBytes);
+        shared = nullptr;
+    }
+}
+
+bool SlabCluster::RunCommand(uint32_t command, std::string* err)
+{
+    if (!IsStarted() && !Start(err)) return false;
+
+    shared->command.store(command, std::memory_order_relaxed);
+    uint64_t seq = shared->commandSeq.fetch_add(1, std::memory_order_release) + 1;
+
+    for (int w = 0; w < workerCount; ++w)
+    {
+        int spins = 0;
+        while (shared->Slots()[w].doneSeq.load(std::memory_order_acquire) != seq)
+        {
+            Backoff(spins);
+            if (spins % 1024 == 0)
+            {
+                int status = 0;
+                if (waitpid(pids[w], &status, WNOHANG) == pids[w])
+                {
+                    // One slab is gone, the others would wait on its halo forever
+                    if (err) *err = "Worker " + std::to_string(w) + " exited unexpectedly";
+                    pids.erase(pids.begin() + w);
+                    for (pid_t pid : pids) kill(pid, SIGKILL);
+                    for (pid_t pid : pids) waitpid(pid, &status, 0);
+                    pids.clear();
+                    Shutdown();
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void SlabCluster::Push(Ring* ring, const uint8_t* row) const
+{
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    int spins = 0;
+    while (head - ring->tail.load(std::memory_order_acquire) >= kRingSlots) Backoff(spins);
+    std::memcpy(ring->Slot(head, columns), row, columns);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void SlabCluster::Pop(Ring* ring, uint8_t* row) const
+{
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    int spins = 0;
+    while (ring->head.load(std::memory_order_acquire) == tail) Backoff(spins);
+    std::memcpy(row, ring->Slot(tail, columns), columns);
+    ring->tail.store(tail + 1, std::memory_order_release);
+}
+
+int SlabCluster::GetWorkerNode(int worker) const
+{
+    if (nodeCpus.empty()) return 0;
+    return static_cast<int>(static_cast<long long>(worker) * static_cast<long long>(nodeCpus.size()) / workerCount);
+}
+
+// Runs in the worker before it allocates its slab
+void SlabCluster::ApplyPlacement(int worker) const
+{
+#ifdef __linux__
+    const int node = GetWorkerNode(worker);
+    const std::vector<int>& cpus = nodeCpus[node];
+    if (placement.pinning != SlabPinning::None && !cpus.empty())
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (placement.pinning == SlabPinning::Node)
+        {
+            for (int cpu : cpus) CPU_SET(cpu, &set);
+        }
+        else
+        {
+            int firstOnNode = 0;
+            while (GetWorkerNode(firstOnNode) != node) ++firstOnNode;
+            CPU_SET(cpus[(worker - firstOnNode) % cpus.size()], &set);
+        }
+        // Best effort: an unpinned worker still computes the right result
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+
+#ifdef SYS_set_mempolicy
+    if (placement.interleave && nodeIds.size() > 1)
+    {
+        constexpr int kInterleavePolicy = 3; // MPOL_INTERLEAVE from <linux/mempolicy.h>
+        constexpr int kMaskBits = 8 * sizeof(unsigned long);
+        unsigned long mask[16] = {};
+        for (int id : nodeIds)
+        {
+            if (id < kMaskBits * 16) mask[id / kMaskBits] |= 1ul << (id % kMaskBits);
+        }
+        syscall(SYS_set_mempolicy, kInterleavePolicy, mask, static_cast<unsigned long>(kMaskBits * 16));
+    }
+#endif
+#else
+    (void)worker;
+#endif
+}
+
+std::vector<NodeThroughput> SlabCluster::GetNodeThroughput() const
+{
+    std::vector<NodeThroughput> nodes(std::max<size_t>(nodeIds.size(), 1));
+    for (size_t i = 0; i < nodes.size(); ++i) nodes[i].node = i < nodeIds.size() ? nodeIds[i] : 0;
+    if (!shared) return nodes;
+
+    for (int w = 0; w < workerCount; ++w)
+    {
+        NodeThroughput& node = nodes[GetWorkerNode(w)];
+        long long cells = static_cast<long long>(SlabEnd(w) - SlabBegin(w)) * columns;
+        node.workers++;
+        node.cells += cells;
+        int64_t nanos = shared->Slots()[w].stepNanos;
+        if (nanos > 0) node.cellsPerSecond += static_cast<double>(cells) * shared->stepCount * 1e9 / nanos;
+    }
+    return nodes;
+}
+
+void SlabCluster::WorkerMain(int worker)
+{
+    ApplyPlacement(worker);
+
+    const int begin = SlabBegin(worker);
+    const int height = SlabEnd(worker) - begin;
+    const int above = (worker + workerCount - 1) % workerCount;
+    const int below = (worker + 1) % workerCount;
+    const pid_t parent = getppid();
+
+    // Slab rows 1..height, halo rows 0 and height + 1; zero-filled here after pinning,
+    // so first touch places them on this worker's node
+    std::vector<uint8_t> current(static_cast<size_t>(height + 2) * columns, 0);
+    std::vector<uint8_t> next(current.size(), 0);
+    Shared::WorkerSlot& slot = shared->Slots()[worker];
+    uint8_t* transfer = TransferArea(shared, sharedBytes, transferRows, columns);
+    const int end = begin + height;
+
+    uint64_t seen = 0;
+    while (true)
+    {
+        int spins = 0;
+        uint64_t seq;
+        while ((seq = shared->commandSeq.load(std::memory_order_acquire)) == seen)
+        {
+            Backoff(spins);
+            if (spins % 1024 == 0 && getppid() != parent) return;
+        }
+        seen = seq;
+
+        uint32_t command = shared->command.load(std::memory_order_relaxed);
+        if (command == CommandQuit) return;
+
+        if (command == CommandLoad || command == CommandGather)
+        {
+            // Only the rows this slab shares with the window
+            const int first = std::max(begin, shared->transferBegin);
+            const int last = std::min(end, shared->transferBegin + shared->transferCount);
+            if (first < last)
+            {
+                uint8_t* slabRows = current.data() + static_cast<size_t>(first - begin + 1) * columns;
+                uint8_t* windowRows = transfer + static_cast<size_t>(first - shared->transferBegin) * columns;
+                const size_t bytes = static_cast<size_t>(last - first) * columns;
+                if (command == CommandLoad)
+                {
+                    slot.population -= std::count(slabRows, slabRows + bytes, 1);
+                    std::memcpy(slabRows, windowRows, bytes);
+                    slot.population += std::count(slabRows, slabRows + bytes, 1);
+                }
+                else
+                {
+                    std::memcpy(windowRows, slabRows, bytes);
+                }
+            }
+        }
+        else if (command == CommandStep)
+        {
+            const uint16_t birthMask = shared->birthMask;
+            const uint16_t survivalMask = shared->survivalMask;
+            int64_t population = slot.population;
+            const int64_t stepStart = NowNanos();
+
+            for (int32_t g = 0; g < shared->stepCount; ++g)
+            {
+                uint8_t* top = current.data() + columns;
+                uint8_t* bottom = current.data() + static_cast<size_t>(height) * columns;
+                uint8_t* haloTop = current.data();
+                uint8_t* haloBottom = current.data() + static_cast<size_t>(height + 1) * columns;
+
+                if (transport == HaloTransport::SharedMemory)
+                {
+                    Push(UpRing(worker), top);
+                    Push(DownRing(worker), bottom);
+                    Pop(DownRing(above), haloTop);
+                    Pop(UpRing(below), haloBottom);
+                }
+                else
+                {
+                    const int downEdge = edgeSockets[worker][0];
+                    const int upEdge = edgeSockets[above][1];
+                    const int fds[2] = {downEdge, upEdge};
+                    const uint8_t* const out[2] = {bottom, top};
+                    uint8_t* const in[2] = {haloBottom, haloTop};
+                    if (!ExchangeRows(fds, out, in, columns, parent)) _exit(1);
+                }
+
+                population = 0;
+                for (int r = 1; r <= height; ++r)
+                {
+                    const uint8_t* up = current.data() + static_cast<size_t>(r - 1) * columns;
+                    const uint8_t* mid = up + columns;
+                    const uint8_t* down = mid + columns;
+                    uint8_t* out = next.data() + static_cast<size_t>(r) * columns;
+                    for (int c = 0; c < columns; ++c)
+                    {
+                        int left = c == 0 ? columns - 1 : c - 1;
+                        int right = c == columns - 1 ? 0 : c + 1;
+                        int liveNeighbors = up[left] + up[c] + up[right] + mid[left] + mid[right] +
+                            down[left] + down[c] + down[right];
+                        uint16_t mask = mid[c] ? survivalMask : birthMask;
+                        out[c] = static_cast<uint8_t>((mask >> liveNeighbors) & 1);
+                        population += out[c];
+                    }
+                }
+                current.swap(next);
+            }
+            slot.population = population;
+            slot.stepNanos = NowNanos() - stepStart;
+        }
+
+        slot.doneSeq.store(seq, std::memory_order_release);
+    }
+}
+
+bool SlabCluster::ScatterRows(const std::function<void(int row, uint8_t* cells)>& fillRow, std::string* err)
+{
+    if (!IsStarted() && !Start(err)) return false;
+
+    uint8_t* transfer = TransferArea(shared, sharedBytes, transferRows, columns);
+    for (int first = 0; first < rows; first += transferRows)
+    {
+        const int count = std::min(transferRows, rows - first);
+        std::memset(transfer, 0, static_cast<size_t>(count) * columns);
+        for (int r = 0; r < count; ++r) fillRow(first + r, transfer + static_cast<size_t>(r) * columns);
+        shared->transferBegin = first;
+        shared->transferCount = count;
+        if (!RunCommand(CommandLoad, err)) return false;
+    }
+    return true;
+}
+
+bool SlabCluster::GatherRows(const std::function<bool(int row, const uint8_t* cells)>& readRow, std::string* err)
+{
+    if (!IsStarted() && !Start(err)) return false;
+
+    const uint8_t* transfer = TransferArea(shared, sharedBytes, transferRows, columns);
+    for (int first = 0; first < rows; first += transferRows)
+    {
+        const int count = std::min(transferRows, rows - first);
+        shared->transferBegin = first;
+        shared->transferCount = count;
+        if (!RunCommand(CommandGather, err)) return false;
+        for (int r = 0; r < count; ++r)
+        {
+            if (!readRow(first + r, transfer + static_cast<size_t>(r) * columns)) return false;
+        }
+    }
+    return true;
+}
+
+bool SlabCluster::LoadFrom(const Simulation& simulation, std::string* err)
+{
+    if (simulation.GetRows() != rows || simulation.GetColumns() != columns)
+    {
+        if (err) *err = "Board size does not match the cluster";
+        return false;
+    }
+    if (simulation.GetRangeRule())
+    {
+        if (err) *err = "Larger-than-Life rules are not supported by slab workers";
+        return false;
+    }
+    if (simulation.GetStates() != 2)
+    {
+        if (err) *err = "Generations rules are not supported by slab workers";
+        return false;
+    }
+    if (!IsStarted() && !Start(err)) return false;
+
+    shared->birthMask = ToMask(simulation.GetBirthRule());
+    shared->survivalMask = ToMask(simulation.GetSurvivalRule());
+    universeName = simulation.GetUniverseName();
+    generation = 0;
+    return ScatterRows(
+        [&](int row, uint8_t* cells)
+        {
+            for (int c = 0; c < columns; ++c) cells[c] = simulation.GetCellValue(row, c) != 0;
+        },
+        err);
+}
+
+bool SlabCluster::CopyTo(Simulation& simulation, std::string* err)
+{
+    if (simulation.GetRows() != rows || simulation.GetColumns() != columns)
+    {
+        if (err) *err = "Board size does not match the cluster";
+        return false;
+    }
+    bool gathered = GatherRows(
+        [&](int row, const uint8_t* cells)
+        {
+            for (int c = 0; c < columns; ++c) simulation.SetCellValue(row, c, cells[c]);
+            return true;
+        },
+        err);
+    if (!gathered) return false;
+    simulation.SetRule(FromMask(shared->birthMask), FromMask(shared->survivalMask));
+    simulation.SetUniverseName(universeName);
+    return true;
+}
+
+bool SlabCluster::LoadRandom(uint32_t seed, std::string* err)
+{
+    if (!IsStarted() && !Start(err)) return false;
+
+    shared->birthMask = ToMask({false, false, false, true, false, false, false, false, false});
+    shared->survivalMask = ToMask({false, false, true, true, false, false, false, false, false});
+    universeName.clear();
+    generation = 0;
+    // Same draws in the same row-major order as Grid::FillRandom
+    std::mt19937 gen(seed);
+    return ScatterRows(
+        [&](int, uint8_t* cells)
+        {
+            for (int c = 0; c < columns; ++c) cells[c] = (gen() & 3) == 0 ? 1 : 0;
+        },
+        err);
+}
+
+bool SlabCluster::LoadFromLife106(const std::string& filePath, std::vector<std::string>& warnings)
+{
+    // Only the live cells are held here, as row-major cell indices
+    BoardSnapshot header;
+    std::unordered_set<uint64_t> seen;
+    std::vector<uint64_t> live;
+    auto setCell = [&](int row, int col)
+    {
+        uint64_t index = static_cast<uint64_t>(row) * columns + col;
+        if (!seen.insert(index).second) return false;
+        live.push_back(index);
+        return true;
+    };
+    if (!Simulation::ReadLife106(filePath, rows, columns, header, setCell, warnings)) return false;
+    seen = {};
+
+    if (header.rangeRule)
+    {
+        warnings.push_back("Larger-than-Life rules are not supported by slab workers");
+        return false;
+    }
+    if (header.states != 2)
+    {
+        warnings.push_back("Generations rules are not supported by slab workers");
+        return false;
+    }
+    std::string err;
+    if (!IsStarted() && !Start(&err))
+    {
+        warnings.push_back(err);
+        return false;
+    }
+
+    std::sort(live.begin(), live.end());
+    shared->birthMask = ToMask(header.birth);
+    shared->survivalMask = ToMask(header.survival);
+    universeName = header.universeName;
+    generation = 0;
+    size_t next = 0;
+    bool scattered = ScatterRows(
+        [&](int row, uint8_t* cells)
+        {
+            for (; next < live.size() && live[next] / columns == static_cast<uint64_t>(row); ++next)
+            {
+                cells[live[next] % columns] = 1;
+            }
+        },
+        &err);
+    if (!scattered)
+    {
+        warnings.push_back(err);
+        return false;
+    }
+    return true;
+}
+
+bool SlabCluster::SaveToLife106(const std::string& outPath, std::string* err)
+{
+    std::ofstream out(outPath);
+    if (!out.is_open())
+    {
+        if (err) *err = "Cannot open output file: " + outPath;
+        return false;
+    }
+
+    // Same layout as Simulation::WriteLife106, streamed one transfer window at a time
+    out << "Life 1.06\n";
+    if (!universeName.empty()) out << "#N " << universeName << "\n";
+    if (!IsStarted() && !Start(err)) return false;
+    out << "#R " << Simulation::FormatRule(FromMask(shared->birthMask), FromMask(shared->survivalMask), 2) << "\n";
+
+    const int centerRow = rows / 2;
+    const int centerCol = columns / 2;
+    bool gathered = GatherRows(
+        [&](int row, const uint8_t* cells)
+        {
+            for (int c = 0; c < columns; ++c)
+            {
+                if (cells[c]) out << c - centerCol << " " << row - centerRow << "\n";
+            }
+            return static_cast<bool>(out);
+        },
+        err);
+    if (!gathered)
+    {
+        if (err && out.fail()) *err = "Write failed: " + outPath;
+        return false;
+    }
+    out.flush();
+    if (!out)
+    {
+        if (err) *err = "Write failed: " + outPath;
+        return false;
+    }
+    return true;
+}
+
+bool SlabCluster::Step(int generations, std::string* err)
+{
+    if (generations <= 0) return true;
+    if (!IsStarted() && !Start(err)) return false;
+
+    shared->stepCount = generations;
+    if (!RunCommand(CommandStep, err)) return false;
+    generation += generations;
+    return true;
+}
+
+long long SlabCluster::GetPopulation() const
+{
+    if (!shared) return 0;
+    long long population = 0;
+    for (int w = 0; w < workerCount; ++w)
+    {
+        population += shared->Slots()[w].population;
+    }
+    return population;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+class Simulation;
+
+enum class HaloTransport
+{
+    SharedMemory,
+    UnixSocket
+};
+
+enum class SlabPinning
+{
+    None,
+    Node, // any core of the worker's NUMA node
+    Core  // one core per worker, spread over the node's cores
+};
+
+// Placement of slab workers on multi-socket machines. Workers are assigned to
+// NUMA nodes in contiguous bands (so most halo neighbours share a node) and
+// allocate their slab only after pinning, so first touch puts its pages on the
+// worker's own node. interleave spreads the pages round-robin over all nodes instead.
+struct SlabPlacement
+{
+    SlabPinning pinning = SlabPinning::None;
+    bool interleave = false;
+};
+
+struct NodeThroughput
+{
+    int node = 0;
+    int workers = 0;
+    long long cells = 0;
+    // Cell updates per second during the last Step
+    double cellsPerSecond = 0.0;
+};
+
+// Runs one torus as horizontal slabs, each owned by a forked worker process.
+// Workers keep their slab in private memory and swap edge rows with their two
+// neighbours once per generation, either through single-producer/single-consumer
+// ring buffers in a POSIX shared memory segment or through Unix socket pairs.
+// This process acts as coordinator: it scatters loaded boards, gathers them for
+// saving and sums the per-worker populations. Boards pass through a transfer window
+// of a few rows in the shared segment, so the coordinator never holds a whole board.
+//
+// Start() forks, so call it before the process spawns any threads.
+class SlabCluster
+{
+public:
+    SlabCluster(int rows, int columns, int workers, HaloTransport transport = HaloTransport::SharedMemory);
+    ~SlabCluster();
+
+    SlabCluster(const SlabCluster&) = delete;
+    SlabCluster& operator=(const SlabCluster&) = delete;
+
+    // Takes effect on the next Start
+    void SetPlacement(const SlabPlacement& value) { placement = value; }
+    const SlabPlacement& GetPlacement() const { return placement; }
+    // Bytes of the shared transfer window (at least one row), takes effect on the next Start
+    void SetTransferBytes(size_t value) { transferBytes = value; }
+
+    bool Start(std::string* err = nullptr);
+    void Shutdown();
+
+    // Copies cells and rule of a board with the same dimensions into the workers
+    bool LoadFrom(const Simulation& simulation, std::string* err = nullptr);
+    // Gathers all slabs into simulation (which must have the same dimensions)
+    bool CopyTo(Simulation& simulation, std::string* err = nullptr);
+    // The soup Simulation::CreateRandomState(seed) makes, under B3/S23
+    bool LoadRandom(uint32_t seed, std::string* err = nullptr);
+
+    bool LoadFromLife106(const std::string& filePath, std::vector<std::string>& warnings);
+    bool SaveToLife106(const std::string& outPath, std::string* err = nullptr);
+
+    bool Step(int generations = 1, std::string* err = nullptr);
+
+    long long GetPopulation() const;
+    long long GetGeneration() const { return generation; }
+    int GetRows() const { return rows; }
+    int GetColumns() const { return columns; }
+    int GetWorkerCount() const { return workerCount; }
+    bool IsStarted() const { return !pids.empty(); }
+
+    int GetNodeCount() const { return static_cast<int>(nodeCpus.size()); }
+    // Index into GetNodeThroughput(), valid after Start
+    int GetWorkerNode(int worker) const;
+    std::vector<NodeThroughput> GetNodeThroughput() const;
+
+private:
+    struct Shared;
+    struct Ring;
+
+    bool RunCommand(uint32_t command, std::string* err);
+    // Move the board through the transfer window, window by window in row order.
+    // fillRow gets a zeroed row to set cells in, readRow a gathered one.
+    bool ScatterRows(const std::function<void(int row, uint8_t* cells)>& fillRow, std::string* err);
+    bool GatherRows(const std::function<bool(int row, const uint8_t* cells)>& readRow, std::string* err);
+    void WorkerMain(int worker);
+    void ApplyPlacement(int worker) const;
+
+    int SlabBegin(int worker) const { return static_cast<int>(static_cast<long long>(worker) * rows / workerCount); }
+    int SlabEnd(int worker) const { return SlabBegin(worker + 1); }
+
+    Ring* UpRing(int worker) const;
+    Ring* DownRing(int worker) const;
+    void Push(Ring* ring, const uint8_t* row) const;
+    void Pop(Ring* ring, uint8_t* row) const;
+
+    int rows;
+    int columns;
+    int workerCount;
+    HaloTransport transport;
+    SlabPlacement placement;
+    long long generation = 0;
+
+    // NUMA nodes with usable CPUs; a single node when the topology is unknown
+    std::vector<int> nodeIds;
+    std::vector<std::vector<int>> nodeCpus;
+
+    Shared* shared = nullptr;
+    size_t sharedBytes = 0;
+    size_t ringStride = 0;
+    size_t transferBytes = size_t(4) << 20;
+    int transferRows = 0;
+
+    // edgeSockets[w] connects worker w (end 0, its bottom row) with worker w + 1 (end 1, its top row)
+    std::vector<std::array<int, 2>> edgeSockets;
+    std::vector<pid_t> pids;
+
+    std::string universeName;
+};
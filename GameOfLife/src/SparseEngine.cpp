@@ -0,0 +1,165 @@
+#include "SparseEngine.h"
+#include <algorithm>
+
+void SparseEngine::Rebuild(const Grid& grid)
+{
+    rows = grid.GetRows();
+    columns = grid.GetColumns();
+    live.clear();
+    candidates.clear();
+    changes.clear();
+    emptiedTiles.clear();
+    tileColumns = (columns + kTile - 1) / kTile;
+    tiles.clear();
+    tiles.resize(static_cast<size_t>((rows + kTile - 1) / kTile) * tileColumns);
+    tileCount = 0;
+    stamp = 1;
+    valid = true;
+
+    for (int row = 0; row < rows; row++)
+    {
+        const uint8_t* cells = grid.Row(row);
+        for (int column = 0; column < columns; column++)
+        {
+            if (cells[column] != 0) Flip(Index(row, column), true);
+        }
+    }
+    for (size_t cell : live)
+    {
+        MarkNeighborhood(cell);
+    }
+}
+
+SparseEngine::Tile& SparseEngine::TileAt(int row, int column)
+{
+    const size_t index = static_cast<size_t>(row / kTile) * tileColumns + column / kTile;
+    std::unique_ptr<Tile>& tile = tiles[index];
+    if (!tile)
+    {
+        // Value-initialized: no stamps, no live cells. Candidates alone may touch it,
+        // so it is checked for release like a tile that emptied out.
+        tile = std::make_unique<Tile>();
+        ++tileCount;
+        emptiedTiles.push_back(index);
+    }
+    return *tile;
+}
+
+int SparseEngine::CountNeighbours(const Grid& grid, int row, int column) const
+{
+    const uint8_t* up = grid.Row(row == 0 ? rows - 1 : row - 1);
+    const uint8_t* here = grid.Row(row);
+    const uint8_t* down = grid.Row(row == rows - 1 ? 0 : row + 1);
+    const int left = column == 0 ? columns - 1 : column - 1;
+    const int right = column == columns - 1 ? 0 : column + 1;
+    // Two-state cells are 0 or 1
+    return up[left] + up[column] + up[right] + here[left] + here[right] + down[left] + down[column] + down[right];
+}
+
+void SparseEngine::Flip(size_t cell, bool alive)
+{
+    const int row = RowOf(cell);
+    const int column = ColumnOf(cell);
+    Tile& tile = TileAt(row, column);
+    size_t& position = tile.livePosition[Offset(row, column)];
+    if (alive)
+    {
+        live.push_back(cell);
+        position = live.size();
+        ++tile.liveCells;
+        return;
+    }
+
+    const size_t last = live.back();
+    live[position - 1] = last;
+    live.pop_back();
+    if (last != cell)
+    {
+        const int lastRow = RowOf(last);
+        const int lastColumn = ColumnOf(last);
+        TileAt(lastRow, lastColumn).livePosition[Offset(lastRow, lastColumn)] = position;
+    }
+    position = 0;
+    if (--tile.liveCells == 0) emptiedTiles.push_back(static_cast<size_t>(row / kTile) * tileColumns + column / kTile);
+}
+
+void SparseEngine::MarkNeighborhood(size_t cell)
+{
+    const int row = RowOf(cell);
+    const int column = ColumnOf(cell);
+    const int neighborRows[3] = {row == 0 ? rows - 1 : row - 1, row, row == rows - 1 ? 0 : row + 1};
+    const int neighborColumns[3] = {column == 0 ? columns - 1 : column - 1, column,
+                                    column == columns - 1 ? 0 : column + 1};
+    for (int neighborRow : neighborRows)
+    {
+        for (int neighborColumn : neighborColumns)
+        {
+            uint32_t& mark = TileAt(neighborRow, neighborColumn).stamp[Offset(neighborRow, neighborColumn)];
+            if (mark == stamp) continue;
+            mark = stamp;
+            candidates.push_back(Index(neighborRow, neighborColumn));
+        }
+    }
+}
+
+void SparseEngine::ReleaseEmptyTiles()
+{
+    for (size_t index : emptiedTiles)
+    {
+        if (tiles[index] && tiles[index]->liveCells == 0)
+        {
+            tiles[index].reset();
+            --tileCount;
+        }
+    }
+    emptiedTiles.clear();
+}
+
+void SparseEngine::SetCell(int row, int column, bool alive)
+{
+    if (!valid) return;
+    if ((TileAt(row, column).livePosition[Offset(row, column)] != 0) == alive) return;
+    size_t cell = Index(row, column);
+    Flip(cell, alive);
+    MarkNeighborhood(cell);
+}
+
+void SparseEngine::Step(Grid& grid, const std::array<bool, 9>& birth, const std::array<bool, 9>& survival)
+{
+    // Every candidate is judged on this generation before any of them changes
+    changes.clear();
+    for (size_t cell : candidates)
+    {
+        const int row = RowOf(cell);
+        const int column = ColumnOf(cell);
+        bool alive = grid.Get(row, column) != 0;
+        int count = CountNeighbours(grid, row, column);
+        bool next = alive ? survival[count] : birth[count];
+        if (next != alive)
+        {
+            changes.push_back(cell);
+        }
+    }
+
+    // No stamp is current past this point, so empty tiles can go
+    candidates.clear();
+    ReleaseEmptyTiles();
+    if (++stamp == 0)
+    {
+        for (auto& tile : tiles)
+        {
+            if (tile) std::fill(std::begin(tile->stamp), std::end(tile->stamp), 0u);
+        }
+        stamp = 1;
+    }
+
+    for (size_t cell : changes)
+    {
+        const int row = RowOf(cell);
+        const int column = ColumnOf(cell);
+        bool alive = grid.Get(row, column) == 0;
+        grid.Set(row, column, alive ? 1 : 0);
+        Flip(cell, alive);
+        MarkNeighborhood(cell);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "Grid.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Step engine for sparse boards. Keeps the live cells in a list; each generation
+// only cells next to the previous generation's births and deaths are re-evaluated,
+// their neighbours counted straight from the grid. Cost follows the number of
+// changes instead of the board area, and so does memory: per-cell bookkeeping lives
+// in kTile x kTile tiles allocated when activity first reaches them and released
+// once they hold no live cell, so a few gliders on a huge board cost a few tiles
+// next to the byte grid they live in.
+class SparseEngine
+{
+public:
+    // Collects the live cells from grid, O(area)
+    void Rebuild(const Grid& grid);
+    void Invalidate() { valid = false; }
+    bool IsValid() const { return valid; }
+
+    // Advances grid by one generation; grid must match the last Rebuild plus SetCell edits
+    void Step(Grid& grid, const std::array<bool, 9>& birth, const std::array<bool, 9>& survival);
+    // Mirrors a single edit made to the grid without a rebuild
+    void SetCell(int row, int column, bool alive);
+
+    size_t GetPopulation() const { return live.size(); }
+    size_t GetLastChangeCount() const { return changes.size(); }
+    // Live cells as row * columns + column (Grid::Index), in no particular order
+    const std::vector<size_t>& GetLiveCells() const { return live; }
+    // Cells flipped by the last Step, same indices
+    const std::vector<size_t>& GetChanges() const { return changes; }
+    // Tiles currently allocated, for tests
+    size_t GetTileCount() const { return tileCount; }
+
+private:
+    static constexpr int kTile = 64;
+    struct Tile
+    {
+        // Generation stamp of the last time the cell became a candidate
+        uint32_t stamp[kTile * kTile];
+        // Position in live plus one, 0 while dead
+        size_t livePosition[kTile * kTile];
+        int liveCells;
+    };
+
+    // size_t like Grid::Index, boards may hold more than 2^31 cells
+    size_t Index(int row, int column) const { return static_cast<size_t>(row) * columns + column; }
+    int RowOf(size_t cell) const { return static_cast<int>(cell / columns); }
+    int ColumnOf(size_t cell) const { return static_cast<int>(cell % columns); }
+    Tile& TileAt(int row, int column);
+    int Offset(int row, int column) const { return (row % kTile) * kTile + column % kTile; }
+    // Same torus wrap as Simulation::CountLiveNeighbors, duplicates included on tiny boards
+    int CountNeighbours(const Grid& grid, int row, int column) const;
+    void Flip(size_t cell, bool alive);
+    void MarkNeighborhood(size_t cell);
+    // Frees tiles left without live cells; only safe while no stamp is current
+    void ReleaseEmptyTiles();
+
+    bool valid = false;
+    int rows = 0;
+    int columns = 0;
+
+    std::vector<size_t> live;
+    std::vector<std::unique_ptr<Tile>> tiles;
+    int tileColumns = 0;
+    size_t tileCount = 0;
+    // Tiles created or emptied since the last ReleaseEmptyTiles, which checks them
+    std::vector<size_t> emptiedTiles;
+
+    // Cells to evaluate next generation, deduplicated by stamp
+    std::vector<size_t> candidates;
+    uint32_t stamp = 1;
+
+    std::vector<size_t> changes;
+};
@@ -0,0 +1,387 @@
+#include "TiledEngine.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    uint16_t ToMask(const std::array<bool, 9>& rule)
+    {
+        uint16_t mask = 0;
+        for (int i = 0; i <= 8; ++i) if (rule[i]) mask |= static_cast<uint16_t>(1u << i);
+        return mask;
+    }
+
+    long long NowNanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+TiledEngine::TiledEngine()
+{
+    Configure(0, tileSize);
+}
+
+TiledEngine::~TiledEngine()
+{
+    StopThreads();
+}
+
+void TiledEngine::Configure(int threads, int size)
+{
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    int count = threads > 0 ? threads : std::max(hardware, 1);
+    if (count != threadCount)
+    {
+        StopThreads();
+        threadCount = count;
+    }
+    tileSize = std::max(size, 1);
+    valid = false;
+}
+
+void TiledEngine::StartThreads()
+{
+    if (static_cast<int>(workers.size()) == threadCount) return;
+    workers.clear();
+    for (int w = 0; w < threadCount; ++w) workers.push_back(std::make_unique<Worker>());
+    stopping = false;
+    // The calling thread acts as worker 0
+    for (int w = 1; w < threadCount; ++w) threads.emplace_back(&TiledEngine::ThreadMain, this, w);
+}
+
+void TiledEngine::StopThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(runMutex);
+        stopping = true;
+    }
+    runSignal.notify_all();
+    for (auto& thread : threads) thread.join();
+    threads.clear();
+    workers.clear();
+}
+
+void TiledEngine::ThreadMain(int worker)
+{
+    long long seenEpoch = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(runMutex);
+            runSignal.wait(lock, [&] { return stopping || runEpoch != seenEpoch; });
+            if (stopping) return;
+            seenEpoch = runEpoch;
+        }
+        RunWorker(worker);
+        {
+            std::lock_guard<std::mutex> lock(runMutex);
+            --runningThreads;
+        }
+        runSignal.notify_all();
+    }
+}
+
+void TiledEngine::Rebuild(const Grid& grid)
+{
+    StartThreads();
+
+    rows = grid.GetRows();
+    columns = grid.GetColumns();
+    tilesX = (columns + tileSize - 1) / tileSize;
+    tilesY = (rows + tileSize - 1) / tileSize;
+    const int tileCount = tilesX * tilesY;
+
+    planes[0].assign(static_cast<size_t>(rows) * columns, 0);
+    tilePopulation.assign(tileCount, 0);
+    population = 0;
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++)
+        {
+            uint8_t alive = grid.Get(row, column) == 1;
+            planes[0][static_cast<size_t>(row) * columns + column] = alive;
+            tilePopulation[(row / tileSize) * tilesX + column / tileSize] += alive;
+            population += alive;
+        }
+    }
+    planes[1] = planes[0];
+
+    neighbours.assign(tileCount, {});
+    for (int ty = 0; ty < tilesY; ty++)
+    {
+        for (int tx = 0; tx < tilesX; tx++)
+        {
+            int n = 0;
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    if (dx == 0 && dy == 0) continue;
+                    int y = (ty + dy + tilesY) % tilesY;
+                    int x = (tx + dx + tilesX) % tilesX;
+                    neighbours[ty * tilesX + tx][n++] = y * tilesX + x;
+                }
+            }
+        }
+    }
+
+    generation = 0;
+    completed.reset(new std::atomic<long long>[tileCount]);
+    claimed.reset(new std::atomic<long long>[tileCount]);
+    lastChange.reset(new std::atomic<long long>[tileCount]);
+    for (int tile = 0; tile < tileCount; tile++)
+    {
+        completed[tile] = 0;
+        claimed[tile] = 0;
+        // Nothing is known about the loaded board, every tile starts active
+        lastChange[tile] = 0;
+    }
+    valid = true;
+}
+
+void TiledEngine::SetCell(int row, int column, bool alive)
+{
+    if (!valid) return;
+    size_t index = static_cast<size_t>(row) * columns + column;
+    int delta = static_cast<int>(alive) - static_cast<int>(planes[0][index]);
+    int tile = (row / tileSize) * tilesX + column / tileSize;
+    population += delta;
+    tilePopulation[tile] += delta;
+    planes[0][index] = alive;
+    planes[1][index] = alive;
+    lastChange[tile] = generation;
+}
+
+bool TiledEngine::TryClaim(int tile)
+{
+    long long previous = completed[tile].load();
+    if (previous >= targetGeneration || claimed[tile].load() != previous) return false;
+    for (int neighbour : neighbours[tile])
+    {
+        if (completed[neighbour].load() < previous) return false;
+    }
+    return claimed[tile].compare_exchange_strong(previous, previous + 1);
+}
+
+// A tile can only change if a cell within one of reach changed in the previous generation
+bool TiledEngine::IsActive(int tile, long long target) const
+{
+    if (lastChange[tile].load() >= target - 1) return true;
+    for (int neighbour : neighbours[tile])
+    {
+        if (lastChange[neighbour].load() >= target - 1) return true;
+    }
+    return false;
+}
+
+void TiledEngine::ComputeTile(int tile, long long target)
+{
+    const uint8_t* in = planes[(target - 1) & 1].data();
+    uint8_t* out = planes[target & 1].data();
+    const int rowBegin = (tile / tilesX) * tileSize;
+    const int rowEnd = std::min(rowBegin + tileSize, rows);
+    const int columnBegin = (tile % tilesX) * tileSize;
+    const int columnEnd = std::min(columnBegin + tileSize, columns);
+
+    bool changed = false;
+    int alive = 0;
+    for (int row = rowBegin; row < rowEnd; row++)
+    {
+        const uint8_t* up = in + static_cast<size_t>(row == 0 ? rows - 1 : row - 1) * columns;
+        const uint8_t* mid = in + static_cast<size_t>(row) * columns;
+        const uint8_t* down = in + static_cast<size_t>(row == rows - 1 ? 0 : row + 1) * columns;
+        uint8_t* result = out + static_cast<size_t>(row) * columns;
+        for (int column = columnBegin; column < columnEnd; column++)
+        {
+            int left = column == 0 ? columns - 1 : column - 1;
+            int right = column == columns - 1 ? 0 : column + 1;
+            int liveNeighbors = up[left] + up[column] + up[right] + mid[left] + mid[right] + down[left] +
+                down[column] + down[right];
+            uint16_t mask = mid[column] ? survivalMask : birthMask;
+            uint8_t next = static_cast<uint8_t>((mask >> liveNeighbors) & 1);
+            changed |= next != mid[column];
+            result[column] = next;
+            alive += next;
+        }
+    }
+    tilePopulation[tile] = alive;
+    if (changed) lastChange[tile].store(target);
+}
+
+void TiledEngine::Finish(int tile, long long finished, int worker, std::vector<int>& inlineTiles)
+{
+    completed[tile].store(finished);
+    remaining.fetch_sub(1);
+
+    auto release = [&](int candidate)
+    {
+        if (!TryClaim(candidate)) return;
+        if (IsActive(candidate, claimed[candidate].load()))
+        {
+            std::lock_guard<std::mutex> lock(workers[worker]->mutex);
+            workers[worker]->tasks.push_back(candidate);
+        }
+        else
+        {
+            inlineTiles.push_back(candidate);
+        }
+    };
+    release(tile);
+    for (int neighbour : neighbours[tile]) release(neighbour);
+}
+
+bool TiledEngine::PopOrSteal(int worker, int& tile)
+{
+    {
+        Worker& own = *workers[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            // Newest first: its neighbourhood is still in cache
+            tile = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (int i = 1; i < threadCount; i++)
+    {
+        Worker& victim = *workers[(worker + i) % threadCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            tile = victim.tasks.front();
+            victim.tasks.pop_front();
+            ++workers[worker]->steals;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TiledEngine::RunWorker(int worker)
+{
+    Worker& self = *workers[worker];
+    std::vector<int> inlineTiles;
+    while (remaining.load() > 0)
+    {
+        int tile;
+        if (!PopOrSteal(worker, tile))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const long long target = claimed[tile].load();
+        const long long start = NowNanos();
+        ComputeTile(tile, target);
+        ++self.tasksRun;
+        Finish(tile, target, worker, inlineTiles);
+        while (!inlineTiles.empty())
+        {
+            int quiet = inlineTiles.back();
+            inlineTiles.pop_back();
+            ++self.skipped;
+            Finish(quiet, claimed[quiet].load(), worker, inlineTiles);
+        }
+        self.busyNanos += NowNanos() - start;
+    }
+}
+
+void TiledEngine::GetTileBounds(int tile, int& rowBegin, int& rowEnd, int& columnBegin, int& columnEnd) const
+{
+    rowBegin = (tile / tilesX) * tileSize;
+    columnBegin = (tile % tilesX) * tileSize;
+    rowEnd = std::min(rowBegin + tileSize, rows);
+    columnEnd = std::min(columnBegin + tileSize, columns);
+}
+
+void TiledEngine::Advance(Grid& grid, const std::array<bool, 9>& birth, const std::array<bool, 9>& survival,
+                          long long generations)
+{
+    if (generations <= 0) return;
+    if (!valid) Rebuild(grid);
+
+    const int tileCount = tilesX * tilesY;
+    const long long startGeneration = generation;
+    birthMask = ToMask(birth);
+    survivalMask = ToMask(survival);
+    targetGeneration = generation + generations;
+    remaining = static_cast<long long>(tileCount) * generations;
+    for (auto& worker : workers)
+    {
+        worker->steals = worker->tasksRun = worker->skipped = worker->busyNanos = 0;
+    }
+
+    const long long wallStart = NowNanos();
+    // Seed the first generation, spreading active tiles over all deques
+    std::vector<int> inlineTiles;
+    for (int tile = 0; tile < tileCount; tile++)
+    {
+        if (!TryClaim(tile)) continue;
+        if (IsActive(tile, claimed[tile].load()))
+        {
+            workers[tile % threadCount]->tasks.push_back(tile);
+        }
+        else
+        {
+            inlineTiles.push_back(tile);
+        }
+    }
+    while (!inlineTiles.empty())
+    {
+        int quiet = inlineTiles.back();
+        inlineTiles.pop_back();
+        ++workers[0]->skipped;
+        Finish(quiet, claimed[quiet].load(), 0, inlineTiles);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(runMutex);
+        runningThreads = threadCount - 1;
+        ++runEpoch;
+    }
+    runSignal.notify_all();
+    RunWorker(0);
+    {
+        std::unique_lock<std::mutex> lock(runMutex);
+        runSignal.wait(lock, [&] { return runningThreads == 0; });
+    }
+    const long long wallNanos = std::max(NowNanos() - wallStart, 1LL);
+    generation = targetGeneration;
+
+    // Only tiles that changed during this run can differ from the grid
+    const uint8_t* result = planes[generation & 1].data();
+    population = 0;
+    changedTiles.clear();
+    for (int tile = 0; tile < tileCount; tile++)
+    {
+        population += tilePopulation[tile];
+        if (lastChange[tile].load() <= startGeneration) continue;
+        changedTiles.push_back(tile);
+        int rowBegin, rowEnd, columnBegin, columnEnd;
+        GetTileBounds(tile, rowBegin, rowEnd, columnBegin, columnEnd);
+        for (int row = rowBegin; row < rowEnd; row++)
+        {
+            for (int column = columnBegin; column < columnEnd; column++)
+            {
+                int value = result[static_cast<size_t>(row) * columns + column];
+                if (grid.Get(row, column) != value) grid.Set(row, column, value);
+            }
+        }
+    }
+
+    stats = TileSchedulerStats{};
+    stats.threads = threadCount;
+    stats.generations = generations;
+    long long busyNanos = 0;
+    for (auto& worker : workers)
+    {
+        stats.tasks += worker->tasksRun;
+        stats.skipped += worker->skipped;
+        stats.steals += worker->steals;
+        busyNanos += worker->busyNanos;
+    }
+    stats.utilization = static_cast<double>(busyNanos) / (static_cast<double>(wallNanos) * threadCount);
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "Grid.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct TileSchedulerStats
+{
+    int threads = 0;
+    long long generations = 0;
+    // Tile generations computed by a worker, and those skipped because nothing near them changed
+    long long tasks = 0;
+    long long skipped = 0;
+    long long steals = 0;
+    // Busy time of all workers over threads * wall time of the last Advance
+    double utilization = 0.0;
+};
+
+// Multi-threaded engine for two-state rules. The torus is cut into square tiles and
+// every (tile, generation) pair is a task. A tile may compute generation g + 1 as
+// soon as it and its eight neighbours finished g, so fast regions run ahead of busy
+// ones instead of waiting at a per-generation barrier. Cells live in two byte planes
+// (even and odd generations); the dependency rule guarantees a plane is only
+// overwritten after every neighbour has read it.
+// Tiles whose neighbourhood did not change in the previous generation are completed
+// without being queued. Ready tiles go to the deque of the worker that released
+// them; idle workers steal from the other end of another worker's deque.
+class TiledEngine
+{
+public:
+    TiledEngine();
+    ~TiledEngine();
+
+    TiledEngine(const TiledEngine&) = delete;
+    TiledEngine& operator=(const TiledEngine&) = delete;
+
+    // threads <= 0 uses every hardware thread; takes effect on the next Rebuild
+    void Configure(int threads, int tileSize);
+    int GetThreadCount() const { return threadCount; }
+    int GetTileSize() const { return tileSize; }
+
+    void Rebuild(const Grid& grid);
+    void Invalidate() { valid = false; }
+    bool IsValid() const { return valid; }
+
+    // Runs generations steps and writes changed cells back to grid
+    void Advance(Grid& grid, const std::array<bool, 9>& birth, const std::array<bool, 9>& survival,
+                 long long generations);
+    void SetCell(int row, int column, bool alive);
+
+    long long GetPopulation() const { return population; }
+    const TileSchedulerStats& GetStats() const { return stats; }
+    // Tiles whose cells the last Advance wrote back, and the cells a tile covers
+    const std::vector<int>& GetChangedTiles() const { return changedTiles; }
+    void GetTileBounds(int tile, int& rowBegin, int& rowEnd, int& columnBegin, int& columnEnd) const;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<int> tasks;
+        long long steals = 0;
+        long long tasksRun = 0;
+        long long skipped = 0;
+        long long busyNanos = 0;
+    };
+
+    void StartThreads();
+    void StopThreads();
+    void ThreadMain(int worker);
+    void RunWorker(int worker);
+
+    bool TryClaim(int tile);
+    void Finish(int tile, long long finished, int worker, std::vector<int>& inlineTiles);
+    bool IsActive(int tile, long long target) const;
+    void ComputeTile(int tile, long long target);
+    bool PopOrSteal(int worker, int& tile);
+
+    int threadCount = 0;
+    int tileSize = 64;
+    bool valid = false;
+
+    int rows = 0;
+    int columns = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    std::vector<uint8_t> planes[2];
+    std::vector<std::array<int, 8>> neighbours;
+
+    // Per tile: last finished generation, generation handed out, last generation that changed a cell
+    std::unique_ptr<std::atomic<long long>[]> completed;
+    std::unique_ptr<std::atomic<long long>[]> claimed;
+    std::unique_ptr<std::atomic<long long>[]> lastChange;
+    std::vector<int> tilePopulation;
+    std::vector<int> changedTiles;
+
+    long long generation = 0;
+    long long targetGeneration = 0;
+    uint16_t birthMask = 0;
+    uint16_t survivalMask = 0;
+    std::atomic<long long> remaining{0};
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::mutex runMutex;
+    std::condition_variable runSignal;
+    long long runEpoch = 0;
+    int runningThreads = 0;
+    bool stopping = false;
+
+    long long population = 0;
+    TileSchedulerStats stats;
+};
@@ -1,10 +1,118 @@
 #include "raylib.h"
 #include "Simulation.h"
+#include "HeadlessRunner.h"
+#include "AsyncIo.h"
+#include "ChangeStream.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <memory>
 #include <vector>
 #include <string>
 
-int main()
+// What the main window shows; overlays animate, so a frame with one is never reused
+struct FrameState
+{
+    long long boardRevision = -1;
+    bool running = false;
+    int targetFPS = 0;
+    bool recording = false;
+    bool overlay = false;
+
+    bool operator==(const FrameState& other) const = default;
+};
+
+// --view <path>: shows the change stream of another process (see --stream in headless mode)
+static int RunViewer(const std::string& path)
 {
+    const int WINDOW_WIDTH = 1920;
+    const int WINDOW_HEIGHT = 1200;
+    InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Game of Life - Viewer");
+    SetTargetFPS(60);
+
+    ChangeStreamReader reader;
+    std::string status = "Connecting to " + path;
+    int retryFrames = 0;
+
+    while (!WindowShouldClose())
+    {
+        if (!reader.IsOpen() && retryFrames-- <= 0)
+        {
+            std::string err;
+            status = reader.Open(path, &err) ? "Connected to " + path : err;
+            retryFrames = 60;
+        }
+        reader.Poll();
+
+        BeginDrawing();
+        ClearBackground(Color{25, 25, 25, 255});
+        if (reader.HasBoard())
+        {
+            const PackedBoard& board = reader.GetBoard();
+            int cellSize = std::max(1, std::min(WINDOW_WIDTH / board.GetColumns(), WINDOW_HEIGHT / board.GetRows()));
+            for (int row = 0; row < board.GetRows(); row++)
+            {
+                // Live cells are state 1: plane 0 set, no higher plane set
+                for (int w = 0; w < board.GetWordsPerRow(); w++)
+                {
+                    uint64_t higher = 0;
+                    for (int plane = 1; plane < board.GetPlanes(); plane++) higher |= board.Row(row, plane)[w];
+                    for (uint64_t bits = board.Row(row)[w] & ~higher; bits != 0; bits &= bits - 1)
+                    {
+                        int column = w * 64 + std::countr_zero(bits);
+                        DrawRectangle(column * cellSize, row * cellSize, std::max(cellSize - 1, 1),
+                                      std::max(cellSize - 1, 1), GREEN);
+                    }
+                }
+            }
+            DrawText(TextFormat("Generation: %lld", reader.GetGeneration()), 10, 40, 20, LIGHTGRAY);
+        }
+        DrawText(status.c_str(), 10, 10, 20, reader.IsOpen() ? LIGHTGRAY : RED);
+        EndDrawing();
+    }
+
+    CloseWindow();
+    return 0;
+}
+
+// A new file per run under the temp directory, so relaunching after a crash keeps the
+// log of the session that crashed
+static std::string NewSessionLogPath()
+{
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "GameOfLife";
+    std::filesystem::create_directories(directory, error);
+
+    std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+    std::filesystem::path path = directory / (std::string("session-") + stamp + ".golr");
+    for (int suffix = 2; std::filesystem::exists(path, error); ++suffix)
+    {
+        path = directory / (std::string("session-") + stamp + "-" + std::to_string(suffix) + ".golr");
+    }
+    return path.string();
+}
+
+int main(int argc, char** argv)
+{
+    if (IsHeadlessInvocation(argc, argv))
+    {
+        return RunHeadless(argc, argv);
+    }
+    // Every session is logged so it can be replayed with --headless --replay <log>
+    std::string sessionLogPath;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--view") == 0) return RunViewer(argv[i + 1]);
+        if (std::strcmp(argv[i], "--session-log") == 0) sessionLogPath = argv[i + 1];
+    }
+    if (sessionLogPath.empty()) sessionLogPath = NewSessionLogPath();
+    std::printf("session log: %s\n", sessionLogPath.c_str());
+
     const int WINDOW_WIDTH = 1920;
     const int WINDOW_HEIGHT = 1200;
     const int CELL_SIZE = 10;
@@ -15,12 +123,31 @@ int main()
     SetTargetFPS(currentTargetFPS);
 
     Simulation simulation(WINDOW_WIDTH, WINDOW_HEIGHT, CELL_SIZE);
+    simulation.EnableHistory(64);
+    std::string sessionLogError;
+    simulation.StartSessionLog(sessionLogPath, &sessionLogError);
 
     bool showClearDialog = false;
 
     std::vector<std::string> lifeWarnings;
-    bool showWarnings = false;
-    int warningsTimer = 0;
+    if (!sessionLogError.empty()) lifeWarnings.push_back(sessionLogError);
+    bool showWarnings = !lifeWarnings.empty();
+    int warningsTimer = showWarnings ? 600 : 0;
+
+    // Pattern files are read and written off the frame loop
+    AsyncIo io;
+
+    // Brush and stamp state for the edit buffer
+    int brushRadius = 0;
+    int strokeRow = 0;
+    int strokeColumn = 0;
+    bool rectangleDrag = false;
+    std::shared_ptr<const PackedBoard> stampPattern;
+    int stampOrientation = 0;
+
+    // Last frame put on screen; while it is still current the loop sleeps on input events
+    FrameState drawnState;
+    bool waitingForEvents = false;
 
     // Button dimensions
     const int BUTTON_WIDTH = 300;
@@ -31,12 +158,47 @@ int main()
     {
         if (!showClearDialog)
         {
-            if (IsMouseButtonDown(MOUSE_LEFT_BUTTON))
+            // Left paints, right erases; the stroke joins the cell under the mouse in the
+            // previous frame so fast drags leave no gaps. Shift+drag fills a rectangle.
+            Vector2 mousePos = GetMousePosition();
+            int mouseRow = static_cast<int>(mousePos.y) / CELL_SIZE;
+            int mouseColumn = static_cast<int>(mousePos.x) / CELL_SIZE;
+            brushRadius = std::clamp(brushRadius + static_cast<int>(GetMouseWheelMove()), 0, 20);
+            bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+            for (int button : {MOUSE_LEFT_BUTTON, MOUSE_RIGHT_BUTTON})
             {
-                Vector2 mousePos = GetMousePosition();
-                int row = static_cast<int>(mousePos.y) / CELL_SIZE;
-                int column = static_cast<int>(mousePos.x) / CELL_SIZE;
-                simulation.ToggleCell(row, column);
+                int state = button == MOUSE_LEFT_BUTTON ? 1 : 0;
+                if (IsMouseButtonPressed(button))
+                {
+                    strokeRow = mouseRow;
+                    strokeColumn = mouseColumn;
+                    rectangleDrag = shift;
+                }
+                if (rectangleDrag)
+                {
+                    if (IsMouseButtonReleased(button))
+                    {
+                        simulation.Edits().FillRect(strokeRow, strokeColumn, mouseRow, mouseColumn, state);
+                    }
+                    continue;
+                }
+                if (IsMouseButtonDown(button))
+                {
+                    simulation.Edits().Stroke(strokeRow, strokeColumn, mouseRow, mouseColumn, brushRadius, state);
+                    strokeRow = mouseRow;
+                    strokeColumn = mouseColumn;
+                }
+            }
+
+            // P stamps the last loaded pattern at the mouse, Q turns it
+            if (IsKeyPressed(KEY_P) && stampPattern)
+            {
+                simulation.Edits().Stamp(stampPattern, mouseRow, mouseColumn, stampOrientation);
+            }
+
+            if (IsKeyPressed(KEY_Q))
+            {
+                stampOrientation = (stampOrientation + 1) % 8;
             }
 
             if (IsKeyPressed(KEY_ENTER))
@@ -69,14 +231,48 @@ int main()
 
             if (IsKeyPressed(KEY_O))
             {
-                lifeWarnings.clear();
-                bool ok = simulation.LoadFromLife106("pattern.lif", lifeWarnings);
-                showWarnings = true;
-                warningsTimer = 600;
-                if (!ok)
+                io.LoadLife106("pattern.lif", simulation.GetRows(), simulation.GetColumns());
+            }
+
+            if (IsKeyPressed(KEY_S))
+            {
+                io.SaveLife106("pattern_out.lif", simulation.TakeSnapshot());
+            }
+
+            // Scrub through history while paused
+            if (!simulation.IsRunning() && IsKeyPressed(KEY_LEFT))
+            {
+                simulation.StepBack();
+            }
+
+            if (!simulation.IsRunning() && IsKeyPressed(KEY_RIGHT))
+            {
+                simulation.Step();
+            }
+
+            if (IsKeyPressed(KEY_A))
+            {
+                simulation.SetAgeTracking(!simulation.IsAgeTracking());
+            }
+
+            if (IsKeyPressed(KEY_V))
+            {
+                if (simulation.GetRecorder().IsOpen())
+                {
+                    std::string err;
+                    lifeWarnings = {simulation.StopRecording(&err) ? "Saved recording.y4m" : err};
+                }
+                else
                 {
-                    lifeWarnings.push_back("Failed to load pattern.lif");
+                    RecordOptions record;
+                    record.path = "recording.y4m";
+                    record.format = RecordFormat::Y4m;
+                    record.framesPerSecond = currentTargetFPS;
+                    std::string err;
+                    lifeWarnings = {simulation.StartRecording(record, &err) ? "Recording to recording.y4m" : err};
                 }
+                showWarnings = true;
+                warningsTimer = 600;
             }
 
             if (IsKeyPressed(KEY_F1))
@@ -88,16 +284,70 @@ int main()
             simulation.Update();
         }
 
+        IoJobResult ioResult;
+        while (io.Poll(ioResult))
+        {
+            lifeWarnings = std::move(ioResult.warnings);
+            if (ioResult.kind == IoJobResult::Kind::Load)
+            {
+                if (ioResult.ok)
+                {
+                    simulation.ApplySnapshot(*ioResult.loaded);
+                    stampPattern = std::make_shared<PackedBoard>(EditBuffer::Trim(ioResult.loaded->cells));
+                }
+                else
+                {
+                    lifeWarnings.push_back("Failed to load " + ioResult.path);
+                }
+            }
+            else
+            {
+                lifeWarnings.push_back((ioResult.ok ? "Saved " : "Failed to save ") + ioResult.path);
+            }
+            showWarnings = true;
+            warningsTimer = 600;
+        }
+
+        // A paused, unchanged board is not redrawn: the last frame stays on screen and
+        // the loop blocks until the next input event instead of spinning at the target FPS
+        FrameState frameState{simulation.GetBoardRevision(), simulation.IsRunning(), currentTargetFPS,
+                              simulation.GetRecorder().IsOpen(),
+                              showClearDialog || (showWarnings && !lifeWarnings.empty()) || io.IsBusy()};
+        if (frameState == drawnState && !frameState.overlay)
+        {
+            if (!waitingForEvents) EnableEventWaiting();
+            waitingForEvents = true;
+            PollInputEvents();
+            continue;
+        }
+        if (waitingForEvents) DisableEventWaiting();
+        waitingForEvents = false;
+        drawnState = frameState;
+
         // Drawing
         BeginDrawing();
         ClearBackground(Color{25, 25, 25, 255});
         simulation.Draw();
 
         // Instructions
-        DrawText("ENTER - Start | SPACE - Pause | R - Random | C - Clear | F - Speed | O - Load pattern.lif", 10, 10,
-                 20, LIGHTGRAY);
+        DrawText("ENTER - Start | SPACE - Pause | R - Random | C - Clear | F - Speed | O - Load pattern.lif | "
+                 "S - Save pattern_out.lif | A - Age heatmap | V - Record | P/Q - Stamp/turn loaded pattern",
+                 10, 10, 20, LIGHTGRAY);
         DrawText(TextFormat("%s | Target FPS: %d", simulation.IsRunning() ? "Running" : "Paused", currentTargetFPS),
                  WINDOW_WIDTH - 400, 10, 20, simulation.IsRunning() ? GREEN : RED);
+        DrawText(TextFormat("Generation: %lld | LEFT/RIGHT - Step back/forward", simulation.GetGeneration()), 10, 40,
+                 20, LIGHTGRAY);
+
+        if (simulation.GetRecorder().IsOpen())
+        {
+            DrawText("REC", WINDOW_WIDTH - 400, 100, 20, RED);
+        }
+
+        if (io.IsBusy())
+        {
+            DrawText(TextFormat("File I/O: %d%%", static_cast<int>(io.GetProgress() * 100.0f)), WINDOW_WIDTH - 400,
+                     70, 20, YELLOW);
+        }
 
         // Show universe name if any
         if (!simulation.GetUniverseName().empty())
@@ -196,6 +446,7 @@ int main()
         EndDrawing();
     }
 
+    simulation.StopSessionLog();
     CloseWindow();
     return 0;
 }
@@ -1,7 +1,88 @@
 #include <gtest/gtest.h>
 #include "Grid.h"
 #include "Simulation.h"
+#include "AsyncIo.h"
+#include "ChangeStream.h"
+#include "GameOfLifeC.h"
+#include "HeadlessRunner.h"
+#include "MetricsServer.h"
+#include "PagedBoard.h"
+#include "RuleExplorer.h"
+#include "SparseEngine.h"
+#ifdef GOL_SLAB_CLUSTER
+#include "SlabCluster.h"
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <tuple>
+
+TEST(GridLayouts, BitsPlanesAndBytesHoldTheSameBoard)
+{
+    // 130 columns leave a partial last word in the packed layouts
+    Grid bytes(130, 9, 1);
+    BasicGrid<BitCells> bits(130, 9, 1);
+    // Plane count picked at run time, as for a Generations rule
+    BasicGrid<PlaneCells> planes(130, 9, 1, nullptr, PlaneCells{PlanesForStates(8)});
+    bytes.FillRandom(3u);
+    bits.FillRandom(3u);
+    planes.FillRandom(3u);
+    EXPECT_EQ(bits.GetStride(), 3u);
+    EXPECT_EQ(planes.GetStride(), 9u);
+    EXPECT_EQ(planes.GetLayout().MaxStates(), 8);
+
+    bytes.SetCellValue(4, 127, 1);
+    bytes.SetCellValue(4, 128, 1);
+    bits.SetCellValue(4, 127, 1);
+    bits.SetCellValue(4, 128, 1);
+    planes.SetCellValue(4, 127, 1);
+    planes.SetCellValue(4, 128, 1);
+    bits.ToggleCell(8, 64);
+    bytes.ToggleCell(8, 64);
+    planes.ToggleCell(8, 64);
+    for (int r = 0; r < 9; ++r)
+    {
+        for (int c = 0; c < 130; ++c) ASSERT_EQ(bits.GetCellValue(r, c), bytes.GetCellValue(r, c)) << r << "," << c;
+    }
+    EXPECT_EQ(bits.GetCellValue(9, 0), 0);
+
+    // Multi-state spans blend the same way in planes and bytes
+    uint8_t values[64];
+    for (int i = 0; i < 64; ++i) values[i] = static_cast<uint8_t>(i % 8);
+    planes.SetCellValue(2, 128, 5);
+    bytes.SetCellValue(2, 128, 5);
+    uint64_t planesWereSet = 0;
+    uint64_t bytesWereSet = 0;
+    EXPECT_EQ(planes.BlendSpan(2, 2, 0b11, values, planesWereSet), bytes.BlendSpan(2, 2, 0b11, values, bytesWereSet));
+    EXPECT_EQ(planesWereSet, bytesWereSet);
+    for (int r = 0; r < 9; ++r)
+    {
+        for (int c = 0; c < 130; ++c) ASSERT_EQ(planes.GetCellValue(r, c), bytes.GetCellValue(r, c)) << r << "," << c;
+    }
+
+    // Ages follow state 1 whatever the layout
+    bits.EnableAges(true);
+    bytes.EnableAges(true);
+    bits.AdvanceAges();
+    bytes.AdvanceAges();
+    bits.Set(0, 0, 0);
+    bytes.Set(0, 0, 0);
+    bits.AdvanceAges();
+    bytes.AdvanceAges();
+    for (int c = 0; c < 130; ++c) ASSERT_EQ(bits.GetCellAge(1, c), bytes.GetCellAge(1, c)) << c;
+    EXPECT_EQ(bits.GetCellAge(0, 0), 0);
+}
 
 static Simulation makeSmallSim()
 {
@@ -26,6 +107,45 @@ TEST(GridBasics, SetGetToggleClear)
     EXPECT_EQ(g.GetCellValue(1,2), 0);
 }
 
+TEST(Arena, GridsShareOneAlignedRegionAcrossResizes)
+{
+    Arena arena(4096);
+    void* first = arena.Allocate(10);
+    void* second = arena.Allocate(100);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % Arena::kAlignment, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % Arena::kAlignment, 0u);
+    EXPECT_EQ(arena.GetUsed(), 64u + 128u);
+    EXPECT_EQ(arena.Allocate(8192), nullptr);
+    arena.Reset();
+    EXPECT_EQ(arena.Allocate(10), first);
+
+    Simulation sim(64, 48, 1);
+    sim.SetAgeTracking(true);
+    const size_t capacity = sim.GetArena().GetCapacity();
+    EXPECT_GE(sim.GetArena().GetUsed(), 2 * 64 * 48 * sizeof(Grid::Word));
+
+    sim.ResizeBoard(20, 30);
+    EXPECT_EQ(sim.GetArena().GetCapacity(), capacity);
+    EXPECT_EQ(sim.GetRows(), 20);
+    EXPECT_EQ(sim.GetColumns(), 30);
+    EXPECT_TRUE(sim.IsAgeTracking());
+    EXPECT_EQ(sim.GetPopulation(), 0);
+
+    // Blinker still oscillates on the resized board, wrapping at the new edges
+    sim.ToggleCell(19, 29);
+    sim.ToggleCell(0, 29);
+    sim.ToggleCell(1, 29);
+    sim.Step();
+    EXPECT_EQ(sim.GetCellValue(0, 28), 1);
+    EXPECT_EQ(sim.GetCellValue(0, 29), 1);
+    EXPECT_EQ(sim.GetCellValue(0, 0), 1);
+    EXPECT_EQ(sim.GetPopulation(), 3);
+
+    sim.ResizeBoard(300, 400);
+    EXPECT_GE(sim.GetArena().GetCapacity(), 2 * Grid::ArenaBytes(300, 400));
+    EXPECT_EQ(sim.GetCellValue(299, 399), 0);
+}
+
 TEST(SimulationStep, BlinkerOscillator)
 {
     Simulation sim = makeSmallSim();
@@ -108,8 +228,1737 @@ TEST(ParserWarnings, DuplicateCoordinateWarning)
     std::remove(path.c_str());
 }
 
+static std::vector<int> snapshotCells(const Simulation& sim)
+{
+    std::vector<int> cells;
+    for (int r = 0; r < sim.GetRows(); ++r)
+    {
+        for (int c = 0; c < sim.GetColumns(); ++c)
+        {
+            cells.push_back(sim.GetCellValue(r, c));
+        }
+    }
+    return cells;
+}
+
+static void placeGlider(Simulation& sim, int row, int column)
+{
+    sim.ToggleCell(row, column + 1);
+    sim.ToggleCell(row + 1, column + 2);
+    sim.ToggleCell(row + 2, column);
+    sim.ToggleCell(row + 2, column + 1);
+    sim.ToggleCell(row + 2, column + 2);
+}
+
+TEST(History, StepBackAndSeekRebuildPastGenerations)
+{
+    Simulation sim(200, 200, 10);
+    placeGlider(sim, 2, 2);
+    sim.EnableHistory(1, 4);
+
+    std::vector<std::vector<int>> states{snapshotCells(sim)};
+    for (int i = 0; i < 10; ++i)
+    {
+        sim.Step();
+        states.push_back(snapshotCells(sim));
+    }
+
+    EXPECT_TRUE(sim.StepBack());
+    EXPECT_EQ(sim.GetGeneration(), 9);
+    EXPECT_EQ(snapshotCells(sim), states[9]);
+
+    EXPECT_TRUE(sim.SeekTo(3));
+    EXPECT_EQ(snapshotCells(sim), states[3]);
+    EXPECT_TRUE(sim.SeekTo(10));
+    EXPECT_EQ(snapshotCells(sim), states[10]);
+    EXPECT_FALSE(sim.SeekTo(11));
+
+    // Edits after seeking back replace the recorded future
+    sim.SeekTo(5);
+    sim.ToggleCell(15, 15);
+    sim.Step();
+    EXPECT_EQ(sim.GetHistory().GetNewestGeneration(), 6);
+    EXPECT_TRUE(sim.SeekTo(5));
+    EXPECT_EQ(sim.GetCellValue(15, 15), 1);
+}
+
+TEST(History, BudgetEvictsOldestFirst)
+{
+    Simulation sim(600, 600, 1);
+    sim.CreateRandomState();
+    sim.EnableHistory(1, 8);
+    for (int i = 0; i < 40; ++i)
+    {
+        sim.Step();
+    }
+    const History& history = sim.GetHistory();
+    EXPECT_LE(history.GetUsedBytes(), 1024u * 1024u);
+    EXPECT_GT(history.GetOldestGeneration(), 0);
+    EXPECT_EQ(history.GetNewestGeneration(), 40);
+    EXPECT_TRUE(sim.SeekTo(history.GetOldestGeneration()));
+    EXPECT_FALSE(sim.SeekTo(history.GetOldestGeneration() - 1));
+}
+
+TEST(SparseEngine, MatchesDenseEngineAndIsChosenForSparseBoards)
+{
+    Simulation dense(64, 48, 1);
+    Simulation sparse(64, 48, 1);
+    dense.SetStepEngine(StepEngine::Dense);
+    sparse.SetStepEngine(StepEngine::Sparse);
+    for (Simulation* sim : {&dense, &sparse})
+    {
+        placeGlider(*sim, 2, 2);
+        placeGlider(*sim, 20, 30);
+        sim->ToggleCell(40, 10);
+        sim->ToggleCell(40, 11);
+        sim->ToggleCell(40, 12);
+    }
+
+    for (int i = 0; i < 150; ++i)
+    {
+        dense.Step();
+        sparse.Step();
+        // Edits between generations must reach the incremental counts too
+        if (i == 70)
+        {
+            dense.ToggleCell(10, 10);
+            sparse.ToggleCell(10, 10);
+        }
+        ASSERT_EQ(snapshotCells(sparse), snapshotCells(dense)) << "generation " << i + 1;
+        ASSERT_EQ(sparse.GetPopulation(), dense.GetPopulation());
+    }
+    EXPECT_EQ(sparse.GetActiveEngine(), StepEngine::Sparse);
+
+    Simulation automatic(64, 48, 1);
+    placeGlider(automatic, 2, 2);
+    automatic.Step();
+    EXPECT_EQ(automatic.GetActiveEngine(), StepEngine::Sparse);
+    automatic.CreateRandomState();
+    automatic.Step();
+    EXPECT_EQ(automatic.GetActiveEngine(), StepEngine::Dense);
+
+    // A glider crossing a big board keeps only the tiles around it
+    Grid big(4096, 4096, 1);
+    for (auto [r, c] : {std::pair{0, 1}, {1, 2}, {2, 0}, {2, 1}, {2, 2}}) big.SetCellValue(r + 100, c + 100, 1);
+    SparseEngine engine;
+    engine.Rebuild(big);
+    const std::array<bool, 9> birth{false, false, false, true};
+    const std::array<bool, 9> survival{false, false, true, true};
+    for (int i = 0; i < 1000; ++i)
+    {
+        engine.Step(big, birth, survival);
+        ASSERT_LE(engine.GetTileCount(), 4u) << "generation " << i + 1;
+    }
+    EXPECT_EQ(engine.GetPopulation(), 5u);
+    EXPECT_EQ(big.GetCellValue(352, 352), 1);
+}
+
+TEST(BitSlicedEngine, MatchesDenseEngineOnOddWidths)
+{
+    for (int width : {1, 3, 63, 64, 70, 130})
+    {
+        Simulation dense(width, 37, 1);
+        Simulation sliced(width, 37, 1);
+        dense.SetStepEngine(StepEngine::Dense);
+        sliced.SetStepEngine(StepEngine::BitSliced);
+        dense.CreateRandomState();
+        for (int r = 0; r < dense.GetRows(); ++r)
+        {
+            for (int c = 0; c < dense.GetColumns(); ++c)
+            {
+                sliced.SetCellValue(r, c, dense.GetCellValue(r, c));
+            }
+        }
+        for (int i = 0; i < 40; ++i)
+        {
+            dense.Step();
+            sliced.Step();
+            ASSERT_EQ(snapshotCells(sliced), snapshotCells(dense)) << "width " << width << " generation " << i + 1;
+        }
+        EXPECT_EQ(sliced.GetPopulation(), dense.GetPopulation());
+    }
+}
+
+TEST(BlockLookupEngine, MatchesDenseEngineAndReusesTable)
+{
+    // Odd sizes leave half blocks on the last row and column; B36/S23 and B0 exercise other table contents
+    for (const char* rule : {"B3/S23", "B36/S23", "B0123478/S34678"})
+    {
+        for (int width : {1, 3, 61, 64, 127})
+        {
+            Simulation dense(width, 33, 1);
+            Simulation block(width, 33, 1);
+            ASSERT_TRUE(dense.SetRule(rule));
+            ASSERT_TRUE(block.SetRule(rule));
+            dense.SetStepEngine(StepEngine::Dense);
+            block.SetStepEngine(StepEngine::BlockLookup);
+            dense.CreateRandomState();
+            for (int r = 0; r < dense.GetRows(); ++r)
+            {
+                for (int c = 0; c < dense.GetColumns(); ++c) block.SetCellValue(r, c, dense.GetCellValue(r, c));
+            }
+            for (int i = 0; i < 25; ++i)
+            {
+                dense.Step();
+                block.Step();
+                ASSERT_EQ(snapshotCells(block), snapshotCells(dense))
+                    << rule << " width " << width << " generation " << i + 1;
+            }
+            EXPECT_EQ(block.GetPopulation(), dense.GetPopulation());
+            EXPECT_EQ(block.GetActiveEngine(), StepEngine::BlockLookup);
+        }
+    }
+
+    BlockLookupEngine engine;
+    Grid grid(8, 8, 1);
+    std::array<bool, 9> birth{};
+    std::array<bool, 9> survival{};
+    birth[3] = survival[2] = survival[3] = true;
+    engine.Rebuild(grid);
+    engine.Step(grid, birth, survival);
+    engine.Step(grid, birth, survival);
+    EXPECT_EQ(engine.GetTableBuilds(), 1);
+    birth[6] = true;
+    engine.Step(grid, birth, survival);
+    EXPECT_EQ(engine.GetTableBuilds(), 2);
+}
+
+TEST(TiledEngine, MatchesDenseEngineWithoutGenerationBarrier)
+{
+    for (int tileSize : {5, 16})
+    {
+        Simulation dense(53, 41, 1);
+        Simulation tiled(53, 41, 1);
+        dense.SetStepEngine(StepEngine::Dense);
+        tiled.SetStepEngine(StepEngine::Tiled);
+        tiled.ConfigureTiles(4, tileSize);
+        dense.CreateRandomState();
+        for (int r = 0; r < dense.GetRows(); ++r)
+        {
+            for (int c = 0; c < dense.GetColumns(); ++c) tiled.SetCellValue(r, c, dense.GetCellValue(r, c));
+        }
+
+        for (int i = 0; i < 3; ++i) dense.Step();
+        for (int i = 0; i < 3; ++i) tiled.Step();
+        ASSERT_EQ(snapshotCells(tiled), snapshotCells(dense)) << "tile size " << tileSize;
+
+        // Edits between runs must reach the engine
+        dense.ToggleCell(20, 20);
+        tiled.ToggleCell(20, 20);
+        for (int i = 0; i < 40; ++i) dense.Step();
+        tiled.Advance(40);
+        ASSERT_EQ(snapshotCells(tiled), snapshotCells(dense)) << "tile size " << tileSize;
+        EXPECT_EQ(tiled.GetPopulation(), dense.GetPopulation());
+        EXPECT_EQ(tiled.GetGeneration(), 43);
+
+        const TileSchedulerStats& stats = tiled.GetTileStats();
+        long long tiles = static_cast<long long>((53 + tileSize - 1) / tileSize) * ((41 + tileSize - 1) / tileSize);
+        EXPECT_EQ(stats.threads, 4);
+        EXPECT_EQ(stats.tasks + stats.skipped, tiles * 40);
+    }
+
+    // A lone glider leaves most tiles quiet, they must be skipped rather than queued
+    Simulation sparse(200, 200, 1);
+    sparse.SetStepEngine(StepEngine::Tiled);
+    sparse.ConfigureTiles(2, 16);
+    placeGlider(sparse, 10, 10);
+    sparse.Advance(20);
+    EXPECT_EQ(sparse.GetPopulation(), 5);
+    EXPECT_GT(sparse.GetTileStats().skipped, sparse.GetTileStats().tasks);
+}
+
+TEST(GenerationsRules, ParseAndFormatRuleStrings)
+{
+    std::array<bool, 9> b{};
+    std::array<bool, 9> s{};
+    int states = 0;
+    ASSERT_TRUE(Simulation::ParseRule("B2/S/C3", b, s, states));
+    EXPECT_EQ(Simulation::FormatRule(b, s, states), "B2/S/C3");
+    ASSERT_TRUE(Simulation::ParseRule("345/2/4", b, s, states));
+    EXPECT_EQ(Simulation::FormatRule(b, s, states), "B2/S345/C4");
+    ASSERT_TRUE(Simulation::ParseRule("b3 / s23", b, s, states));
+    EXPECT_EQ(Simulation::FormatRule(b, s, states), "B3/S23");
+    ASSERT_TRUE(Simulation::ParseRule("B3S23", b, s, states));
+    EXPECT_FALSE(Simulation::ParseRule("B9/S23", b, s, states));
+    EXPECT_FALSE(Simulation::ParseRule("B3/S23/C1", b, s, states));
+    EXPECT_FALSE(Simulation::ParseRule("B3", b, s, states));
+}
+
+TEST(GenerationsRules, BrainsBrainMatchesReferenceAndRoundTrips)
+{
+    const std::string path = "tests_tmp_brain.lif";
+    std::ofstream out(path);
+    out << "Life 1.06\n";
+    out << "#N brain\n";
+    out << "#R B2/S/C3\n";
+    out << "0 0\n";
+    out << "1 0\n";
+    out << "0 1\n";
+    out << "5 5\n";
+    out << "6 5\n";
+    out.close();
+
+    Simulation dense(90, 40, 1);
+    Simulation sliced(90, 40, 1);
+    dense.SetStepEngine(StepEngine::Dense);
+    std::vector<std::string> warnings;
+    ASSERT_TRUE(dense.LoadFromLife106(path, warnings));
+    EXPECT_TRUE(warnings.empty());
+    ASSERT_TRUE(sliced.LoadFromLife106(path, warnings));
+    EXPECT_EQ(sliced.GetStates(), 3);
+    EXPECT_EQ(sliced.GetRuleString(), "B2/S/C3");
+
+    bool sawDying = false;
+    for (int i = 0; i < 60; ++i)
+    {
+        dense.Step();
+        sliced.Step();
+        ASSERT_EQ(snapshotCells(sliced), snapshotCells(dense)) << "generation " << i + 1;
+        for (int v : snapshotCells(sliced)) sawDying |= v == 2;
+    }
+    EXPECT_EQ(sliced.GetActiveEngine(), StepEngine::BitSliced);
+    EXPECT_TRUE(sawDying);
+
+    ASSERT_TRUE(sliced.SaveToLife106(path));
+    Simulation reloaded(90, 40, 1);
+    warnings.clear();
+    ASSERT_TRUE(reloaded.LoadFromLife106(path, warnings));
+    EXPECT_EQ(reloaded.GetRuleString(), "B2/S/C3");
+    std::remove(path.c_str());
+}
+
+TEST(LargerThanLife, RangeOneMatchesConwayAndRoundTrips)
+{
+    Simulation life(50, 31, 1);
+    Simulation ranged(50, 31, 1);
+    life.SetStepEngine(StepEngine::Dense);
+    ASSERT_TRUE(ranged.SetRule("R1,C0,M0,S2..3,B3..3,NM"));
+    EXPECT_EQ(ranged.GetRuleString(), "R1,C0,M0,S2..3,B3..3,NM");
+    life.CreateRandomState();
+    for (int r = 0; r < life.GetRows(); ++r)
+    {
+        for (int c = 0; c < life.GetColumns(); ++c) ranged.SetCellValue(r, c, life.GetCellValue(r, c));
+    }
+    for (int i = 0; i < 30; ++i)
+    {
+        life.Step();
+        ranged.Step();
+        ASSERT_EQ(snapshotCells(ranged), snapshotCells(life)) << "generation " << i + 1;
+    }
+    EXPECT_EQ(ranged.GetActiveEngine(), StepEngine::LargerThanLife);
+
+    LargerThanLifeRule rule;
+    ASSERT_TRUE(ParseLargerThanLifeRule("r5,c0,m1,s34..58,b34..45,nm", rule));
+    EXPECT_EQ(FormatLargerThanLifeRule(rule), "R5,C0,M1,S34..58,B34..45,NM");
+    EXPECT_FALSE(ParseLargerThanLifeRule("R2,C0,M0,S2..30,B3..3,NN", rule));
+    EXPECT_FALSE(ParseLargerThanLifeRule("R11,C0,M0,S2..3,B3..3,NM", rule));
+
+    ASSERT_TRUE(ranged.SetRule("B3/S23"));
+    EXPECT_FALSE(ranged.GetRangeRule().has_value());
+}
+
+TEST(LargerThanLife, RunningSumsMatchDirectCount)
+{
+    // Bosco's rule, a von Neumann rule with decay and a long range on a small board
+    for (const char* rule : {"R5,C0,M1,S34..58,B34..45,NM", "R3,C4,M0,S4..9,B5..8,NN", "R7,C0,M1,S20..60,B25..40,NM"})
+    {
+        Simulation reference(23, 41, 1);
+        Simulation ranged(23, 41, 1);
+        reference.SetStepEngine(StepEngine::Dense);
+        ASSERT_TRUE(reference.SetRule(rule));
+        ASSERT_TRUE(ranged.SetRule(rule));
+        reference.CreateRandomState();
+        for (int r = 0; r < reference.GetRows(); ++r)
+        {
+            for (int c = 0; c < reference.GetColumns(); ++c) ranged.SetCellValue(r, c, reference.GetCellValue(r, c));
+        }
+        for (int i = 0; i < 10; ++i)
+        {
+            reference.Step();
+            ranged.Step();
+            ASSERT_EQ(snapshotCells(ranged), snapshotCells(reference)) << rule << " generation " << i + 1;
+        }
+        EXPECT_EQ(ranged.GetPopulation(), reference.GetPopulation());
+    }
+}
+
+TEST(AgePlane, CountsGenerationsAliveInBothEngines)
+{
+    for (StepEngine engine : {StepEngine::Dense, StepEngine::Sparse})
+    {
+        Simulation sim(40, 40, 1);
+        sim.SetStepEngine(engine);
+        sim.SetAgeTracking(true);
+        // Block (still life) and a blinker
+        sim.ToggleCell(5, 5);
+        sim.ToggleCell(5, 6);
+        sim.ToggleCell(6, 5);
+        sim.ToggleCell(6, 6);
+        sim.ToggleCell(20, 19);
+        sim.ToggleCell(20, 20);
+        sim.ToggleCell(20, 21);
+
+        for (int i = 0; i < 300; ++i) sim.Step();
+
+        EXPECT_EQ(sim.GetCellAge(5, 5), 255);
+        EXPECT_EQ(sim.GetCellAge(6, 6), 255);
+        // Blinker centre never dies, the ends are reborn every second generation
+        EXPECT_EQ(sim.GetCellAge(20, 20), 255);
+        EXPECT_EQ(sim.GetCellAge(20, 19), 1);
+        EXPECT_EQ(sim.GetCellAge(19, 20), 0);
+        EXPECT_EQ(sim.GetCellAge(30, 30), 0);
+
+        sim.SetAgeTracking(false);
+        EXPECT_EQ(sim.GetCellAge(5, 5), 0);
+    }
+}
+
+TEST(AsyncIo, SaveFromSnapshotThenLoadInBackground)
+{
+    Simulation sim(200, 200, 10);
+    placeGlider(sim, 3, 3);
+    sim.SetUniverseName("async");
+    const std::string path = "tests_tmp_async.lif";
+
+    AsyncIo io;
+    io.SaveLife106(path, sim.TakeSnapshot());
+    // The simulation keeps going while the snapshot is written
+    std::vector<int> saved = snapshotCells(sim);
+    sim.Step();
+
+    io.LoadLife106(path, sim.GetRows(), sim.GetColumns());
+    std::vector<IoJobResult> results;
+    IoJobResult result;
+    while (results.size() < 2)
+    {
+        if (io.Poll(result)) results.push_back(std::move(result));
+        else std::this_thread::yield();
+    }
+    EXPECT_FALSE(io.IsBusy());
+    ASSERT_EQ(results[0].kind, IoJobResult::Kind::Save);
+    EXPECT_TRUE(results[0].ok);
+    ASSERT_EQ(results[1].kind, IoJobResult::Kind::Load);
+    ASSERT_TRUE(results[1].ok);
+
+    Simulation loaded(200, 200, 10);
+    loaded.ApplySnapshot(*results[1].loaded);
+    EXPECT_EQ(snapshotCells(loaded), saved);
+    EXPECT_EQ(loaded.GetUniverseName(), "async");
+    std::remove(path.c_str());
+}
+
+TEST(AsyncIo, SnapshotsShareThePackedBoardUntilTheNextWrite)
+{
+    for (StepEngine engine : {StepEngine::Dense, StepEngine::BitSliced})
+    {
+        Simulation sim(128, 96, 1);
+        sim.SetStepEngine(engine);
+        sim.CreateRandomState(7u);
+        sim.Step();
+
+        auto snapshot = sim.TakeSnapshot();
+        // Taking it copies nothing
+        EXPECT_EQ(&snapshot->Cells(), &sim.GetPackedCells());
+        const PackedBoard taken = snapshot->Cells();
+
+        sim.Step();
+        sim.SetCellValue(3, 3, !sim.GetCellValue(3, 3));
+        sim.Step();
+        EXPECT_EQ(snapshot->Cells(), taken);
+        EXPECT_NE(&snapshot->Cells(), &sim.GetPackedCells());
+        std::vector<int> packed;
+        for (int r = 0; r < sim.GetRows(); ++r)
+        {
+            for (int c = 0; c < sim.GetColumns(); ++c) packed.push_back(sim.GetPackedCells().GetState(r, c));
+        }
+        EXPECT_EQ(packed, snapshotCells(sim));
+    }
+}
+
+TEST(Macrocell, RoundTripsSharesSubtreesAndReadsGollyFiles)
+{
+    // A 16x16 array of identical gliders collapses to one node per level
+    Simulation sim(256, 256, 1);
+    for (int row = 0; row < 256; row += 16)
+    {
+        for (int column = 0; column < 256; column += 16) placeGlider(sim, row + 4, column + 4);
+    }
+    sim.Advance(5);
+    const std::string path = "tests_tmp_macrocell.mc";
+    std::string err;
+    ASSERT_TRUE(sim.SaveToMacrocell(path, &err)) << err;
+    std::ifstream in(path);
+    std::string line;
+    int nodes = 0;
+    while (std::getline(in, line)) nodes += line[0] != '[' && line[0] != '#';
+    in.close();
+    EXPECT_LE(nodes, 8);
+
+    Simulation loaded(256, 256, 1);
+    std::vector<std::string> warnings;
+    ASSERT_TRUE(loaded.LoadFromMacrocell(path, warnings));
+    EXPECT_TRUE(warnings.empty());
+    EXPECT_EQ(snapshotCells(loaded), snapshotCells(sim));
+    EXPECT_EQ(loaded.GetGeneration(), 5);
+
+    // Generations states go through level-1 nodes, odd sizes through partial nodes
+    Simulation brain(77, 45, 1);
+    ASSERT_TRUE(brain.SetRule("B2/S/C3"));
+    brain.CreateRandomState(11u);
+    brain.Advance(3);
+    ASSERT_TRUE(brain.SaveToMacrocell(path, &err)) << err;
+    Simulation brainLoaded(77, 45, 1);
+    ASSERT_TRUE(brainLoaded.LoadFromMacrocell(path, warnings));
+    EXPECT_EQ(brainLoaded.GetRuleString(), "B2/S/C3");
+    EXPECT_EQ(snapshotCells(brainLoaded), snapshotCells(brain));
+
+    // As Golly writes it: a glider leaf in the north-west of a 16x16 root on the centre
+    {
+        std::ofstream golly(path);
+        golly << "[M2] (golly 4.2)\n#R B3/S23\n.*$..*$***$\n4 1 0 0 0\n";
+    }
+    Simulation fromGolly(32, 32, 1);
+    warnings.clear();
+    ASSERT_TRUE(fromGolly.LoadFromMacrocell(path, warnings));
+    EXPECT_TRUE(warnings.empty());
+    Simulation expected(32, 32, 1);
+    placeGlider(expected, 8, 8);
+    EXPECT_EQ(snapshotCells(fromGolly), snapshotCells(expected));
+
+    Simulation tiny(8, 8, 1);
+    warnings.clear();
+    ASSERT_TRUE(tiny.LoadFromMacrocell(path, warnings));
+    EXPECT_EQ(tiny.GetPopulation(), 0);
+    ASSERT_EQ(warnings.size(), 1u);
+    std::remove(path.c_str());
+}
+
+TEST(SimulationState, BoardRevisionTracksVisibleChangesOnly)
+{
+    Simulation sim = makeSmallSim();
+    long long revision = sim.GetBoardRevision();
+    sim.SetCellValue(1, 1, 0);
+    EXPECT_EQ(sim.GetBoardRevision(), revision);
+    sim.ToggleCell(1, 1);
+    EXPECT_GT(sim.GetBoardRevision(), revision);
+
+    revision = sim.GetBoardRevision();
+    sim.Step();
+    EXPECT_GT(sim.GetBoardRevision(), revision);
+    revision = sim.GetBoardRevision();
+    sim.ClearGrid();
+    EXPECT_GT(sim.GetBoardRevision(), revision);
+    revision = sim.GetBoardRevision();
+    sim.SetAgeTracking(true);
+    EXPECT_GT(sim.GetBoardRevision(), revision);
+}
+
+TEST(SessionLog, ReplayRebuildsEditsSeedsLoadsAndHistorySeeks)
+{
+    const std::string path = "tests_tmp_session.golr";
+    Simulation live(40, 30, 1);
+    live.EnableHistory(4);
+    std::string err;
+    ASSERT_TRUE(live.StartSessionLog(path, &err)) << err;
+
+    placeGlider(live, 5, 5);
+    live.Start();
+    for (int i = 0; i < 7; ++i) live.Update();
+    live.Stop();
+    live.ToggleCell(20, 20);
+    live.CreateRandomState(1234u);
+    live.Advance(5);
+    ASSERT_TRUE(live.StepBack());
+    ASSERT_TRUE(live.StepBack());
+    live.SetRule("B36/S23");
+    live.Advance(3);
+    BoardSnapshot loaded = *live.TakeSnapshot();
+    loaded.cells = loaded.Cells();
+    loaded.sharedCells.reset();
+    loaded.cells.Clear();
+    loaded.cells.Set(1, 1, true);
+    loaded.cells.Set(1, 2, true);
+    loaded.cells.Set(1, 3, true);
+    loaded.generation = 100;
+    live.ApplySnapshot(loaded);
+    live.Advance(4);
+    live.ClearGrid();
+    live.SetCellValue(3, 3, 1);
+    live.ResizeBoard(20, 25);
+    placeGlider(live, 2, 2);
+    live.Advance(6);
+    live.StopSessionLog();
+    EXPECT_GT(live.GetSessionLog().GetEventCount(), 20);
+
+    // Size and engine of the replaying simulation do not matter
+    Simulation replay(10, 10, 1);
+    replay.SetStepEngine(StepEngine::BitSliced);
+    ASSERT_TRUE(replay.ReplaySessionLog(path, &err)) << err;
+    EXPECT_EQ(replay.GetGeneration(), live.GetGeneration());
+    EXPECT_EQ(replay.GetRuleString(), live.GetRuleString());
+    EXPECT_EQ(snapshotCells(replay), snapshotCells(live));
+    std::remove(path.c_str());
+}
+
+// Cell-by-cell reference for FindPattern
+static std::vector<PatternMatch> findPatternNaive(const Simulation& sim, const Pattern& pattern)
+{
+    std::vector<PatternMatch> matches;
+    std::vector<Pattern> seen;
+    for (int orientation = 0; orientation < 8; ++orientation)
+    {
+        Pattern oriented = pattern.Oriented(orientation);
+        if (std::find(seen.begin(), seen.end(), oriented) != seen.end()) continue;
+        seen.push_back(oriented);
+        for (int row = 0; row < sim.GetRows(); ++row)
+        {
+            for (int column = 0; column < sim.GetColumns(); ++column)
+            {
+                bool match = true;
+                for (int r = 0; r < oriented.GetRows() && match; ++r)
+                {
+                    for (int c = 0; c < oriented.GetColumns() && match; ++c)
+                    {
+                        if (oriented.Get(r, c) == Pattern::Any) continue;
+                        int cell = sim.GetCellValue((row + r) % sim.GetRows(), (column + c) % sim.GetColumns());
+                        match = (cell == 1) == (oriented.Get(r, c) == Pattern::Alive);
+                    }
+                }
+                if (match) matches.push_back(PatternMatch{row, column, orientation});
+            }
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [](const PatternMatch& a, const PatternMatch& b)
+    {
+        return std::tie(a.row, a.column, a.orientation) < std::tie(b.row, b.column, b.orientation);
+    });
+    return matches;
+}
+
+TEST(PatternSearch, FindsEveryOrientationAcrossTheWrap)
+{
+    Pattern glider;
+    ASSERT_TRUE(Pattern::Parse(".O./..O/OOO", glider));
+    const Pattern isolated = glider.WithDeadBorder();
+
+    // One isolated glider per symmetry, the last one straddling the corner of the torus
+    Simulation sim(150, 70, 1);
+    const int anchors[8][2] = {{2, 2}, {2, 30}, {2, 60}, {2, 100}, {30, 2}, {30, 30}, {30, 60}, {68, 148}};
+    for (int orientation = 0; orientation < 8; ++orientation)
+    {
+        Pattern oriented = isolated.Oriented(orientation);
+        for (int r = 0; r < oriented.GetRows(); ++r)
+        {
+            for (int c = 0; c < oriented.GetColumns(); ++c)
+            {
+                if (oriented.Get(r, c) != Pattern::Alive) continue;
+                sim.SetCellValue((anchors[orientation][0] + r) % 70, (anchors[orientation][1] + c) % 150, 1);
+            }
+        }
+    }
+    std::vector<PatternMatch> matches = sim.FindPattern(isolated);
+    ASSERT_EQ(matches.size(), 8u);
+    for (int orientation = 0; orientation < 8; ++orientation)
+    {
+        PatternMatch expected{anchors[orientation][0], anchors[orientation][1], orientation};
+        EXPECT_NE(std::find(matches.begin(), matches.end(), expected), matches.end()) << orientation;
+    }
+    EXPECT_EQ(sim.FindPattern(isolated, kIdentityOrientation).size(), 1u);
+
+    // Symmetric templates and don't-care cells against a brute-force scan, with several bands
+    Simulation random(133, 97, 1);
+    random.CreateRandomState(7u);
+    Pattern blinker;
+    ASSERT_TRUE(Pattern::Parse("?...?/.OOO./?...?", blinker));
+    EXPECT_EQ(random.FindPattern(blinker, kAllOrientations, 3), findPatternNaive(random, blinker));
+    EXPECT_EQ(random.FindPattern(glider, kAllOrientations, 2), findPatternNaive(random, glider));
+}
+
+TEST(RuleExplorer, MatchesSeparateSimulationsPerRule)
+{
+    const std::vector<std::string> rules = {"B3/S23", "B3/S236", "B36/S23", "B2/S", "B1357/S1357", "B3678/S34678",
+                                            "B3/S23"};
+    RuleExploreOptions options;
+    options.rows = 37;
+    options.columns = 70;
+    options.seed = 11u;
+    options.maxGenerations = 400;
+    RuleExploreResult result;
+    std::string err;
+    ASSERT_TRUE(ExploreRules(rules, options, result, &err)) << err;
+    ASSERT_EQ(result.rules.size(), rules.size());
+    // All rules start from one board, so at least the first count pass is shared
+    EXPECT_LT(result.countPasses, result.ruleSteps);
+
+    for (size_t i = 0; i < rules.size(); ++i)
+    {
+        Simulation sim(options.columns, options.rows, 1);
+        ASSERT_TRUE(sim.SetRule(rules[i]));
+        sim.CreateRandomState(options.seed);
+        std::map<std::string, long long> seen;
+        long long stable = -1;
+        long long period = 0;
+        for (long long generation = 0; generation <= options.maxGenerations; ++generation)
+        {
+            if (generation > 0) sim.Step();
+            std::string cells;
+            for (int r = 0; r < options.rows; ++r)
+            {
+                for (int c = 0; c < options.columns; ++c) cells += sim.GetCellValue(r, c) ? 'O' : '.';
+            }
+            auto [it, inserted] = seen.emplace(cells, generation);
+            if (!inserted)
+            {
+                stable = it->second;
+                period = generation - it->second;
+                break;
+            }
+        }
+        EXPECT_EQ(result.rules[i].stableGeneration, stable) << rules[i];
+        EXPECT_EQ(result.rules[i].period, period) << rules[i];
+        EXPECT_EQ(result.rules[i].finalPopulation, sim.GetPopulation()) << rules[i];
+    }
+    EXPECT_EQ(result.rules[0].rule, "B3/S23");
+
+    EXPECT_FALSE(ExploreRules({"B3/S23/C4"}, options, result, &err));
+}
+
+// Boards that stress engine edge cases: soups of several densities, patterns with
+// every cell or every other cell alive, and cells on the wrap seams and word boundaries
+static void fillConformanceBoard(Simulation& sim, int kind, uint32_t seed)
+{
+    std::mt19937 gen(seed);
+    const int rows = sim.GetRows();
+    const int columns = sim.GetColumns();
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < columns; ++c)
+        {
+            bool alive = false;
+            switch (kind)
+            {
+            case 0: alive = gen() % 2 == 0; break;
+            case 1: alive = gen() % 10 == 0; break;
+            case 2: alive = gen() % 10 != 0; break;
+            case 3: alive = true; break;
+            case 4: alive = (r + c) % 2 == 0; break;
+            case 5: alive = c % 3 == 0; break;
+            case 6: alive = r == 0 || c == 0 || r == rows - 1 || c == columns - 1; break;
+            case 7: alive = (c % 64 == 0 || c % 64 == 63) && gen() % 2 == 0; break;
+            default: break;
+            }
+            sim.SetCellValue(r, c, alive ? 1 : 0);
+        }
+    }
+}
+
+TEST(EngineConformance, EveryEngineMatchesDenseStepBitForBit)
+{
+    // The torus is the only boundary mode, so the small sizes make the wrap seams
+    // meet: one or two rows or columns see the same cell through several neighbours
+    const int sizes[][2] = {{1, 9}, {2, 3}, {5, 1}, {63, 2}, {64, 17}, {65, 7}, {130, 5}};
+    const char* rules[] = {"B3/S23", "B36/S23", "B3678/S34678", "B2/S", "B1357/S1357", "B12345678/S",
+                           "B/S012345678", "B0123478/S34678", "B2/S/C3", "B35678/S5678/C6"};
+    const StepEngine engines[] = {StepEngine::Auto, StepEngine::Sparse, StepEngine::BitSliced,
+                                  StepEngine::BlockLookup, StepEngine::Tiled};
+    const int generations = 12;
+
+    for (const auto& size : sizes)
+    {
+        for (const char* rule : rules)
+        {
+            for (int kind = 0; kind < 8; ++kind)
+            {
+                const uint32_t seed = static_cast<uint32_t>(kind * 131 + size[0]);
+                Simulation reference(size[0], size[1], 1);
+                reference.SetStepEngine(StepEngine::Dense);
+                ASSERT_TRUE(reference.SetRule(rule));
+                fillConformanceBoard(reference, kind, seed);
+
+                std::vector<std::unique_ptr<Simulation>> others;
+                for (StepEngine engine : engines)
+                {
+                    others.push_back(std::make_unique<Simulation>(size[0], size[1], 1));
+                    others.back()->SetStepEngine(engine);
+                    others.back()->ConfigureTiles(2, 4);
+                    ASSERT_TRUE(others.back()->SetRule(rule));
+                    fillConformanceBoard(*others.back(), kind, seed);
+                }
+
+                for (int g = 1; g <= generations; ++g)
+                {
+                    reference.Step();
+                    const std::vector<int> expected = snapshotCells(reference);
+                    for (size_t e = 0; e < others.size(); ++e)
+                    {
+                        Simulation& sim = *others[e];
+                        sim.Step();
+                        ASSERT_EQ(snapshotCells(sim), expected)
+                            << rule << " on " << size[0] << "x" << size[1] << " board " << kind << ", engine "
+                            << static_cast<int>(engines[e]) << ", generation " << g;
+                        ASSERT_EQ(sim.GetPopulation(), reference.GetPopulation());
+                    }
+                    // Edits between generations have to reach every engine's own state
+                    if (g == generations / 2)
+                    {
+                        reference.ToggleCell(0, size[0] - 1);
+                        for (auto& sim : others) sim->ToggleCell(0, size[0] - 1);
+                    }
+                }
+
+                // Several generations in one call take the tiled engine's barrier-free path
+                Simulation batched(size[0], size[1], 1);
+                batched.SetStepEngine(StepEngine::Tiled);
+                batched.ConfigureTiles(2, 4);
+                ASSERT_TRUE(batched.SetRule(rule));
+                fillConformanceBoard(batched, kind, seed);
+                Simulation stepped(size[0], size[1], 1);
+                stepped.SetStepEngine(StepEngine::Dense);
+                ASSERT_TRUE(stepped.SetRule(rule));
+                fillConformanceBoard(stepped, kind, seed);
+                batched.Advance(generations);
+                for (int g = 0; g < generations; ++g) stepped.Step();
+                ASSERT_EQ(snapshotCells(batched), snapshotCells(stepped))
+                    << rule << " on " << size[0] << "x" << size[1] << " board " << kind << ", tiled Advance";
+            }
+        }
+    }
+
+    // Range rules against the per-cell count, Moore and von Neumann up to R10; boards
+    // narrower than 2R+1 see one cell several times through the wrap
+    const int rangeSizes[][2] = {{3, 5}, {9, 7}, {20, 21}, {17, 30}, {64, 33}};
+    const char* rangeRules[] = {"R1,C0,M0,S2..3,B3..3,NM", "R2,C0,M1,S5..9,B6..8,NN", "R5,C0,M1,S34..58,B34..45,NM",
+                                "R7,C4,M0,S20..50,B25..40,NN", "R10,C0,M0,S100..200,B120..160,NM",
+                                "R10,C3,M1,S40..80,B50..70,NN"};
+    for (const auto& size : rangeSizes)
+    {
+        for (const char* rule : rangeRules)
+        {
+            for (int kind = 0; kind < 8; ++kind)
+            {
+                const uint32_t seed = static_cast<uint32_t>(kind * 131 + size[0]);
+                Simulation reference(size[0], size[1], 1);
+                reference.SetStepEngine(StepEngine::Dense);
+                ASSERT_TRUE(reference.SetRule(rule)) << rule;
+                fillConformanceBoard(reference, kind, seed);
+                Simulation range(size[0], size[1], 1);
+                range.SetStepEngine(StepEngine::LargerThanLife);
+                ASSERT_TRUE(range.SetRule(rule));
+                fillConformanceBoard(range, kind, seed);
+
+                for (int g = 1; g <= 8; ++g)
+                {
+                    reference.Step();
+                    range.Step();
+                    ASSERT_EQ(snapshotCells(range), snapshotCells(reference))
+                        << rule << " on " << size[0] << "x" << size[1] << " board " << kind << ", generation " << g;
+                    ASSERT_EQ(range.GetPopulation(), reference.GetPopulation());
+                    if (g == 4)
+                    {
+                        reference.ToggleCell(0, size[0] - 1);
+                        range.ToggleCell(0, size[0] - 1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Times every engine on the same soup and compares against a baseline file:
+//   GOL_PERF_BASELINE  baseline path, engine_perf_baseline.txt in the working directory by default
+//   GOL_PERF_THRESHOLD allowed slowdown as a fraction, 0.5 by default
+//   GOL_PERF_UPDATE    rewrite the baseline with this run's timings
+// Engines missing from the baseline are added to it. Each timing is the best of a few runs.
+TEST(EnginePerformance, NoEngineRegressesAgainstBaseline)
+{
+    // Wall-clock thresholds are noise on a loaded machine, so only runs that ask for it compare
+    if (!std::getenv("GOL_PERF_CHECK")) GTEST_SKIP() << "set GOL_PERF_CHECK=1 to compare against the baseline";
+    const char* pathEnv = std::getenv("GOL_PERF_BASELINE");
+    const char* thresholdEnv = std::getenv("GOL_PERF_THRESHOLD");
+    const std::string path = pathEnv ? pathEnv : GOL_PERF_BASELINE_DIR "/engine_perf_baseline.txt";
+    const double threshold = thresholdEnv ? std::atof(thresholdEnv) : 0.5;
+    const bool update = std::getenv("GOL_PERF_UPDATE") != nullptr;
+
+    std::map<std::string, double> baseline;
+    {
+        std::ifstream in(path);
+        std::string name;
+        double nanoseconds = 0.0;
+        while (in >> name >> nanoseconds) baseline[name] = nanoseconds;
+    }
+
+    const std::pair<const char*, StepEngine> engines[] = {{"dense", StepEngine::Dense},
+                                                          {"sparse", StepEngine::Sparse},
+                                                          {"bitsliced", StepEngine::BitSliced},
+                                                          {"block", StepEngine::BlockLookup},
+                                                          {"tiled", StepEngine::Tiled}};
+    const int side = 256;
+    const int generations = 16;
+    std::map<std::string, double> measured;
+    for (const auto& [name, engine] : engines)
+    {
+        double best = 0.0;
+        for (int run = 0; run < 3; ++run)
+        {
+            Simulation sim(side, side, 1);
+            sim.SetStepEngine(engine);
+            sim.CreateRandomState(42u);
+            auto start = std::chrono::steady_clock::now();
+            sim.Advance(generations);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || seconds < best) best = seconds;
+        }
+        // Nanoseconds per cell update, so the baseline survives changes to the board size
+        measured[name] = best * 1e9 / (static_cast<double>(side) * side * generations);
+    }
+
+    bool rewrite = update;
+    for (const auto& [name, nanoseconds] : measured)
+    {
+        auto it = baseline.find(name);
+        if (it == baseline.end() || update)
+        {
+            rewrite = true;
+            continue;
+        }
+        EXPECT_LE(nanoseconds, it->second * (1.0 + threshold))
+            << name << " engine: " << nanoseconds << " ns per cell against a baseline of " << it->second;
+    }
+    if (rewrite)
+    {
+        for (const auto& [name, nanoseconds] : measured)
+        {
+            if (update || baseline.find(name) == baseline.end()) baseline[name] = nanoseconds;
+        }
+        std::ofstream out(path);
+        for (const auto& [name, nanoseconds] : baseline) out << name << " " << nanoseconds << "\n";
+        EXPECT_TRUE(out.good()) << "cannot write " << path;
+    }
+}
+
+TEST(CApi, BulkLoadStepAndViews)
+{
+    const int rows = 21;
+    const int columns = 70;
+    gol_simulation* sim = gol_create(rows, columns);
+    ASSERT_NE(sim, nullptr);
+    EXPECT_EQ(gol_abi_version(), static_cast<uint32_t>(GOL_ABI_VERSION));
+    EXPECT_EQ(gol_set_rule(sim, "B3/S23/X"), GOL_ERROR_RULE);
+    EXPECT_STRNE(gol_last_error(sim), "");
+    ASSERT_EQ(gol_set_rule(sim, "B36/S23"), GOL_OK);
+
+    // Caller rows are padded, so the stride has to be honoured
+    const size_t stride = 80;
+    std::vector<int32_t> source(rows * stride, 7);
+    Simulation reference(columns, rows, 1);
+    ASSERT_TRUE(reference.SetRule("B36/S23"));
+    reference.CreateRandomState(5u);
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < columns; ++c) source[r * stride + c] = reference.GetCellValue(r, c);
+    }
+    // A state the rule does not have is refused and leaves the board as it was
+    source[3 * stride + 9] = 2;
+    EXPECT_EQ(gol_load_cells(sim, source.data(), stride), GOL_ERROR_ARGUMENT);
+    EXPECT_STRNE(gol_last_error(sim), "");
+    source[3 * stride + 9] = 256;
+    EXPECT_EQ(gol_load_cells(sim, source.data(), stride), GOL_ERROR_ARGUMENT);
+    EXPECT_EQ(gol_population(sim), 0);
+    source[3 * stride + 9] = reference.GetCellValue(3, 9);
+    ASSERT_EQ(gol_load_cells(sim, source.data(), stride), GOL_OK);
+    EXPECT_EQ(gol_population(sim), reference.GetPopulation());
+
+    ASSERT_EQ(gol_step(sim, 9), GOL_OK);
+    reference.Advance(9);
+    gol_cells_view cells;
+    ASSERT_EQ(gol_get_cells(sim, &cells), GOL_OK);
+    EXPECT_EQ(cells.generation, 9);
+    ASSERT_EQ(cells.rows, rows);
+    ASSERT_EQ(cells.columns, columns);
+    std::vector<int> viewed;
+    for (int r = 0; r < rows; ++r)
+    {
+        viewed.insert(viewed.end(), cells.cells + r * cells.stride, cells.cells + r * cells.stride + columns);
+    }
+    EXPECT_EQ(viewed, snapshotCells(reference));
+    // The int32 view is a copy kept until the next change
+    gol_cells_view unchanged;
+    ASSERT_EQ(gol_get_cells(sim, &unchanged), GOL_OK);
+    EXPECT_EQ(unchanged.cells, cells.cells);
+
+    // The byte view is the grid itself, and byte rows load back without widening
+    gol_bytes_view bytes;
+    ASSERT_EQ(gol_get_bytes(sim, &bytes), GOL_OK);
+    EXPECT_EQ(bytes.revision, cells.revision);
+    ASSERT_EQ(bytes.stride, static_cast<size_t>(columns));
+    EXPECT_TRUE(std::equal(viewed.begin(), viewed.end(), bytes.cells));
+    std::vector<uint8_t> byteSource(rows * stride, 1);
+    for (int r = 0; r < rows; ++r)
+    {
+        std::copy(bytes.cells + r * columns, bytes.cells + (r + 1) * columns, byteSource.begin() + r * stride);
+    }
+    gol_simulation* fromBytes = gol_create(rows, columns);
+    ASSERT_EQ(gol_set_rule(fromBytes, "B36/S23"), GOL_OK);
+    byteSource[5 * stride + 69] = 2;
+    EXPECT_EQ(gol_load_bytes(fromBytes, byteSource.data(), stride), GOL_ERROR_ARGUMENT);
+    EXPECT_NE(std::string(gol_last_error(fromBytes)).find("5,69"), std::string::npos) << gol_last_error(fromBytes);
+    EXPECT_EQ(gol_population(fromBytes), 0);
+    byteSource[5 * stride + 69] = bytes.cells[5 * columns + 69];
+    ASSERT_EQ(gol_load_bytes(fromBytes, byteSource.data(), stride), GOL_OK);
+    EXPECT_EQ(gol_population(fromBytes), gol_population(sim));
+    gol_destroy(fromBytes);
+
+    // The bit-sliced engine's board is handed out as is, and again without repacking
+    ASSERT_EQ(gol_set_engine(sim, "bitsliced"), GOL_OK);
+    ASSERT_EQ(gol_step(sim, 1), GOL_OK);
+    reference.Step();
+    gol_packed_view packed;
+    ASSERT_EQ(gol_get_packed(sim, &packed), GOL_OK);
+    gol_packed_view again;
+    ASSERT_EQ(gol_get_packed(sim, &again), GOL_OK);
+    EXPECT_EQ(packed.words, again.words);
+    EXPECT_EQ(packed.planes, 1);
+    EXPECT_EQ(packed.stride, 2u);
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < columns; ++c)
+        {
+            int bit = static_cast<int>((packed.words[r * packed.stride + c / 64] >> (c % 64)) & 1);
+            ASSERT_EQ(bit, reference.GetCellValue(r, c)) << r << "," << c;
+        }
+    }
+
+    // Packed words load back into a second simulation
+    gol_simulation* copy = gol_create(rows, columns);
+    ASSERT_EQ(gol_set_rule(copy, "B36/S23"), GOL_OK);
+    std::vector<uint64_t> words(packed.words, packed.words + rows * packed.stride);
+    ASSERT_EQ(gol_load_packed(copy, words.data(), packed.stride, 0), GOL_OK);
+    ASSERT_EQ(gol_step(copy, 5), GOL_OK);
+    ASSERT_EQ(gol_step(sim, 5), GOL_OK);
+    gol_cells_view left;
+    gol_cells_view right;
+    gol_get_cells(sim, &left);
+    gol_get_cells(copy, &right);
+    EXPECT_TRUE(std::equal(left.cells, left.cells + rows * columns, right.cells));
+    EXPECT_EQ(gol_load_packed(copy, words.data(), 1, 0), GOL_ERROR_ARGUMENT);
+
+    // Two planes for C3 can spell state 3, which the rule does not have; bits past the
+    // last column are padding and not checked
+    ASSERT_EQ(gol_set_rule(copy, "B2/S/C3"), GOL_OK);
+    const size_t planeStride = rows * packed.stride;
+    std::vector<uint64_t> planes(2 * planeStride, 0);
+    planes[4 * packed.stride] = uint64_t{1} << 3;                   // (4, 3) state 1
+    planes[planeStride + 4 * packed.stride] = uint64_t{1} << 5;     // (4, 5) state 2
+    planes[7 * packed.stride + 1] = ~uint64_t{0} << (columns - 64); // padding of row 7
+    planes[planeStride + 7 * packed.stride + 1] = ~uint64_t{0} << (columns - 64);
+    planes[9 * packed.stride + 1] |= uint64_t{1} << 2;              // (9, 66) state 3
+    planes[planeStride + 9 * packed.stride + 1] |= uint64_t{1} << 2;
+    EXPECT_EQ(gol_load_packed(copy, planes.data(), packed.stride, planeStride), GOL_ERROR_ARGUMENT);
+    EXPECT_NE(std::string(gol_last_error(copy)).find("9,66 has state 3"), std::string::npos) << gol_last_error(copy);
+    planes[planeStride + 9 * packed.stride + 1] = 0;
+    ASSERT_EQ(gol_load_packed(copy, planes.data(), packed.stride, planeStride), GOL_OK);
+    gol_bytes_view states;
+    ASSERT_EQ(gol_get_bytes(copy, &states), GOL_OK);
+    EXPECT_EQ(states.cells[4 * columns + 3], 1);
+    EXPECT_EQ(states.cells[4 * columns + 5], 2);
+    EXPECT_EQ(states.cells[9 * columns + 66], 1);
+    EXPECT_EQ(gol_population(copy), 3);
+
+    gol_destroy(copy);
+    gol_destroy(sim);
+    EXPECT_EQ(gol_step(nullptr, 1), GOL_ERROR_ARGUMENT);
+}
+
+static void expectStatsMatchScan(const Simulation& sim, const std::vector<int>& before)
+{
+    const BoardStats& stats = sim.Stats();
+    long long population = 0, births = 0, deaths = 0;
+    int top = sim.GetRows(), left = sim.GetColumns(), bottom = -1, right = -1;
+    std::vector<uint32_t> tiles(static_cast<size_t>(stats.tileRows) * stats.tileColumns, 0);
+    for (int r = 0; r < sim.GetRows(); ++r)
+    {
+        for (int c = 0; c < sim.GetColumns(); ++c)
+        {
+            bool alive = sim.GetCellValue(r, c) != 0;
+            bool was = before[static_cast<size_t>(r) * sim.GetColumns() + c] != 0;
+            births += alive && !was;
+            deaths += was && !alive;
+            if (!alive) continue;
+            ++population;
+            top = std::min(top, r);
+            bottom = std::max(bottom, r);
+            left = std::min(left, c);
+            right = std::max(right, c);
+            ++tiles[static_cast<size_t>(r / BoardStats::kTileSize) * stats.tileColumns + c / BoardStats::kTileSize];
+        }
+    }
+    EXPECT_EQ(stats.generation, sim.GetGeneration());
+    EXPECT_EQ(stats.population, population);
+    EXPECT_EQ(stats.population, sim.GetPopulation());
+    EXPECT_EQ(stats.births, births);
+    EXPECT_EQ(stats.deaths, deaths);
+    EXPECT_EQ(stats.tilePopulation, tiles);
+    if (population == 0)
+    {
+        EXPECT_TRUE(stats.IsEmpty());
+        return;
+    }
+    EXPECT_EQ(std::tie(stats.top, stats.left, stats.bottom, stats.right), std::tie(top, left, bottom, right));
+}
+
+TEST(BoardStats, StepsAndEditsKeepStatsEqualToAFullScan)
+{
+    for (StepEngine engine : {StepEngine::Dense, StepEngine::BitSliced, StepEngine::Sparse, StepEngine::Tiled,
+                              StepEngine::BlockLookup})
+    {
+        Simulation sim(150, 140, 1);
+        sim.SetStepEngine(engine);
+        // Tiles that straddle the 64-cell stats words
+        sim.ConfigureTiles(2, 48);
+        ASSERT_TRUE(sim.SetRule(engine == StepEngine::Dense ? "B3/S23/C3" : "B3/S23"));
+        // A sparse corner soup so the box and empty tiles matter
+        for (int r = 70; r < 140; ++r)
+        {
+            for (int c = 90; c < 150; ++c) sim.SetCellValue(r, c, (r * 7 + c * 13) % 5 == 0);
+        }
+        std::vector<long long> seen;
+        sim.SetStatsCallback([&](const BoardStats& stats) { seen.push_back(stats.generation); });
+        ASSERT_TRUE(sim.IsTrackingStats());
+        expectStatsMatchScan(sim, snapshotCells(sim));
+
+        for (int g = 0; g < 30; ++g)
+        {
+            std::vector<int> before = snapshotCells(sim);
+            sim.Step();
+            expectStatsMatchScan(sim, before);
+        }
+        EXPECT_EQ(seen.size(), 30u);
+        EXPECT_EQ(seen.back(), 30);
+
+        // Edits between steps move the box without counting as births or deaths
+        std::vector<int> before = snapshotCells(sim);
+        sim.SetCellValue(3, 5, 1);
+        sim.SetCellValue(139, 149, 0);
+        BoardStats edited = sim.Stats();
+        EXPECT_EQ(edited.top, 3);
+        EXPECT_EQ(edited.left, 5);
+        sim.SetCellValue(3, 5, 0);
+        sim.Advance(3);
+        before = snapshotCells(sim);
+        sim.Step();
+        expectStatsMatchScan(sim, before);
+
+        sim.ClearGrid();
+        EXPECT_TRUE(sim.Stats().IsEmpty());
+        EXPECT_EQ(sim.Stats().population, 0);
+    }
+}
+
+static std::vector<uint8_t> readFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+TEST(FrameRecorder, WritesEveryNthGenerationInEachFormat)
+{
+    Simulation sim(40, 30, 1);
+    placeGlider(sim, 5, 5);
+
+    RecordOptions ppm;
+    ppm.path = "tests_tmp_frame_";
+    ppm.format = RecordFormat::Ppm;
+    ppm.every = 2;
+    RecordOptions y4m;
+    y4m.path = "tests_tmp_frames.y4m";
+    y4m.format = RecordFormat::Y4m;
+    y4m.threads = 3;
+    RecordOptions png = ppm;
+    png.format = RecordFormat::Png;
+    png.every = 4;
+
+    Simulation pngSim(40, 30, 1);
+    placeGlider(pngSim, 5, 5);
+    std::string err;
+    ASSERT_TRUE(sim.StartRecording(ppm, &err)) << err;
+    ASSERT_TRUE(pngSim.StartRecording(png, &err)) << err;
+    std::vector<std::vector<int>> boards{snapshotCells(sim)};
+    for (int i = 0; i < 6; ++i)
+    {
+        sim.Step();
+        pngSim.Step();
+        boards.push_back(snapshotCells(sim));
+    }
+    ASSERT_TRUE(sim.StopRecording(&err)) << err;
+    ASSERT_TRUE(pngSim.StopRecording(&err)) << err;
+    EXPECT_EQ(sim.GetRecorder().GetStats().framesWritten, 4);
+
+    for (int generation = 0; generation <= 6; generation += 2)
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "tests_tmp_frame_%06d.ppm", generation);
+        std::vector<uint8_t> bytes = readFile(name);
+        const std::string header = "P6\n40 30\n255\n";
+        ASSERT_EQ(bytes.size(), header.size() + 30 * 40 * 3) << name;
+        EXPECT_EQ(std::string(bytes.begin(), bytes.begin() + header.size()), header);
+        for (int cell = 0; cell < 30 * 40; ++cell)
+        {
+            ASSERT_EQ(bytes[header.size() + cell * 3], boards[generation][cell] ? 255 : 0) << name;
+        }
+        std::remove(name);
+    }
+    for (int generation = 0; generation <= 4; generation += 4)
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "tests_tmp_frame_%06d.png", generation);
+        std::vector<uint8_t> bytes = readFile(name);
+        ASSERT_GT(bytes.size(), 33u) << name;
+        EXPECT_EQ(std::string(bytes.begin() + 1, bytes.begin() + 4), "PNG");
+        EXPECT_EQ(std::string(bytes.begin() + 12, bytes.begin() + 16), "IHDR");
+        EXPECT_EQ(bytes[19], 40); // width
+        EXPECT_EQ(bytes[23], 30); // height
+        EXPECT_EQ(bytes[24], 1);  // one bit per cell
+        std::remove(name);
+    }
+
+    // Frames encoded on several threads still land in generation order
+    ASSERT_TRUE(sim.StartRecording(y4m, &err)) << err;
+    for (int i = 0; i < 20; ++i)
+    {
+        sim.Step();
+        boards.push_back(snapshotCells(sim));
+    }
+    ASSERT_TRUE(sim.StopRecording(&err)) << err;
+    std::vector<uint8_t> bytes = readFile(y4m.path);
+    const std::string header = "YUV4MPEG2 W40 H30 F30:1 Ip A1:1 Cmono\n";
+    const size_t frameBytes = 6 + 30 * 40;
+    ASSERT_EQ(bytes.size(), header.size() + 21 * frameBytes);
+    EXPECT_EQ(std::string(bytes.begin(), bytes.begin() + header.size()), header);
+    for (int frame = 0; frame < 21; ++frame)
+    {
+        size_t at = header.size() + frame * frameBytes + 6;
+        const std::vector<int>& expected = boards[boards.size() - 21 + frame];
+        for (int cell = 0; cell < 30 * 40; ++cell) ASSERT_EQ(bytes[at + cell], expected[cell] ? 255 : 0) << frame;
+    }
+    std::remove(y4m.path.c_str());
+}
+
+// Runs the headless mode on a command line given as words
+static int runHeadless(std::vector<std::string> args)
+{
+    args.insert(args.begin(), {"GameOfLife", "--headless"});
+    std::vector<char*> argv;
+    for (std::string& arg : args) argv.push_back(arg.data());
+    return RunHeadless(static_cast<int>(argv.size()), argv.data());
+}
+
+TEST(Headless, CheckpointsEveryGenerationWithASlowWriter)
+{
+    // Writing a 512 x 512 soup takes far longer than a bit-sliced step, so most
+    // checkpoints come due while the previous one is still being written
+    const std::string path = "tests_tmp_checkpoint.lif";
+    const std::string referencePath = "tests_tmp_checkpoint_reference.lif";
+    EXPECT_EQ(runHeadless({"--rows", "512", "--cols", "512", "--seed", "3", "--engine", "bitsliced", "--steps", "60",
+                           "--checkpoint-every", "1", "--save", path}),
+              0);
+    EXPECT_FALSE(std::ifstream(path + ".part").is_open());
+
+    Simulation reference(512, 512, 1);
+    reference.CreateRandomState(3);
+    reference.Advance(60);
+    std::string err;
+    ASSERT_TRUE(reference.SaveToLife106(referencePath, &err)) << err;
+    EXPECT_EQ(readFile(path), readFile(referencePath));
+    std::remove(path.c_str());
+    std::remove(referencePath.c_str());
+}
+
+TEST(Headless, WorkersRejectOptionsOnlyOneProcessHonours)
+{
+    EXPECT_EQ(runHeadless({"--workers", "2", "--metrics-port", "0", "--steps", "1"}), 2);
+    EXPECT_EQ(runHeadless({"--workers", "2", "--checkpoint-every", "1", "--save", "unused.lif"}), 2);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// Board as the reader sees it, live cells only
+static std::vector<int> streamCells(const ChangeStreamReader& reader)
+{
+    std::vector<int> cells;
+    for (int r = 0; r < reader.GetBoard().GetRows(); ++r)
+    {
+        for (int c = 0; c < reader.GetBoard().GetColumns(); ++c) cells.push_back(reader.GetBoard().GetState(r, c) == 1);
+    }
+    return cells;
+}
+
+TEST(ChangeStream, ReadersRebuildBoardAndSlowReadersFallBackToKeyframes)
+{
+    for (StreamTransport transport : {StreamTransport::UnixSocket, StreamTransport::Fifo})
+    {
+        const std::string path = "tests_tmp_stream";
+        std::remove(path.c_str());
+        Simulation sim(40, 30, 1);
+        placeGlider(sim, 5, 5);
+        std::string err;
+        ASSERT_TRUE(sim.StartChangeStream(path, transport, &err)) << err;
+
+        ChangeStreamReader reader;
+        ASSERT_TRUE(reader.Open(path, &err)) << err;
+        for (int i = 0; i < 10; ++i)
+        {
+            sim.Step();
+            reader.Poll();
+            ASSERT_EQ(reader.GetGeneration(), sim.GetGeneration());
+            ASSERT_EQ(streamCells(reader), snapshotCells(sim));
+        }
+        EXPECT_EQ(sim.GetChangeStream().GetKeyframesSent(), 1);
+        EXPECT_EQ(sim.GetChangeStream().GetDeltasSent(), 9);
+        reader.Close();
+        sim.StopChangeStream();
+        std::remove(path.c_str());
+    }
+
+    // A reader that never drains must not stall the simulator
+    const std::string path = "tests_tmp_stream";
+    Simulation big(512, 512, 1);
+    big.CreateRandomState();
+    std::string err;
+    ASSERT_TRUE(big.StartChangeStream(path, StreamTransport::UnixSocket, &err)) << err;
+    ChangeStreamReader slow;
+    ASSERT_TRUE(slow.Open(path, &err)) << err;
+    for (int i = 0; i < 40; ++i) big.Step();
+    EXPECT_GT(big.GetChangeStream().GetFramesSkipped(), 0);
+
+    // Once it catches up it resynchronises on a keyframe
+    for (int i = 0; i < 100 && slow.GetGeneration() != big.GetGeneration(); ++i)
+    {
+        slow.Poll();
+        big.Step();
+        slow.Poll();
+    }
+    ASSERT_EQ(slow.GetGeneration(), big.GetGeneration());
+    EXPECT_EQ(streamCells(slow), snapshotCells(big));
+}
+
+TEST(ChangeStream, ReadersShareFramesAndHangUpsDoNotRaiseSigpipe)
+{
+    // With the default disposition a stray SIGPIPE would end the test run
+    std::signal(SIGPIPE, SIG_DFL);
+    for (StreamTransport transport : {StreamTransport::UnixSocket, StreamTransport::Fifo})
+    {
+        const std::string path = "tests_tmp_stream";
+        std::remove(path.c_str());
+        Simulation sim(256, 256, 1);
+        sim.CreateRandomState();
+        std::string err;
+        ASSERT_TRUE(sim.StartChangeStream(path, transport, &err)) << err;
+
+        ChangeStreamReader first;
+        ASSERT_TRUE(first.Open(path, &err)) << err;
+        ChangeStreamReader second;
+        if (transport == StreamTransport::UnixSocket) ASSERT_TRUE(second.Open(path, &err)) << err;
+        for (int i = 0; i < 5; ++i)
+        {
+            sim.Step();
+            first.Poll();
+            second.Poll();
+        }
+        ASSERT_EQ(first.GetGeneration(), sim.GetGeneration());
+        EXPECT_EQ(streamCells(first), snapshotCells(sim));
+        if (second.IsOpen())
+        {
+            ASSERT_EQ(second.GetGeneration(), sim.GetGeneration());
+            EXPECT_EQ(streamCells(second), streamCells(first));
+        }
+
+        first.Close();
+        second.Close();
+        for (int i = 0; i < 3; ++i) sim.Step();
+        EXPECT_EQ(sim.GetChangeStream().GetReaderCount(), 0);
+        sim.StopChangeStream();
+        std::remove(path.c_str());
+    }
+}
+
+// One HTTP exchange with the metrics server's Unix socket, response head included
+static std::string scrapeMetrics(const std::string& path, const std::string& request)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path.c_str());
+    std::string response;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+        write(fd, request.data(), request.size()) == static_cast<ssize_t>(request.size()))
+    {
+        char buffer[512];
+        ssize_t n;
+        while ((n = read(fd, buffer, sizeof(buffer))) > 0) response.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    return response;
+}
+
+TEST(Metrics, ScrapesAndJsonlSeeTheLatestPublishedCounters)
+{
+    const std::string socketPath = "tests_tmp_metrics.sock";
+    const std::string jsonlPath = "tests_tmp_metrics.jsonl";
+    std::remove(jsonlPath.c_str());
+    MetricsServer metrics;
+    MetricsOptions options;
+    options.socketPath = socketPath;
+    options.jsonlPath = jsonlPath;
+    options.intervalSeconds = 0.02;
+    metrics.Publish(42, 7, 3);
+    std::string err;
+    ASSERT_TRUE(metrics.Start(options, &err)) << err;
+    EXPECT_EQ(metrics.GetPort(), 0);
+
+    std::string response = scrapeMetrics(socketPath, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    EXPECT_EQ(response.rfind("HTTP/1.0 200 OK\r\n", 0), 0u) << response;
+    EXPECT_NE(response.find("Content-Type: text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(response.find("\ngol_generation 42\n"), std::string::npos) << response;
+    EXPECT_NE(response.find("\ngol_population 7\n"), std::string::npos);
+    EXPECT_NE(response.find("\ngol_active_tiles 3\n"), std::string::npos);
+    EXPECT_NE(response.find("\ngol_last_checkpoint_timestamp_seconds 0.000\n"), std::string::npos);
+    EXPECT_EQ(scrapeMetrics(socketPath, "GET /other HTTP/1.0\r\n\r\n").rfind("HTTP/1.0 404", 0), 0u);
+
+    // Scrapes read whatever the stepping thread stored last
+    metrics.Publish(43, 9, 4);
+    metrics.MarkCheckpoint();
+    response = scrapeMetrics(socketPath, "GET / HTTP/1.0\r\n\r\n");
+    EXPECT_NE(response.find("\ngol_generation 43\n"), std::string::npos) << response;
+    EXPECT_EQ(response.find("\ngol_last_checkpoint_timestamp_seconds 0.000\n"), std::string::npos);
+#ifdef __linux__
+    EXPECT_EQ(response.find("\ngol_resident_memory_bytes 0\n"), std::string::npos);
+#endif
+
+    metrics.Stop();
+    EXPECT_FALSE(metrics.IsRunning());
+    std::ifstream jsonl(jsonlPath);
+    std::string line;
+    std::string last;
+    int lines = 0;
+    while (std::getline(jsonl, line))
+    {
+        EXPECT_EQ(line.front(), '{');
+        EXPECT_EQ(line.back(), '}');
+        last = line;
+        ++lines;
+    }
+    EXPECT_GE(lines, 1);
+    EXPECT_NE(last.find("\"generation\":43,"), std::string::npos) << last;
+    EXPECT_NE(last.find("\"population\":9,"), std::string::npos);
+    jsonl.close();
+    std::remove(jsonlPath.c_str());
+}
+
+TEST(PagedBoard, MatchesSimulationResumesAndStaysSparse)
+{
+    const std::string path = "tests_tmp_paged.bin";
+    auto expectSameCells = [](const PagedBoard& board, const Simulation& sim)
+    {
+        for (int r = 0; r < sim.GetRows(); ++r)
+        {
+            for (int c = 0; c < sim.GetColumns(); ++c)
+            {
+                ASSERT_EQ(board.Get(r, c), sim.GetCellValue(r, c) == 1) << r << "," << c;
+            }
+        }
+        EXPECT_EQ(board.GetPopulation(), sim.GetPopulation());
+    };
+
+    // 2x2 tiles, so every seam and the wrap are crossed
+    Simulation sim(2 * PagedBoard::kTileColumns, 2 * PagedBoard::kTileRows, 1);
+    ASSERT_TRUE(sim.SetRule("B36/S23"));
+    sim.CreateRandomState(5u);
+    PagedBoard board;
+    std::string err;
+    ASSERT_TRUE(board.Create(path, sim.GetRows(), sim.GetColumns(), &err)) << err;
+    ASSERT_TRUE(board.SetRule(sim.GetBirthRule(), sim.GetSurvivalRule(), &err)) << err;
+    board.Paste(sim.GetPackedCells(), 0, 0);
+    for (int i = 0; i < 3; ++i)
+    {
+        sim.Advance(7);
+        board.Advance(7);
+        expectSameCells(board, sim);
+    }
+
+    ASSERT_TRUE(board.Checkpoint(&err)) << err;
+    board.Close();
+    ASSERT_TRUE(board.Resume(path, &err)) << err;
+    EXPECT_EQ(board.GetGeneration(), 21);
+    expectSameCells(board, sim);
+
+    // Dying between checkpoints, whatever pages reached the file, resumes the last
+    // checkpoint: steps and edits never write to its plane
+    board.Advance(3);
+    board.Set(0, 0, !board.Get(0, 0));
+    board.Advance(4);
+    board.Close();
+    ASSERT_TRUE(board.Resume(path, &err)) << err;
+    EXPECT_EQ(board.GetGeneration(), 21);
+    expectSameCells(board, sim);
+    board.Set(5, 5, !board.Get(5, 5));
+    sim.ToggleCell(5, 5);
+    ASSERT_TRUE(board.Checkpoint(&err)) << err;
+    board.Advance(2);
+    board.Close();
+    ASSERT_TRUE(board.Resume(path, &err)) << err;
+    expectSameCells(board, sim);
+
+    sim.Advance(5);
+    board.Advance(5);
+    expectSameCells(board, sim);
+    ASSERT_TRUE(board.Checkpoint(&err)) << err;
+    board.Close();
+
+    // A plane that no longer matches its header is refused
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        // Header population: after magic, version, rows, columns, generation, plane and rule
+        file.seekp(40);
+        const int64_t population = 1;
+        file.write(reinterpret_cast<const char*>(&population), sizeof(population));
+    }
+    EXPECT_FALSE(board.Resume(path, &err));
+    EXPECT_NE(err.find("damaged"), std::string::npos) << err;
+
+    // A lone glider on a 2^16 torus touches at most four tiles, and tiles it leaves are punched out
+    const long long side = 1 << 16;
+    ASSERT_TRUE(board.Create(path, side, side, &err)) << err;
+    Simulation glider(8, 8, 1);
+    placeGlider(glider, 0, 0);
+    board.Paste(glider.GetPackedCells(), side - 1, side - 1);
+    for (int i = 0; i < 50; ++i)
+    {
+        board.Advance(8);
+        ASSERT_LE(board.GetLiveTiles(), 4u);
+    }
+    EXPECT_EQ(board.GetPopulation(), 5);
+    ASSERT_TRUE(board.Checkpoint(&err)) << err;
+    struct stat info{};
+    ASSERT_EQ(stat(path.c_str(), &info), 0);
+    EXPECT_EQ(info.st_size, static_cast<off_t>(4096 + PagedBoard::kPlanes * (side / PagedBoard::kTileRows) *
+                                               (side / PagedBoard::kTileColumns) * PagedBoard::kTileBytes));
+    EXPECT_LT(static_cast<long long>(info.st_blocks) * 512, 256 * 1024);
+    board.Close();
+    std::remove(path.c_str());
+}
+#endif
+
+#ifdef GOL_SLAB_CLUSTER
+static void expectClusterMatchesSimulation(HaloTransport transport, const SlabPlacement& placement = {})
+{
+    Simulation reference(30, 20, 1);
+    placeGlider(reference, 0, 0);
+    placeGlider(reference, 10, 20);
+    reference.ToggleCell(19, 5);
+    reference.ToggleCell(19, 6);
+    reference.ToggleCell(19, 7);
+
+    SlabCluster cluster(reference.GetRows(), reference.GetColumns(), 3, transport);
+    cluster.SetPlacement(placement);
+    std::string err;
+    ASSERT_TRUE(cluster.LoadFrom(reference, &err)) << err;
+
+    for (int i = 0; i < 12; ++i) reference.Step();
+    ASSERT_TRUE(cluster.Step(12, &err)) << err;
+
+    Simulation gathered(30, 20, 1);
+    ASSERT_TRUE(cluster.CopyTo(gathered, &err)) << err;
+    EXPECT_EQ(snapshotCells(gathered), snapshotCells(reference));
+
+    long long population = 0;
+    for (int v : snapshotCells(reference)) population += v;
+    EXPECT_EQ(cluster.GetPopulation(), population);
+    EXPECT_EQ(cluster.GetGeneration(), 12);
+
+    int workers = 0;
+    long long cells = 0;
+    for (const NodeThroughput& node : cluster.GetNodeThroughput())
+    {
+        workers += node.workers;
+        cells += node.cells;
+        EXPECT_TRUE(node.workers == 0 || node.cellsPerSecond > 0.0);
+    }
+    EXPECT_EQ(workers, 3);
+    EXPECT_EQ(cells, 30LL * 20);
+}
+
+TEST(SlabCluster, SharedMemoryHaloMatchesSingleProcess)
+{
+    expectClusterMatchesSimulation(HaloTransport::SharedMemory);
+}
+
+TEST(SlabCluster, UnixSocketHaloMatchesSingleProcess)
+{
+    expectClusterMatchesSimulation(HaloTransport::UnixSocket);
+}
+
+TEST(SlabCluster, PinnedInterleavedWorkersMatchSingleProcess)
+{
+    SlabPlacement placement;
+    placement.pinning = SlabPinning::Core;
+    placement.interleave = true;
+    expectClusterMatchesSimulation(HaloTransport::SharedMemory, placement);
+}
+
+TEST(SlabCluster, SocketHaloRowsWiderThanTheSocketBuffer)
+{
+    // A million columns is more than a socket buffer holds under the default
+    // net.core.wmem_max (about 208 KiB), which used to deadlock the first exchange
+    const int columns = 1 << 20;
+    Simulation board(columns, 4, 1);
+    board.SetCellValue(1, 700000, 1);
+    board.SetCellValue(2, 700000, 1);
+    board.SetCellValue(3, 700000, 1);
+    SlabCluster cluster(4, columns, 2, HaloTransport::UnixSocket);
+    std::string err;
+    ASSERT_TRUE(cluster.LoadFrom(board, &err)) << err;
+    ASSERT_TRUE(cluster.Step(3, &err)) << err;
+    ASSERT_TRUE(cluster.CopyTo(board, &err)) << err;
+    EXPECT_EQ(cluster.GetPopulation(), 3);
+    EXPECT_EQ(board.GetCellValue(2, 699999), 1);
+    EXPECT_EQ(board.GetCellValue(2, 700000), 1);
+    EXPECT_EQ(board.GetCellValue(2, 700001), 1);
+}
+
+TEST(SlabCluster, Life106StreamsThroughASmallTransferWindow)
+{
+    const std::string path = "tests_tmp_slab.lif";
+    const std::string clusterOut = "tests_tmp_slab_cluster.lif";
+    const std::string referenceOut = "tests_tmp_slab_reference.lif";
+    {
+        std::ofstream out(path);
+        out << "Life 1.06\n#N slabs\n#R B36/S23\n";
+        out << "1 -9\n2 -8\n0 -7\n1 -7\n2 -7\n"; // glider near the top
+        out << "-5 8\n-4 8\n-3 8\n";              // blinker on the last rows
+        out << "0 -7\n";                          // duplicate
+        out << "40 0\n";                          // outside the board
+    }
+
+    Simulation reference(30, 20, 1);
+    std::vector<std::string> referenceWarnings;
+    ASSERT_TRUE(reference.LoadFromLife106(path, referenceWarnings));
+
+    // Three rows per window, so windows and the four slabs never line up
+    SlabCluster cluster(20, 30, 4);
+    cluster.SetTransferBytes(3 * 30);
+    std::vector<std::string> warnings;
+    ASSERT_TRUE(cluster.LoadFromLife106(path, warnings));
+    EXPECT_EQ(warnings, referenceWarnings);
+    EXPECT_EQ(cluster.GetPopulation(), 8);
+
+    std::string err;
+    for (int i = 0; i < 9; ++i) reference.Step();
+    ASSERT_TRUE(cluster.Step(9, &err)) << err;
+    long long population = 0;
+    for (int v : snapshotCells(reference)) population += v;
+    EXPECT_EQ(cluster.GetPopulation(), population);
+
+    ASSERT_TRUE(cluster.SaveToLife106(clusterOut, &err)) << err;
+    ASSERT_TRUE(reference.SaveToLife106(referenceOut, &err)) << err;
+    EXPECT_EQ(readFile(clusterOut), readFile(referenceOut));
+
+    // A seeded soup is the same board the single-process runner makes
+    Simulation soup(30, 20, 1);
+    soup.CreateRandomState(7);
+    ASSERT_TRUE(cluster.LoadRandom(7, &err)) << err;
+    Simulation gathered(30, 20, 1);
+    ASSERT_TRUE(cluster.CopyTo(gathered, &err)) << err;
+    EXPECT_EQ(snapshotCells(gathered), snapshotCells(soup));
+
+    std::remove(path.c_str());
+    std::remove(clusterOut.c_str());
+    std::remove(referenceOut.c_str());
+}
+#endif
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
+
+TEST(EditBuffer, StrokesRectsAndStampsApplyAtTheGenerationBoundary)
+{
+    Simulation sim(100, 80, 1);
+
+    // A fast diagonal drag is one stroke, joined without gaps
+    sim.Edits().Stroke(5, 5, 20, 40, 0, 1);
+    sim.Edits().FillRect(52, 14, 50, 10, 1);
+    EXPECT_EQ(sim.GetCellValue(5, 5), 0);
+    EXPECT_EQ(sim.GetPopulation(), 0);
+    sim.Update();
+    EXPECT_EQ(sim.GetGeneration(), 0);
+    EXPECT_EQ(sim.GetCellValue(5, 5), 1);
+    EXPECT_EQ(sim.GetCellValue(20, 40), 1);
+    for (int column = 5; column <= 40; ++column)
+    {
+        int inColumn = 0;
+        for (int row = 5; row <= 20; ++row) inColumn += sim.GetCellValue(row, column);
+        EXPECT_EQ(inColumn, 1) << column;
+    }
+    EXPECT_EQ(sim.GetPopulation(), 36 + 15);
+
+    // Erasing with a round brush clears the middle of the rectangle only
+    sim.Edits().Stroke(51, 12, 51, 12, 1, 0);
+    sim.Update();
+    EXPECT_EQ(sim.GetPopulation(), 36 + 15 - 5);
+    EXPECT_EQ(sim.GetCellValue(50, 11), 1);
+
+    // Only the rows an edit touched are cleared and scanned, earlier edits never come back
+    sim.SetCellValue(5, 5, 0);
+    sim.Edits().FillRect(70, 0, 70, 99, 1);
+    sim.Update();
+    EXPECT_EQ(sim.GetCellValue(5, 5), 0);
+    EXPECT_EQ(sim.GetCellValue(70, 99), 1);
+    EXPECT_EQ(sim.GetPopulation(), 36 + 15 - 5 - 1 + 100);
+    sim.Edits().FillRect(70, 0, 70, 99, 0);
+    sim.Update();
+
+    // A stamp turned by Q lands as the oriented pattern, wrapping around the edge
+    Simulation source(8, 8, 1);
+    placeGlider(source, 2, 3);
+    auto glider = std::make_shared<const PackedBoard>(EditBuffer::Trim(source.GetPackedCells()));
+    ASSERT_EQ(glider->GetRows(), 3);
+    ASSERT_EQ(glider->GetColumns(), 3);
+    const PackedBoard turned = EditBuffer::Oriented(*glider, 5);
+    sim.ClearGrid();
+    sim.Edits().Stamp(glider, 78, 98, 5);
+    sim.Update();
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            EXPECT_EQ(sim.GetCellValue((78 + row) % 80, (98 + column) % 100), turned.GetState(row, column));
+        }
+    }
+    EXPECT_EQ(sim.GetPopulation(), 5);
+
+    // A batch large enough to rebuild the board steps exactly like the same cells toggled one by one
+    Simulation batched(200, 200, 1);
+    Simulation toggled(200, 200, 1);
+    batched.CreateRandomState(9u);
+    toggled.CreateRandomState(9u);
+    batched.Edits().FillRect(0, 0, 99, 199, 0);
+    for (int row = 0; row < 100; ++row)
+    {
+        for (int column = 0; column < 200; ++column)
+        {
+            if (toggled.GetCellValue(row, column) == 1) toggled.ToggleCell(row, column);
+        }
+    }
+    batched.Edits().Stamp(glider, 10, 10);
+    placeGlider(toggled, 10, 10);
+    batched.Step();
+    toggled.Step();
+    for (int i = 0; i < 10; ++i)
+    {
+        batched.Step();
+        toggled.Step();
+    }
+    EXPECT_EQ(batched.GetPopulation(), toggled.GetPopulation());
+    EXPECT_EQ(batched.GetPackedCells(), toggled.GetPackedCells());
+}